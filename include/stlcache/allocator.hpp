@@ -0,0 +1,292 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_ALLOCATOR_HPP_INCLUDED
+#define STLCACHE_ALLOCATOR_HPP_INCLUDED
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#if defined(__has_include)
+#if __cplusplus >= 201402L && __has_include(<experimental/memory_resource>)
+#include <experimental/memory_resource>
+#define STLCACHE_HAS_MEMORY_RESOURCE 1
+#endif
+#endif
+
+namespace stlcache {
+    /*
+     * Pools of fixed size nodes. Nodes are rounded up to 16 bytes and every size has it's own free list, so a freed node is reused by
+     * the next allocation of the same size. Nodes are carved from chunks, that double in size, until they reach the expected number
+     * of entries, so filling a cache takes a few dozens of allocations. Chunks are released, when the arena is destroyed.
+     */
+    class _node_arena {
+        static const std::size_t _granularity = 16;
+        static const std::size_t _classes = 16;
+        static const std::size_t _minChunk = 16;
+        static const std::size_t _maxChunk = 4096;
+        static const std::size_t _maxReserved = std::size_t(1)<<24;
+
+        struct free_node {
+            free_node* next;
+        };
+
+        free_node* _free[_classes];
+        std::size_t _carved[_classes];
+        std::vector<void*> _chunks;
+        std::size_t _capacity;
+
+        void refill(std::size_t _class) {
+            std::size_t size=(_class+1)*_granularity;
+            std::size_t limit=_capacity>_minChunk && _capacity<_maxReserved ? _capacity : _maxChunk;
+            std::size_t count=_carved[_class]<_minChunk ? _minChunk : _carved[_class];
+            if (count>limit) {
+                count=limit;
+            }
+            _chunks.reserve(_chunks.size()+1);
+            char* chunk=static_cast<char*>(::operator new(size*count));
+            _chunks.push_back(chunk);
+            for (std::size_t indx=count;indx>0;indx--) {
+                free_node* node=reinterpret_cast<free_node*>(chunk+(indx-1)*size);
+                node->next=_free[_class];
+                _free[_class]=node;
+            }
+            _carved[_class]+=count;
+        }
+    public:
+        _node_arena() : _chunks(), _capacity(0) {
+            for (std::size_t indx=0;indx<_classes;indx++) {
+                _free[indx]=nullptr;
+                _carved[indx]=0;
+            }
+        }
+        ~_node_arena() {
+            for (std::size_t indx=0;indx<_chunks.size();indx++) {
+                ::operator delete(_chunks[indx]);
+            }
+        }
+        _node_arena(const _node_arena&) = delete;
+        _node_arena& operator=(const _node_arena&) = delete;
+
+        static bool pooled(std::size_t _size, std::size_t _alignment) throw() {
+            return _size>0 && _size<=_granularity*_classes && _alignment<=_granularity;
+        }
+
+        void* allocate(std::size_t _size) {
+            std::size_t cls=(_size-1)/_granularity;
+            if (!_free[cls]) {
+                this->refill(cls);
+            }
+            free_node* node=_free[cls];
+            _free[cls]=node->next;
+            return node;
+        }
+        void deallocate(void* _p, std::size_t _size) throw() {
+            std::size_t cls=(_size-1)/_granularity;
+            free_node* node=static_cast<free_node*>(_p);
+            node->next=_free[cls];
+            _free[cls]=node;
+        }
+
+        /*
+         * Sets the expected number of nodes of every size, so the chunks grow up to it.
+         */
+        void reserve(std::size_t _n) throw() {
+            if (_n>_capacity) {
+                _capacity=_n;
+            }
+        }
+    };
+
+    /*
+     * Allocator, that takes single nodes from a node arena and passes everything else, like the hash table buckets, to the operator new.
+     * Every default constructed allocator gets it's own arena and the copies share it, so all the nodes of a container and of the
+     * containers, that are copies of each other's allocators, come from the same pools. Containers, that are copied, get a new arena.
+     * The arena is not synchronized, as it is only used under the lock of the cache, that owns the container.
+     */
+    template <class T>
+    class _pool_allocator {
+        template <class U> friend class _pool_allocator;
+
+        std::shared_ptr<_node_arena> _arena;
+    public:
+        using value_type = T ;
+        using propagate_on_container_copy_assignment = std::false_type ;
+        using propagate_on_container_move_assignment = std::true_type ;
+        using propagate_on_container_swap = std::true_type ;
+
+        template <class U>
+        struct rebind {
+            using other = _pool_allocator<U> ;
+        };
+
+        _pool_allocator() : _arena(std::make_shared<_node_arena>()) { }
+        _pool_allocator(const _pool_allocator<T>& x) throw() : _arena(x._arena) { }
+        template <class U>
+        _pool_allocator(const _pool_allocator<U>& x) throw() : _arena(x._arena) { }
+
+        T* allocate(std::size_t _n) {
+            if (_n==1 && _node_arena::pooled(sizeof(T),alignof(T))) {
+                return static_cast<T*>(_arena->allocate(sizeof(T)));
+            }
+            if (_n>std::numeric_limits<std::size_t>::max()/sizeof(T)) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(::operator new(_n*sizeof(T)));
+        }
+        void deallocate(T* _p, std::size_t _n) throw() {
+            if (_n==1 && _node_arena::pooled(sizeof(T),alignof(T))) {
+                _arena->deallocate(_p,sizeof(T));
+            } else {
+                ::operator delete(_p);
+            }
+        }
+        void reserve(std::size_t _n) throw() {
+            _arena->reserve(_n);
+        }
+        _pool_allocator<T> select_on_container_copy_construction() const {
+            return _pool_allocator<T>();
+        }
+
+        template <class U>
+        bool operator==(const _pool_allocator<U>& x) const throw() {
+            return _arena==x._arena;
+        }
+        template <class U>
+        bool operator!=(const _pool_allocator<U>& x) const throw() {
+            return _arena!=x._arena;
+        }
+    };
+
+    /*
+     * Passes the expected number of entries to the allocator of a container, if the allocator takes one.
+     */
+    template <class Alloc>
+    auto _allocator_reserve(Alloc _a, std::size_t _size, int) -> decltype(_a.reserve(_size)) {
+        return _a.reserve(_size);
+    }
+    template <class Alloc>
+    void _allocator_reserve(Alloc, std::size_t, long) {
+    }
+
+    /*!
+     * \brief The default allocation model
+     *
+     * Storage and policy nodes are allocated by the std::allocator.
+     *
+     * \see allocator_pool
+     */
+    struct allocator_std {
+        template <class T>
+        using bind = std::allocator<T> ;
+    };
+
+    /*!
+     * \brief Fixed size node pools
+     *
+     * Every container of the cache, that supports the allocation models, takes it's nodes from it's own set of node pools. Freed nodes are
+     * reused by the following insertions, so a cache, that churns at it's capacity, doesn't call the general purpose allocator at all,
+     * and the caches, like the shards of the \link stlcache::concurrent_cache concurrent_cache \endlink, don't compete for the malloc locks.
+     * The pools grow in chunks up to the maximum number of entries, passed to the cache constructor, and are released with the cache.
+     *
+     * \code
+     *     cache<int,string,policy_lru,container_unordered_map,weigher_unit,allocator_pool> c(100000);
+     * \endcode
+     *
+     * The storage containers and the \link stlcache::policy_lru LRU \endlink, \link stlcache::policy_lfu LFU \endlink,
+     * \link stlcache::policy_lfuaging LFU-Aging \endlink and \link stlcache::policy_adaptive Adaptive \endlink policies support it,
+     * other policies keep their own allocation.
+     *
+     * \see allocator_std
+     */
+    struct allocator_pool {
+        template <class T>
+        using bind = _pool_allocator<T> ;
+    };
+
+#ifdef STLCACHE_HAS_MEMORY_RESOURCE
+    namespace _pmr = std::experimental::pmr ;
+
+    /*
+     * Polymorphic allocator, that is bound to the resource, returned by Resource, when it is default constructed or copied by a container.
+     */
+    template <class T, _pmr::memory_resource* (*Resource)()>
+    class _resource_allocator : public _pmr::polymorphic_allocator<T> {
+    public:
+        template <class U>
+        struct rebind {
+            using other = _resource_allocator<U,Resource> ;
+        };
+
+        _resource_allocator() throw() : _pmr::polymorphic_allocator<T>(Resource()) { }
+        template <class U>
+        _resource_allocator(const _resource_allocator<U,Resource>& x) throw() : _pmr::polymorphic_allocator<T>(x.resource()) { }
+
+        _resource_allocator<T,Resource> select_on_container_copy_construction() const {
+            return _resource_allocator<T,Resource>();
+        }
+    };
+
+    /*!
+     * \brief Allocation from a std::experimental::pmr::memory_resource
+     *
+     * Available, when the cache is compiled as C++14 and the standard library provides the std::experimental::pmr resources of the
+     * Library Fundamentals Technical Specification. Storage and policy nodes are allocated from the memory resource, returned by the
+     * Resource function, for example from a resource, that belongs to the thread, that uses the cache.
+     *
+     * \code
+     *     std::experimental::pmr::memory_resource* arena() {
+     *         static thread_local arena_resource resource; //Derived from std::experimental::pmr::memory_resource
+     *         return &resource;
+     *     }
+     *     cache<int,string,policy_lru,container_unordered_map,weigher_unit,allocator_resource<arena> > c(100000);
+     * \endcode
+     *
+     * \tparam <Resource> Function, returning the memory resource
+     *
+     * \see allocator_pool
+     */
+    template <_pmr::memory_resource* (*Resource)()>
+    struct allocator_resource {
+        template <class T>
+        using bind = _resource_allocator<T,Resource> ;
+    };
+#endif
+
+    template <class T>
+    struct _allocator_void {
+        using type = void ;
+    };
+
+    /*
+     * Binds the policy or the container to the allocation model, when it provides an allocator_bind, and falls back to the plain bind
+     * otherwise. The default allocation model always gives the plain bind, so it doesn't change any types.
+     */
+    template <class Policy, class Key, class Allocator, class Enable = void>
+    struct _policy_bind {
+        using type = typename Policy::template bind<Key> ;
+    };
+    template <class Policy, class Key, class Allocator>
+    struct _policy_bind<Policy,Key,Allocator,typename std::enable_if<!std::is_same<Allocator,allocator_std>::value,typename _allocator_void<typename Policy::template allocator_bind<Key,Allocator> >::type>::type> {
+        using type = typename Policy::template allocator_bind<Key,Allocator> ;
+    };
+
+    template <class Container, class Key, class Data, class Allocator, class Enable = void>
+    struct _container_bind {
+        using type = typename Container::template bind<Key,Data> ;
+    };
+    template <class Container, class Key, class Data, class Allocator>
+    struct _container_bind<Container,Key,Data,Allocator,typename std::enable_if<!std::is_same<Allocator,allocator_std>::value,typename _allocator_void<typename Container::template allocator_bind<Key,Data,Allocator> >::type>::type> {
+        using type = typename Container::template allocator_bind<Key,Data,Allocator> ;
+    };
+}
+
+#endif /* STLCACHE_ALLOCATOR_HPP_INCLUDED */
@@ -0,0 +1,68 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_BITS_HPP_INCLUDED
+#define STLCACHE_BITS_HPP_INCLUDED
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif /* _MSC_VER */
+
+namespace stlcache {
+    /*
+     * Index of the highest and the lowest set bit. The argument must not be zero.
+     */
+    inline unsigned _bit_high(std::uint64_t _x) throw() {
+#if defined(__GNUC__)
+        return 63-__builtin_clzll(_x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long indx;
+        _BitScanReverse64(&indx,_x);
+        return indx;
+#else
+        unsigned indx=0;
+        while (_x>>=1) {
+            indx++;
+        }
+        return indx;
+#endif
+    }
+    inline unsigned _bit_low(std::uint64_t _x) throw() {
+#if defined(__GNUC__)
+        return __builtin_ctzll(_x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long indx;
+        _BitScanForward64(&indx,_x);
+        return indx;
+#else
+        unsigned indx=0;
+        while (!(_x&1)) {
+            _x>>=1;
+            indx++;
+        }
+        return indx;
+#endif
+    }
+
+    /*
+     * Number of set bits.
+     */
+    inline unsigned _bit_count(std::uint64_t _x) throw() {
+#if defined(__GNUC__)
+        return __builtin_popcountll(_x);
+#else
+        _x=_x-((_x>>1)&UINT64_C(0x5555555555555555));
+        _x=(_x&UINT64_C(0x3333333333333333))+((_x>>2)&UINT64_C(0x3333333333333333));
+        _x=(_x+(_x>>4))&UINT64_C(0x0F0F0F0F0F0F0F0F);
+        return static_cast<unsigned>((_x*UINT64_C(0x0101010101010101))>>56);
+#endif
+    }
+}
+
+#endif /* STLCACHE_BITS_HPP_INCLUDED */
@@ -12,9 +12,31 @@
 #pragma warning( disable : 4290 )
 #endif /* _MSC_VER */
 
+#include <cassert>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include <stlcache/allocator.hpp>
 #include <stlcache/exceptions.hpp>
+#include <stlcache/stats.hpp>
+#include <stlcache/policy.hpp>
+#include <stlcache/container.hpp>
+#include <stlcache/weigher.hpp>
+#include <stlcache/timing_wheel.hpp>
 
 namespace stlcache {
+    /*
+     * The default time to live of the cache together with the statistics model. The model is the base, so the empty stats_none doesn't
+     * take any space.
+     */
+    template <class Stats>
+    struct _ttl_stats : Stats {
+        std::chrono::milliseconds ttl;
+
+        explicit _ttl_stats(const std::chrono::milliseconds& _ttl) : Stats(), ttl(_ttl) { }
+    };
 
     /*! \brief Cache is a kind of a map that have limited number of elements to store and configurable policy for autoremoval of excessive elements.
      *  
@@ -50,13 +72,33 @@ namespace stlcache {
      * \tparam <Data> The value data type. You a free to use any type here without any restrictions, requirements and recommendations. 
      * \tparam <Policy> The expiration policy type. Must implement \link stlcache::policy policy interface \endlink STL::Cache provides several expiration policies out-of-box and you are free to define new policies. 
      * \tparam <Compare> Comparison class: A class that takes two arguments of the key type and returns a bool. The expression comp(a,b), where comp is an object of this comparison class and a and b are key values, shall return true if a is to be placed at an earlier position than b in a strict weak ordering operation. This can either be a class implementing a function call operator or a pointer to a function (see constructor for an example). This defaults to less<Key>, which returns the same as applying the less-than operator (a<b). This is required for the underlying std::map 
-     * \tparam <Allocator> Type of the allocator object used to define the storage allocation model. Unlike std::map you should pass a unspecialized Allocator type. 
+     * \tparam <Allocator> The allocation model of the storage and the policy nodes: \link stlcache::allocator_std allocator_std \endlink by default, \link stlcache::allocator_pool allocator_pool \endlink for the per cache node pools or \link stlcache::allocator_resource allocator_resource \endlink for a std::experimental::pmr::memory_resource. Unlike std::map you pass a model, not an allocator type. 
+     * \tparam <Stats> The statistics model: \link stlcache::stats_none stats_none \endlink by default, that collects nothing, or \link stlcache::stats_counters stats_counters \endlink, see \link cache::stats stats \endlink. 
      *  
      * So, the full example of cache instantiation will be: 
      * \code 
      *     cache<int,string,policy_none,less<string>,std::allocator> cache_none(100500);
      * \endcode
      *  
+     * By default the cache is bounded by the number of entries only. Supplying a Weigher and a maximum weight to the constructor also bounds 
+     * the total weight of the entries (for example, their size in bytes with \link stlcache::weigher_bytes weigher_bytes \endlink), 
+     * so entries are expired until the new one fits: 
+     * \code 
+     *     cache<int,string,policy_lru,container_unordered_map,weigher_bytes> cache_bytes(100000,64*1024*1024);
+     * \endcode
+     *  
+     * Entries could also have a time to live, either \link cache::set_default_ttl default \endlink for the whole cache or per entry: 
+     * \code 
+     *     cache_lru.insert("token","value",std::chrono::seconds(30));
+     * \endcode
+     * Expired entries are never returned by lookups. They are reclaimed by a hierarchical timing wheel on the next cache call, before 
+     * the policy is asked for a victim, so the \link cache::size size \endlink could include entries that are expired, but not reclaimed yet. 
+     *  
+     * The policy object is kept by value inside the cache and all policy calls are resolved at compile time, so the policy code could be inlined 
+     * into \link cache::fetch fetch \endlink and \link cache::insert insert \endlink. 
+     *  
+     * \tparam <Weigher> Functor, returning a weight of an entry, see \link stlcache::weigher_bytes weigher_bytes \endlink. Defaults to weigher_unit, so the weight is the number of entries. 
+     *  
      * \see policy 
      *  
      * \author chollya (5/19/2011)
@@ -65,19 +107,116 @@ namespace stlcache {
         class Key, 
         class Data, 
         class Policy, 
-        class Container = container_unordered_map
+        class Container = container_unordered_map,
+        class Weigher = weigher_unit,
+        class Allocator = allocator_std,
+        class Stats = stats_none
     >
     class cache {
-    	using container_type = typename Container::template bind<Key,Data> ;
+    	using container_type = typename _container_bind<Container,Key,Data,Allocator>::type ;
 		using storage_type = typename container_type::map_type ;
-		using policy_type = typename Policy::template bind<Key> ;
-		using policy_allocator_type = typename container_type::template allocator_type<policy_type> ;
+		using policy_type = typename _policy_bind<Policy,Key,Allocator>::type ;
+
+		static_assert(_is_policy<policy_type,Key>::value, "Policy::bind<Key> must provide insert, remove, touch, clear, swap and victim members");
 
 		storage_type _storage;
 		std::size_t _maxEntries;
 		std::size_t _currEntries;
-		policy_type* _policy;
-		policy_allocator_type policyAlloc;
+		std::size_t _maxWeight;
+		std::size_t _currWeight;
+		Weigher _weigher;
+		policy_type _policy;
+		std::unique_ptr<_timing_wheel<Key,Container> > _wheel;
+		_ttl_stats<Stats> _stats;
+
+		/*
+		 * Removes the storage node together with it's policy and weight bookkeeping. The expiration deadline is left to the caller.
+		 */
+		void drop(typename storage_type::iterator _it) throw() {
+			_currWeight-=_weigher(_it->first,_it->second);
+			_policy.remove(_it->first);
+			_storage.erase(_it);
+			_currEntries--;
+		}
+
+		/*
+		 * Reclaims the entries with passed deadlines. Without any ttl set it is just a pointer check.
+		 */
+		void expire() throw() {
+			if (_wheel && !_wheel->empty()) {
+				_wheel->advance(_wheel->clock(),[this](const Key& _k) {
+					this->drop(this->_storage.find(_k));
+					this->_stats.evict(eviction_expired);
+				});
+			}
+		}
+		bool expired(const Key& _k) const throw() {
+			return _wheel && !_wheel->empty() && _wheel->expired(_k,_wheel->clock());
+		}
+		void schedule(const Key& _k, const std::chrono::milliseconds& _ttl) {
+			if (_ttl>std::chrono::milliseconds::zero()) {
+				if (!_wheel) {
+					_wheel.reset(new _timing_wheel<Key,Container>());
+				}
+				_wheel->schedule(_k,_wheel->deadline(_ttl));
+			} else if (_wheel) {
+				_wheel->remove(_k);
+			}
+		}
+
+		/*
+		 * Removes the entry together with it's expiration deadline.
+		 */
+		bool remove(const Key& _k, eviction_reason _reason) throw() {
+			typename storage_type::iterator it=_storage.find(_k);
+			if (it==_storage.end()) {
+				return false;
+			}
+			if (_wheel) {
+				_wheel->remove(_k);
+			}
+			this->drop(it);
+			_stats.evict(_reason);
+			return true;
+		}
+
+		/*
+		 * Expires entries until both the entry count and the weight limits leave room for _entries more entries of _weight total.
+		 */
+		void reclaim(const std::size_t _entries, const std::size_t _weight) {
+			while (this->_currEntries+_entries > this->_maxEntries || this->_currWeight > this->_maxWeight-_weight) {
+				_victim<Key> victim=_policy.victim();
+				if (!victim) {
+					throw exception_cache_full("The cache is full and no element can be expired at the moment. Remove some elements manually");
+				}
+				this->remove(*victim,this->_currEntries+_entries > this->_maxEntries ? eviction_size : eviction_weight);
+			}
+		}
+
+		/*
+		 * Makes room for the freshly constructed storage node and registers it's key in the policy. The policy doesn't know about
+		 * the new key yet, so it could never be selected as a victim. On failure the node is dropped and the cache is left as it was.
+		 */
+		void admit(typename storage_type::iterator _it, const std::chrono::milliseconds& _ttl) {
+			const std::size_t weight=_weigher(_it->first,_it->second);
+			try {
+				if (weight>this->_maxWeight) {
+					throw exception_cache_full("The entry is heavier than the whole cache");
+				}
+				this->reclaim(1,weight);
+				this->schedule(_it->first,_ttl);
+				_policy.insert(_it->first);
+			} catch (...) {
+				if (_wheel) {
+					_wheel->remove(_it->first);
+				}
+				_storage.erase(_it);
+				throw;
+			}
+			_currEntries++;
+			_currWeight+=weight;
+			_stats.insert();
+		}
 
     public:
         /*! \brief The Key type 
@@ -116,6 +255,12 @@ namespace stlcache {
         /*! \brief Allocator::const_pointer 
           */
         using const_pointer = typename storage_type::const_pointer ;
+        /*! \brief Type used for the time to live of entries. Zero means the entry never expires 
+          */
+        using ttl_type = std::chrono::milliseconds ;
+        /*! \brief Whether the policy could be touched by several readers at once, under a shared lock
+          */
+        static const bool concurrent_touch = _policy_concurrent_touch<policy_type>::value;
 
         /*! \name std::map interface wrappers 
          *  Simple wrappers for std::map calls, that we are using only for mimicking the map interface
@@ -157,7 +302,7 @@ namespace stlcache {
           *  
           */        
         size_type count ( const key_type& x ) const throw() {
-            return _storage.count(x);
+            return this->expired(x) ? 0 : _storage.count(x);
         }
 
         /*! \brief Value comparision object accessor
@@ -216,32 +361,41 @@ namespace stlcache {
          */
         void clear() throw() {
             _storage.clear();
-            _policy->clear();
+            _policy.clear();
+            if (_wheel) {
+                _wheel->clear();
+            }
             this->_currEntries=0;
+            this->_currWeight=0;
         }
         
         /*!
          * \brief Swaps contents of two caches 
          *  
          * Exchanges the content of the cache with the content of mp, which is another cache object containing elements of the same type and using the same expiration policy. 
-         * Sizes may differ. Maximum number of entries may differ too.
+         * Sizes may differ. Maximum number of entries and maximum weight may differ too.
          *  
          * \param <mp> Another cache of the same type as this whose cache is swapped with that of this cache. 
          *  
-         * \throw <exception_invalid_policy> Thrown when the policies of the caches to swap are incompatible. 
+         * \throw <exception_invalid_policy> Never thrown, as policies of the same cache type are always compatible. 
          *  
          * \see cache::operator= 
          */
-        void swap ( cache<Key,Data,Policy,Container>& mp ) throw(exception_invalid_policy) {
+        void swap ( cache<Key,Data,Policy,Container,Weigher,Allocator,Stats>& mp ) throw(exception_invalid_policy) {
             _storage.swap(mp._storage);
-            _policy->swap(*mp._policy);
+            _policy.swap(mp._policy);
 
             std::size_t m=this->_maxEntries;
             this->_maxEntries=mp._maxEntries;
             mp._maxEntries=m;
 
-            this->_currEntries=this->size();
-            mp._currEntries=mp.size();
+            std::swap(this->_currEntries,mp._currEntries);
+            std::swap(this->_maxWeight,mp._maxWeight);
+            std::swap(this->_currWeight,mp._currWeight);
+            std::swap(this->_weigher,mp._weigher);
+            _wheel.swap(mp._wheel);
+            std::swap(this->_stats.ttl,mp._stats.ttl);
+            _stats.swap(mp._stats);
         }
 
         /*!
@@ -255,44 +409,202 @@ namespace stlcache {
          * \return 1 when entry is removed (ie number of removed emtries, which is always 1, as keys are unique) or zero when nothing was done. 
          */
         size_type erase ( const key_type& x ) throw() {
-            size_type ret=_storage.erase(x);
-            _policy->remove(x);
-
-            _currEntries--;
-
-            return ret;
+            return this->remove(x,eviction_explicit) ? 1 : 0;
         }
 
         /*!
          * \brief Insert element to the cache 
          *  
-         * The cache is extended by inserting a single new element. This effectively increases the cache size. Because cache do not allow for duplicate key values, the insertion operation checks for each element inserted whether another element exists already in the container with the same key value, if so, the element is not inserted and its mapped value is not changed in any way. 
+         * The cache is extended by inserting a single new element. This effectively increases the cache size and weight. Because cache do not allow for duplicate key values, the insertion operation checks for each element inserted whether another element exists already in the container with the same key value, if so, the element is not inserted and its mapped value is not changed in any way. 
          * Extension of cache could result in removal of some elements, depending of the cache fullness and used policy. It is also possible, that removal of excessive entries 
          * will fail, therefore insert operation will fail too. 
+         * Both arguments are moved into the storage, so pass temporaries (or std::move) for large values to avoid copying. 
          * 
-         * \throw <exception_cache_full>  Thrown when there are no available space in the cache and policy doesn't allows removal of elements. 
+         * \throw <exception_cache_full>  Thrown when there are no available space in the cache and policy doesn't allows removal of elements, or when the entry alone is heavier than the \link cache::max_weight maximum weight \endlink. 
          * \throw <exception_invalid_key> Thrown when the policy doesn't accepts the key 
          *  
          * \return true if the new elemented was inserted or false if an element with the same key existed. 
+         *  
+         * \see try_emplace 
+         * \see insert_or_assign 
          */
         bool insert(Key _k, Data _d) throw(exception_cache_full,exception_invalid_key) {
-            while (this->_currEntries >= this->_maxEntries) {
-                _victim<Key> victim=_policy->victim();
-                if (!victim) {
-                    throw exception_cache_full("The cache is full and no element can be expired at the moment. Remove some elements manually");
-                }
-                this->erase(*victim);
+            return this->try_emplace(std::move(_k),std::move(_d));
+        }
+
+        /*!
+         * \brief Insert element with a time to live
+         *  
+         * Works like \link cache::insert insert \endlink, but the new entry expires after the _ttl instead of the \link cache::set_default_ttl default time to live \endlink. 
+         * When the key already exists, neither the value nor it's time to live are changed. 
+         *  
+         * \param <_k> key of the entry 
+         * \param <_d> value of the entry 
+         * \param <_ttl> time to live of the entry, zero for the entry that never expires 
+         *  
+         * \throw <exception_cache_full>  Thrown when there are no available space in the cache and policy doesn't allows removal of elements. 
+         * \throw <exception_invalid_key> Thrown when the policy doesn't accepts the key 
+         *  
+         * \return true if the new elemented was inserted or false if an element with the same key existed. 
+         *  
+         * \see expire_after 
+         */
+        bool insert(Key _k, Data _d, const ttl_type& _ttl) throw(exception_cache_full,exception_invalid_key) {
+            this->expire();
+            std::pair<typename storage_type::iterator,bool> result=container_type::try_emplace(_storage,std::move(_k),std::move(_d));
+            if (result.second) {
+                this->admit(result.first,_ttl);
             }
+            return result.second;
+        }
 
-            _policy->insert(_k);
+        /*!
+         * \brief Construct element in place 
+         *  
+         * Constructs a new std::pair<const Key, Data> directly in the cache storage from the supplied arguments, exactly like std::map::emplace does. 
+         * The storage is looked up only once to decide, whether the key is new or not. When the key already exists, the element is not inserted 
+         * and the existing entry is not changed (but the arguments may be consumed by the pair construction). 
+         * Like the \link cache::insert insert call \endlink it could remove some elements, depending of the cache fullness and used policy. 
+         *  
+         * \param <args> arguments to forward to the std::pair<const Key, Data> constructor 
+         *  
+         * \throw <exception_cache_full>  Thrown when there are no available space in the cache and policy doesn't allows removal of elements. 
+         * \throw <exception_invalid_key> Thrown when the policy doesn't accepts the key 
+         *  
+         * \return true if the new elemented was inserted or false if an element with the same key existed. 
+         *  
+         * \see try_emplace 
+         */
+        template <class... Args>
+        bool emplace(Args&&... args) {
+            this->expire();
+            std::pair<typename storage_type::iterator,bool> result=_storage.emplace(std::forward<Args>(args)...);
+            if (result.second) {
+                this->admit(result.first,_stats.ttl);
+            }
+            return result.second;
+        }
 
+        /*!
+         * \brief Construct element in place if the key doesn't exist 
+         *  
+         * When the key is not in the cache, a new element is constructed in place, with the key moved or copied from _k and the value constructed 
+         * from the args. When the key already exists, nothing is done and the arguments are left untouched, so they could be safely moved in. 
+         * The storage is looked up only once to decide, whether the key is new or not. 
+         *  
+         * \param <_k> key of the entry 
+         * \param <args> arguments to forward to the Data constructor 
+         *  
+         * \throw <exception_cache_full>  Thrown when there are no available space in the cache and policy doesn't allows removal of elements. 
+         * \throw <exception_invalid_key> Thrown when the policy doesn't accepts the key 
+         *  
+         * \return true if the new elemented was inserted or false if an element with the same key existed. 
+         *  
+         * \see insert_or_assign 
+         */
+        template <class K, class... Args>
+        bool try_emplace(K&& _k, Args&&... args) {
+            this->expire();
+            std::pair<typename storage_type::iterator,bool> result=container_type::try_emplace(_storage,std::forward<K>(_k),std::forward<Args>(args)...);
+            if (result.second) {
+                this->admit(result.first,_stats.ttl);
+            }
+            return result.second;
+        }
+
+        /*!
+         * \brief Insert element or update the existing one 
+         *  
+         * When the key is not in the cache, a new element is inserted, exactly like \link cache::try_emplace try_emplace \endlink does. When the key 
+         * exists, the value is assigned (or move-assigned) to the existing entry and the entry is touched. 
+         * The storage is looked up only once in both cases. 
+         *  
+         * When the new value is heavier than the old one, other entries are expired until the cache fits it's maximum weight again. The updated 
+         * entry is not protected from the expiration, so with some policies it could be expired too. 
+         *  
+         * The time to live of the entry is restarted with the \link cache::set_default_ttl default time to live \endlink. 
+         *  
+         * \param <_k> key of the entry 
+         * \param <_d> new value of the entry 
+         *  
+         * \throw <exception_cache_full>  Thrown when there are no available space in the cache and policy doesn't allows removal of elements. 
+         * \throw <exception_invalid_key> Thrown when the policy doesn't accepts the key 
+         *  
+         * \return true if the new elemented was inserted or false if the existing entry was updated. 
+         */
+        template <class K, class M>
+        bool insert_or_assign(K&& _k, M&& _d) {
+            return this->insert_or_assign(std::forward<K>(_k),std::forward<M>(_d),_stats.ttl);
+        }
 
-            bool result=_storage.insert(value_type(_k,_d)).second;
-            if (result) {
-                _currEntries++;
+        /*!
+         * \brief Insert element or update the existing one, with a time to live
+         *  
+         * Works like \link cache::insert_or_assign insert_or_assign \endlink, but the entry expires after the _ttl. 
+         *  
+         * \param <_k> key of the entry 
+         * \param <_d> new value of the entry 
+         * \param <_ttl> time to live of the entry, zero for the entry that never expires 
+         *  
+         * \return true if the new elemented was inserted or false if the existing entry was updated. 
+         */
+        template <class K, class M>
+        bool insert_or_assign(K&& _k, M&& _d, const ttl_type& _ttl) {
+            this->expire();
+            std::pair<typename storage_type::iterator,bool> result=container_type::try_emplace(_storage,std::forward<K>(_k),std::forward<M>(_d));
+            if (result.second) {
+                this->admit(result.first,_ttl);
+            } else {
+                _currWeight-=_weigher(result.first->first,result.first->second);
+                result.first->second=std::forward<M>(_d);
+                _currWeight+=_weigher(result.first->first,result.first->second);
+                this->schedule(result.first->first,_ttl);
+                _policy.touch(result.first->first);
+                _stats.update();
+                if (_currWeight>_maxWeight) {
+                    this->reclaim(0,0);
+                }
             }
+            return result.second;
+        }
 
-            return result;
+        /*!
+         * \brief Changes the time to live of an entry 
+         *  
+         * Restarts the expiration countdown of an existing entry. 
+         *  
+         * \param <_k> key of the entry 
+         * \param <_ttl> new time to live of the entry, zero for the entry that never expires 
+         *  
+         * \return true if the entry exists and false otherwise 
+         */
+        bool expire_after(const Key& _k, const ttl_type& _ttl) {
+            this->expire();
+            if (_storage.find(_k)==_storage.end()) {
+                return false;
+            }
+            this->schedule(_k,_ttl);
+            return true;
+        }
+
+        /*!
+         * \brief Sets the default time to live 
+         *  
+         * The default time to live is applied to the entries, that are inserted without explicit ttl. Existing entries are not changed. 
+         *  
+         * \param <_ttl> the default time to live, zero (the default) for the entries that never expire 
+         */
+        void set_default_ttl(const ttl_type& _ttl) throw() {
+            _stats.ttl=_ttl;
+        }
+
+        /*!
+         * \brief Default time to live accessor 
+         *  
+         * \return The time to live of the entries, that are inserted without explicit ttl. 
+         */
+        ttl_type default_ttl() const throw() {
+            return _stats.ttl;
         }
 
         /*!
@@ -309,6 +621,32 @@ namespace stlcache {
             return this->_maxEntries;
         }
 
+        /*!
+         * \brief Maximum cache weight accessor
+         *  
+         * Returns the maximum total weight of the entries, specified at construction time. 
+         *  
+         * \return The maximum weight a cache can have as its content. 
+         *  
+         * \see weight 
+         */
+        std::size_t max_weight() const throw() {
+            return this->_maxWeight;
+        }
+
+        /*!
+         * \brief Current cache weight accessor
+         *  
+         * Returns the sum of weights of all entries in the cache, as computed by the Weigher. With the default weigher_unit it is the same as \link cache::size size \endlink. 
+         *  
+         * \return The total weight of the cache content. 
+         *  
+         * \see max_weight 
+         */
+        std::size_t weight() const throw() {
+            return this->_currWeight;
+        }
+
         /*! \brief Counts entries in the cache.
           *  
           *  Provides information on number of cache entries. For checking, whether the cache empty or not, please use the \link cache::empty empty function \endlink 
@@ -326,7 +664,7 @@ namespace stlcache {
         /*!
          * \brief Access cache data 
          *  
-         * Accessor to the data (values) stored in cache. If the specified key exists in the cache, it's usage count will be touched and reference to the element is returned. 
+         * Accessor to the data (values) stored in cache. If the specified key exists in the cache, it's usage count will be touched once and reference to the element is returned. 
          * The data object itself is kept in the cache, so the reference will be valid until it is removed (either manually or due to cache overflow) or cache object destroyed. 
          *  
          * \param <_k> key to the data 
@@ -336,13 +674,120 @@ namespace stlcache {
          * \return constand reference to the data, mapped by the key. of type Data of course. 
          *  
          * \see check 
+         * \see try_get 
          */
         const Data& fetch(const Key& _k) throw(exception_invalid_key) {
-            if (!check(_k)) {
+            const Data* data=try_get(_k);
+            if (!data) {
                 throw exception_invalid_key("Key is not in cache",_k);
             }
-            _policy->touch(_k);
-            return (*(_storage.find(_k))).second;
+            return *data;
+        }
+
+        /*!
+         * \brief Access cache data without exceptions
+         *  
+         * Looks up the key in the storage once and, if it is found, touches it's usage count once. Unlike the \link cache::check check \endlink 
+         * and \link cache::fetch fetch \endlink pair, this costs only a single storage lookup and a single policy update. 
+         * The returned pointer is valid until the entry is removed (either manually or due to cache overflow) or cache object destroyed. 
+         *  
+         * \param <_k> key to the data 
+         *  
+         * \return pointer to the data, mapped by the key, or nullptr when the key is not in the cache 
+         *  
+         * \see peek 
+         * \see fetch 
+         */
+        const Data* try_get(const Key& _k) throw() {
+            this->expire();
+            typename storage_type::const_iterator it=_storage.find(_k);
+            if (it==_storage.end()) {
+                _stats.miss();
+                return nullptr;
+            }
+            _stats.hit();
+            _policy.touch(_k);
+            return &(it->second);
+        }
+
+        /*!
+         * \brief Access cache data, loading it on a miss 
+         *  
+         * Read-through access: when the key is in the cache, it is touched and it's value is returned, exactly like \link cache::fetch fetch \endlink does. 
+         * Otherwise the _loader is called with the key, the value it returns is inserted into the cache with the \link cache::set_default_ttl default time to live \endlink 
+         * and returned. Exceptions, thrown by the loader, are passed to the caller and nothing is inserted. 
+         *  
+         * \param <_k> key to the data 
+         * \param <_loader> functor, that takes the key and returns a value for it 
+         *  
+         * \throw <exception_cache_full>  Thrown when the loaded value can't be inserted into the cache. 
+         *  
+         * \return constant reference to the data, mapped by the key. 
+         *  
+         * \see concurrent_cache::get_or_load 
+         */
+        template <class Loader>
+        const Data& get_or_load(const Key& _k, Loader _loader) {
+            const Data* data=this->try_get(_k);
+            if (data) {
+                return *data;
+            }
+            std::pair<typename storage_type::iterator,bool> result;
+            typename Stats::timer_type timer=_stats.load_started();
+            try {
+                result=container_type::try_emplace(_storage,_k,_loader(_k));
+            } catch (...) {
+                _stats.load_finished(timer,false);
+                throw;
+            }
+            _stats.load_finished(timer,true);
+            if (result.second) {
+                this->admit(result.first,_stats.ttl);
+            }
+            return result.first->second;
+        }
+
+        /*!
+         * \brief Access cache data without touching it
+         *  
+         * Looks up the key in the storage, but doesn't change it's usage count, so the policy doesn't know about this access at all. 
+         *  
+         * \param <_k> key to the data 
+         *  
+         * \return pointer to the data, mapped by the key, or nullptr when the key is not in the cache 
+         *  
+         * \see try_get 
+         * \see count 
+         */
+        const Data* peek(const Key& _k) const throw() {
+            typename storage_type::const_iterator it=_storage.find(_k);
+            if (it==_storage.end() || this->expired(_k)) {
+                return nullptr;
+            }
+            return &(it->second);
+        }
+
+        /*!
+         * \brief Access cache data without touching it, counting the access
+         *  
+         * Works like \link cache::peek peek \endlink, but the lookup is counted as a hit or a miss in the \link cache::stats statistics \endlink. 
+         * It is meant for the callers, that touch the policy on their own, like the \link stlcache::concurrency_buffered buffered \endlink 
+         * shards of the \link stlcache::concurrent_cache concurrent_cache \endlink. 
+         *  
+         * \param <_k> key to the data 
+         *  
+         * \return pointer to the data, mapped by the key, or nullptr when the key is not in the cache 
+         *  
+         * \see peek 
+         */
+        const Data* probe(const Key& _k) const throw() {
+            const Data* data=this->peek(_k);
+            if (data) {
+                _stats.hit();
+            } else {
+                _stats.miss();
+            }
+            return data;
         }
 
         /*!
@@ -357,8 +802,14 @@ namespace stlcache {
          * \see count 
          */
         const bool check(const Key& _k) throw() {
-            _policy->touch(_k);
-            return _storage.count(_k)==1;
+            this->expire();
+            _policy.touch(_k);
+            if (_storage.count(_k)==1) {
+                _stats.hit();
+                return true;
+            }
+            _stats.miss();
+            return false;
         }
 
         /*!
@@ -371,7 +822,32 @@ namespace stlcache {
          *  
          */
         void touch(const Key& _k) throw() {
-            _policy->touch(_k);
+            _policy.touch(_k);
+        }
+
+        /*!
+         * \brief Statistics snapshot
+         *  
+         * Returns the hit, miss, insert, update, eviction and load counters, collected by the Stats model. With the default 
+         * \link stlcache::stats_none stats_none \endlink nothing is collected and all the counters are zero. 
+         *  
+         * Lookups by \link cache::try_get try_get \endlink, \link cache::fetch fetch \endlink, \link cache::check check \endlink and 
+         * \link cache::get_or_load get_or_load \endlink are counted, \link cache::peek peek \endlink and \link cache::count count \endlink are not. 
+         * Entries, dropped by \link cache::clear clear \endlink, are not counted as evictions. 
+         *  
+         * \return counters since the cache construction or the last \link cache::reset_stats reset_stats \endlink call 
+         *  
+         * \see cache_stats::prometheus 
+         */
+        cache_stats stats() const throw() {
+            return _stats.snapshot();
+        }
+
+        /*!
+         * \brief Resets the statistics counters to zero
+         */
+        void reset_stats() throw() {
+            _stats.reset();
         }
         //@}
 
@@ -389,14 +865,16 @@ namespace stlcache {
          *  
          * \see swap 
          */
-        cache<Key,Data,Policy,Container>& operator= ( const cache<Key,Data,Policy,Container>& x) throw() {
+        cache<Key,Data,Policy,Container,Weigher,Allocator,Stats>& operator= ( const cache<Key,Data,Policy,Container,Weigher,Allocator,Stats>& x) throw() {
             this->_storage=x._storage;
             this->_maxEntries=x._maxEntries;
             this->_currEntries=this->_storage.size();
-
-            policy_type localPolicy(*x._policy);
-            this->_policy = policyAlloc.allocate(1);
-            policyAlloc.construct(this->_policy,localPolicy);
+            this->_maxWeight=x._maxWeight;
+            this->_currWeight=x._currWeight;
+            this->_weigher=x._weigher;
+            this->_policy=x._policy;
+            this->_wheel.reset(x._wheel ? new _timing_wheel<Key,Container>(*x._wheel) : nullptr);
+            this->_stats=x._stats;
             return *this;
         }
 
@@ -407,8 +885,7 @@ namespace stlcache {
          *  
          *  \param <x> a cache object with the same template parameters 
          */
-        cache(const cache<Key,Data,Policy,Container>& x) throw() {
-            *this=x;
+        cache(const cache<Key,Data,Policy,Container,Weigher,Allocator,Stats>& x) throw() : _storage(x._storage), _maxEntries(x._maxEntries), _currEntries(x._currEntries), _maxWeight(x._maxWeight), _currWeight(x._currWeight), _weigher(x._weigher), _policy(x._policy), _wheel(x._wheel ? new _timing_wheel<Key,Container>(*x._wheel) : nullptr), _stats(x._stats) {
         }
         /*!
          * \brief Primary constructor. 
@@ -417,16 +894,14 @@ namespace stlcache {
          * You could also  pass optional comparator object, compatible with Compare. 
          *  
          * \param <size> Maximum number of entries, allowed in the cache. 
+         * \param <max_weight> Maximum total weight of the entries, allowed in the cache. Unlimited by default. 
+         * \param <weigher> Weigher object, used to compute the entry weights. 
          * 
          */
-        explicit cache(const size_type size) throw() {
-            this->_storage=storage_type();
-            this->_maxEntries=size;
-            this->_currEntries=0;
-
-            policy_type localPolicy(size);
-            this->_policy = policyAlloc.allocate(1);
-            policyAlloc.construct(this->_policy,localPolicy);
+        explicit cache(const size_type size, const std::size_t max_weight = std::numeric_limits<std::size_t>::max(), const Weigher& weigher = Weigher()) throw() : _storage(), _maxEntries(size), _currEntries(0), _maxWeight(max_weight), _currWeight(0), _weigher(weigher), _policy(size), _wheel(), _stats(ttl_type::zero()) {
+            if (max_weight==std::numeric_limits<std::size_t>::max()) {
+                _container_reserve<container_type>(_storage,size,0);
+            }
         }
 
         /*!
@@ -436,8 +911,6 @@ namespace stlcache {
          * 
          */
         ~cache() {
-            policyAlloc.destroy(this->_policy);
-            policyAlloc.deallocate(this->_policy,1);
         }
         //@}
     };
@@ -0,0 +1,294 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_CONCURRENCY_HPP_INCLUDED
+#define STLCACHE_CONCURRENCY_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+namespace stlcache {
+    /*
+     * Size of the cache line, that shards and buffers are aligned to, so neighbours never share a line.
+     */
+    const std::size_t _cache_line_size = 64;
+
+    /*
+     * Writer preferring reader-writer spinlock. A writer blocks new readers first and then waits for the active ones to leave,
+     * so a stream of readers can't starve it.
+     */
+    class _spin_rwlock {
+        static const std::uint32_t _writer = 1u<<31;
+        std::atomic<std::uint32_t> _state;
+    public:
+        _spin_rwlock() throw() : _state(0) { }
+
+        void lock() throw() {
+            std::uint32_t state=_state.load(std::memory_order_relaxed);
+            for (;;) {
+                if (state&_writer) {
+                    std::this_thread::yield();
+                    state=_state.load(std::memory_order_relaxed);
+                } else if (_state.compare_exchange_weak(state,state|_writer,std::memory_order_acquire,std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            while (_state.load(std::memory_order_acquire)!=_writer) {
+                std::this_thread::yield();
+            }
+        }
+        bool try_lock() throw() {
+            std::uint32_t state=0;
+            return _state.compare_exchange_strong(state,_writer,std::memory_order_acquire,std::memory_order_relaxed);
+        }
+        void unlock() throw() {
+            _state.store(0,std::memory_order_release);
+        }
+
+        void lock_shared() throw() {
+            std::uint32_t state=_state.load(std::memory_order_relaxed);
+            for (;;) {
+                if (state&_writer) {
+                    std::this_thread::yield();
+                    state=_state.load(std::memory_order_relaxed);
+                } else if (_state.compare_exchange_weak(state,state+1,std::memory_order_acquire,std::memory_order_relaxed)) {
+                    return;
+                }
+            }
+        }
+        void unlock_shared() throw() {
+            _state.fetch_sub(1,std::memory_order_release);
+        }
+    };
+
+    /*
+     * The std::lock_guard counterpart for the shared side of a lock.
+     */
+    template <class Lockable>
+    class _shared_lock_guard {
+        Lockable& _lock;
+    public:
+        explicit _shared_lock_guard(Lockable& _l) : _lock(_l) {
+            _lock.lock_shared();
+        }
+        ~_shared_lock_guard() {
+            _lock.unlock_shared();
+        }
+        _shared_lock_guard(const _shared_lock_guard<Lockable>&) = delete;
+        _shared_lock_guard<Lockable>& operator=(const _shared_lock_guard<Lockable>&) = delete;
+    };
+
+    /*!
+     * \brief Every shard access is serialized by a mutex
+     *
+     * The default concurrency mode of the \link stlcache::concurrent_cache concurrent_cache \endlink. Reads are touching the
+     * policy immediately, so the policy sees exactly the same access sequence as a single threaded \link stlcache::cache cache \endlink
+     * would see, but every read has to take the exclusive lock of the shard.
+     *
+     * \see concurrency_buffered
+     */
+    struct concurrency_locked {
+        template <class Cache>
+        struct alignas(_cache_line_size) bind final {
+            using key_type = typename Cache::key_type ;
+            using mapped_type = typename Cache::mapped_type ;
+
+            std::mutex _lock;
+            Cache storage;
+
+            bind(std::size_t _size, std::size_t _weight) : _lock(), storage(_size,_weight) { }
+
+            void lock() {
+                _lock.lock();
+            }
+            void unlock() {
+                _lock.unlock();
+            }
+            void lock_shared() {
+                _lock.lock();
+            }
+            void unlock_shared() {
+                _lock.unlock();
+            }
+
+            template <class F>
+            bool read(const key_type& _k, F _f) {
+                std::lock_guard<std::mutex> guard(_lock);
+                const mapped_type* data=storage.try_get(_k);
+                if (!data) {
+                    return false;
+                }
+                _f(*data);
+                return true;
+            }
+            void touch(const key_type& _k) {
+                std::lock_guard<std::mutex> guard(_lock);
+                storage.touch(_k);
+            }
+        };
+    };
+
+    /*!
+     * \brief Reads share the shard lock and policy updates are buffered
+     *
+     * Hits are looked up under the shared side of a reader-writer lock, without touching the policy. Instead, the key is recorded into
+     * one of the small per-shard buffers, selected by the calling thread. When a buffer fills up, the thread that manages to grab the
+     * exclusive lock without waiting replays all the buffered touches into the policy. Writers replay the buffers too, before changing
+     * the shard, so the policy is reasonably fresh when it selects a victim.
+     *
+     * The buffers are lossy: when a buffer is full or busy and nobody is able to drain it, the touch is dropped. Only the approximate order
+     * of accesses matters for the expiration policies, so the hit ratio barely changes, but the reads are no longer serialized on the policy.
+     *
+     * Policies, that could be touched concurrently, like the \link stlcache::policy_clock policy_clock \endlink, are not buffered at all: hits
+     * touch them directly under the shared lock.
+     *
+     * \code
+     *     concurrent_cache<int,string,policy_lru,container_unordered_map,weigher_unit,std::hash<int>,concurrency_buffered> c(100000);
+     * \endcode
+     *
+     * \see concurrency_locked
+     */
+    struct concurrency_buffered {
+        template <class Cache>
+        struct alignas(_cache_line_size) bind final {
+            using key_type = typename Cache::key_type ;
+            using mapped_type = typename Cache::mapped_type ;
+
+            static const std::size_t _stripes = 4;
+            static const std::size_t _slots = 16;
+
+            struct alignas(_cache_line_size) stripe_type {
+                std::atomic<bool> busy;
+                std::size_t count;
+                typename std::aligned_storage<sizeof(key_type),alignof(key_type)>::type slots[_slots];
+
+                stripe_type() throw() : busy(false), count(0) { }
+            };
+
+            _spin_rwlock _lock;
+            Cache storage;
+            stripe_type _buffers[_stripes];
+
+            static std::size_t stripe_index() throw() {
+                static thread_local std::size_t index=static_cast<std::size_t>((static_cast<std::uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()))*UINT64_C(0x9E3779B97F4A7C15))>>32)%_stripes;
+                return index;
+            }
+
+            static key_type* slot(stripe_type& _s, std::size_t _indx) throw() {
+                return reinterpret_cast<key_type*>(&_s.slots[_indx]);
+            }
+
+            /*
+             * Replays buffered touches into the policy. Must be called with the exclusive lock held.
+             */
+            void drain() throw() {
+                for (std::size_t indx=0;indx<_stripes;indx++) {
+                    stripe_type& s=_buffers[indx];
+                    while (s.busy.exchange(true,std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    for (std::size_t pos=0;pos<s.count;pos++) {
+                        storage.touch(*slot(s,pos));
+                        slot(s,pos)->~key_type();
+                    }
+                    s.count=0;
+                    s.busy.store(false,std::memory_order_release);
+                }
+            }
+
+            void record(const key_type& _k) throw() {
+                stripe_type& s=_buffers[stripe_index()];
+                if (s.busy.exchange(true,std::memory_order_acquire)) {
+                    return;
+                }
+                if (s.count<_slots) {
+                    try {
+                        new (slot(s,s.count)) key_type(_k);
+                        s.count++;
+                    } catch (...) {
+                    }
+                }
+                bool full=s.count==_slots;
+                s.busy.store(false,std::memory_order_release);
+
+                if (full && _lock.try_lock()) {
+                    this->drain();
+                    _lock.unlock();
+                }
+            }
+
+            bind(std::size_t _size, std::size_t _weight) : _lock(), storage(_size,_weight) { }
+            ~bind() {
+                for (std::size_t indx=0;indx<_stripes;indx++) {
+                    for (std::size_t pos=0;pos<_buffers[indx].count;pos++) {
+                        slot(_buffers[indx],pos)->~key_type();
+                    }
+                }
+            }
+
+            void lock() throw() {
+                _lock.lock();
+                this->drain();
+            }
+            void unlock() throw() {
+                _lock.unlock();
+            }
+            void lock_shared() throw() {
+                _lock.lock_shared();
+            }
+            void unlock_shared() throw() {
+                _lock.unlock_shared();
+            }
+
+            /*
+             * Policies, that could be touched concurrently, are touched right away under the shared lock, the others are buffered.
+             */
+            void hit(const key_type& _k, std::true_type) throw() {
+                storage.touch(_k);
+            }
+            void hit(const key_type&, std::false_type) throw() {
+            }
+            void buffer(const key_type&, std::true_type) throw() {
+            }
+            void buffer(const key_type& _k, std::false_type) throw() {
+                this->record(_k);
+            }
+
+            template <class F>
+            bool read(const key_type& _k, F _f) {
+                std::integral_constant<bool,Cache::concurrent_touch> concurrent;
+                {
+                    _shared_lock_guard<_spin_rwlock> guard(_lock);
+                    const mapped_type* data=storage.probe(_k);
+                    if (!data) {
+                        return false;
+                    }
+                    _f(*data);
+                    this->hit(_k,concurrent);
+                }
+                this->buffer(_k,concurrent);
+                return true;
+            }
+            void touch(const key_type& _k) throw() {
+                std::integral_constant<bool,Cache::concurrent_touch> concurrent;
+                {
+                    _shared_lock_guard<_spin_rwlock> guard(_lock);
+                    this->hit(_k,concurrent);
+                }
+                this->buffer(_k,concurrent);
+            }
+        };
+    };
+}
+
+#endif /* STLCACHE_CONCURRENCY_HPP_INCLUDED */
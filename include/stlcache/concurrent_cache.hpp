@@ -0,0 +1,564 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_CONCURRENT_CACHE_HPP_INCLUDED
+#define STLCACHE_CONCURRENT_CACHE_HPP_INCLUDED
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4290 )
+#endif /* _MSC_VER */
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include <stlcache/exceptions.hpp>
+#include <stlcache/allocator.hpp>
+#include <stlcache/cache.hpp>
+#include <stlcache/stats.hpp>
+#include <stlcache/concurrency.hpp>
+
+namespace stlcache {
+
+    /*! \brief Thread-safe cache, partitioned over a number of independent shards
+     *
+     * The concurrent_cache hashes every key to one of the shards, and each shard is a plain \link stlcache::cache cache \endlink,
+     * protected by it's own lock. Threads, that work with keys from different shards, never contend on the same lock, so the throughput
+     * grows with the number of cores instead of serializing on the single cache-wide mutex.
+     *
+     * \code
+     *     concurrent_cache<string,string,policy_lru> cache_lru(100000);
+     *     cache_lru.insert("key","value");
+     *     string value;
+     *     if (cache_lru.try_get("key",value)) {
+     *         cout<<"We have some value in the cache: "<<value;
+     *     }
+     * \endcode
+     *
+     * The maximum number of entries (and the maximum weight) is split evenly between the shards and every shard applies the policy
+     * to it's own entries only, so the cache as a whole is an approximation of the policy. As the references to the stored values could be
+     * invalidated by the other threads at any moment, all the accessors are returning copies of the values.
+     *
+     * By default every access locks the shard exclusively. With \link stlcache::concurrency_buffered concurrency_buffered \endlink hits
+     * are served under a shared lock and their policy updates are buffered and applied in batches.
+     *
+     * \tparam <Key> The key data type.
+     * \tparam <Data> The value data type. Must be copyable.
+     * \tparam <Policy> The expiration policy type.
+     * \tparam <Container> A specialiser for internal container.
+     * \tparam <Weigher> Weigher for the entries, see \link stlcache::cache cache \endlink.
+     * \tparam <Hash> Hash function, used for the shard selection.
+     * \tparam <Concurrency> Shard locking mode, \link stlcache::concurrency_locked concurrency_locked \endlink or \link stlcache::concurrency_buffered concurrency_buffered \endlink.
+     * \tparam <Allocator> Allocation model of the shards, see \link stlcache::cache cache \endlink. Every shard gets it's own \link stlcache::allocator_pool node pools \endlink.
+     * \tparam <Stats> Statistics model of the shards, see \link concurrent_cache::stats stats \endlink.
+     *
+     * \see cache
+     */
+    template<
+        class Key,
+        class Data,
+        class Policy,
+        class Container = container_unordered_map,
+        class Weigher = weigher_unit,
+        class Hash = std::hash<Key>,
+        class Concurrency = concurrency_locked,
+        class Allocator = allocator_std,
+        class Stats = stats_none
+    >
+    class concurrent_cache {
+        using cache_type = cache<Key,Data,Policy,Container,Weigher,Allocator,Stats> ;
+        using shard_type = typename Concurrency::template bind<cache_type> ;
+        using lock_type = std::lock_guard<shard_type> ;
+        using shared_lock_type = _shared_lock_guard<shard_type> ;
+
+        void* _memory;
+        shard_type* _shards;
+        std::size_t _shardCount;
+        unsigned int _shardBits;
+        std::size_t _maxEntries;
+        Hash _hash;
+
+        /*
+         * Loads, that are in progress for the keys of a shard. Concurrent misses for the same key wait on the single future.
+         * Loader calls are counted here, as they run without the shard lock.
+         */
+        struct flight_type {
+            std::mutex lock;
+            std::unordered_map<Key,std::shared_future<Data>,Hash> calls;
+            Stats stats;
+        };
+        std::unique_ptr<flight_type[]> _flights;
+
+        /*
+         * Fibonacci hashing over the user hash, so identity hashes (like std::hash<int>) are spread over all the shards too.
+         */
+        std::size_t shard_index(const Key& _k) const throw() {
+            if (_shardBits==0) {
+                return 0;
+            }
+            std::uint64_t h=static_cast<std::uint64_t>(_hash(_k))*UINT64_C(0x9E3779B97F4A7C15);
+            return static_cast<std::size_t>(h>>(64-_shardBits));
+        }
+        shard_type& shard(const Key& _k) const throw() {
+            return _shards[shard_index(_k)];
+        }
+
+        static std::size_t default_shards() throw() {
+            std::size_t hint=std::thread::hardware_concurrency();
+            return hint ? hint*4 : 16;
+        }
+
+        void destroy(std::size_t _count) throw() {
+            for (std::size_t indx=0;indx<_count;indx++) {
+                _shards[indx].~shard_type();
+            }
+            ::operator delete(_memory);
+        }
+
+    public:
+        /*! \brief The Key type
+         */
+        using key_type = Key ;
+        /*!  \brief The Data type
+         */
+        using mapped_type = Data ;
+        /*! \brief Type used for storing object sizes, specific to a current platform (usually a size_t)
+          */
+        using size_type = std::size_t ;
+        /*! \brief Type used for the time to live of entries
+          */
+        using ttl_type = typename cache_type::ttl_type ;
+
+        /*! \brief Counts entries with specified key in the cache.
+          *
+          *  Doesn't touch the entry.
+          *
+          *  \param <x> key to count
+          *
+          *  \return 1 if object is on the cache and 0 for non-existent object
+          */
+        size_type count ( const key_type& x ) const {
+            shard_type& s=shard(x);
+            shared_lock_type guard(s);
+            return s.storage.count(x);
+        }
+
+        /*! \brief Test whether cache is empty
+          *
+          *  Shards are checked one by one, so the result may be outdated already, when other threads modify the cache.
+          *
+          *  \return true if all the shards are empty, false otherwise.
+          */
+        bool empty() const {
+            for (std::size_t indx=0;indx<_shardCount;indx++) {
+                shared_lock_type guard(_shards[indx]);
+                if (!_shards[indx].storage.empty()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /*!
+         * \brief Clear the cache
+         *
+         * Clears shards one by one, entries, that are inserted concurrently, may survive the call.
+         */
+        void clear() {
+            for (std::size_t indx=0;indx<_shardCount;indx++) {
+                lock_type guard(_shards[indx]);
+                _shards[indx].storage.clear();
+            }
+        }
+
+        /*!
+         * \brief Removes a entry from cache
+         *
+         * \param <x> Key to remove.
+         *
+         * \return 1 when entry is removed or zero when nothing was done.
+         */
+        size_type erase ( const key_type& x ) {
+            shard_type& s=shard(x);
+            lock_type guard(s);
+            return s.storage.erase(x);
+        }
+
+        /*!
+         * \brief Insert element to the cache
+         *
+         * Works like \link cache::insert cache::insert \endlink within the key's shard.
+         *
+         * \throw <exception_cache_full>  Thrown when there are no available space in the shard and policy doesn't allows removal of elements.
+         * \throw <exception_invalid_key> Thrown when the policy doesn't accepts the key
+         *
+         * \return true if the new elemented was inserted or false if an element with the same key existed.
+         */
+        bool insert(Key _k, Data _d) {
+            shard_type& s=shard(_k);
+            lock_type guard(s);
+            return s.storage.try_emplace(std::move(_k),std::move(_d));
+        }
+
+        /*!
+         * \brief Insert element with a time to live
+         *
+         * \param <_k> key of the entry
+         * \param <_d> value of the entry
+         * \param <_ttl> time to live of the entry, zero for the entry that never expires
+         *
+         * \return true if the new elemented was inserted or false if an element with the same key existed.
+         *
+         * \see cache::insert
+         */
+        bool insert(Key _k, Data _d, const ttl_type& _ttl) {
+            shard_type& s=shard(_k);
+            lock_type guard(s);
+            return s.storage.insert(std::move(_k),std::move(_d),_ttl);
+        }
+
+        /*!
+         * \brief Construct element in place if the key doesn't exist
+         *
+         * \param <_k> key of the entry
+         * \param <args> arguments to forward to the Data constructor
+         *
+         * \return true if the new elemented was inserted or false if an element with the same key existed.
+         *
+         * \see cache::try_emplace
+         */
+        template <class K, class... Args>
+        bool try_emplace(K&& _k, Args&&... args) {
+            shard_type& s=shard(_k);
+            lock_type guard(s);
+            return s.storage.try_emplace(std::forward<K>(_k),std::forward<Args>(args)...);
+        }
+
+        /*!
+         * \brief Insert element or update the existing one
+         *
+         * \param <_k> key of the entry
+         * \param <_d> new value of the entry
+         *
+         * \return true if the new elemented was inserted or false if the existing entry was updated.
+         *
+         * \see cache::insert_or_assign
+         */
+        template <class K, class M>
+        bool insert_or_assign(K&& _k, M&& _d) {
+            shard_type& s=shard(_k);
+            lock_type guard(s);
+            return s.storage.insert_or_assign(std::forward<K>(_k),std::forward<M>(_d));
+        }
+
+        /*!
+         * \brief Changes the time to live of an entry
+         *
+         * \param <_k> key of the entry
+         * \param <_ttl> new time to live of the entry, zero for the entry that never expires
+         *
+         * \return true if the entry exists and false otherwise
+         *
+         * \see cache::expire_after
+         */
+        bool expire_after(const Key& _k, const ttl_type& _ttl) {
+            shard_type& s=shard(_k);
+            lock_type guard(s);
+            return s.storage.expire_after(_k,_ttl);
+        }
+
+        /*!
+         * \brief Sets the default time to live of all the shards
+         *
+         * \param <_ttl> the default time to live, zero for the entries that never expire
+         *
+         * \see cache::set_default_ttl
+         */
+        void set_default_ttl(const ttl_type& _ttl) {
+            for (std::size_t indx=0;indx<_shardCount;indx++) {
+                lock_type guard(_shards[indx]);
+                _shards[indx].storage.set_default_ttl(_ttl);
+            }
+        }
+
+        /*!
+         * \brief Maximum cache size accessor
+         *
+         * \return The maximum number of elements a cache can have as its content, that is the sum of the shard capacities.
+         */
+        size_type max_size() const throw() {
+            return this->_maxEntries;
+        }
+
+        /*! \brief Counts entries in the cache.
+          *
+          *  Sums the shard sizes, locking shards one by one.
+          *
+          *  \return Number of object in the cache (size of cache)
+          */
+        size_type size() const {
+            size_type result=0;
+            for (std::size_t indx=0;indx<_shardCount;indx++) {
+                shared_lock_type guard(_shards[indx]);
+                result+=_shards[indx].storage.size();
+            }
+            return result;
+        }
+
+        /*! \brief Sums the weight of the entries in the cache.
+          *
+          *  \return Total weight of the cache content.
+          *
+          *  \see cache::weight
+          */
+        std::size_t weight() const {
+            std::size_t result=0;
+            for (std::size_t indx=0;indx<_shardCount;indx++) {
+                shared_lock_type guard(_shards[indx]);
+                result+=_shards[indx].storage.weight();
+            }
+            return result;
+        }
+
+        /*! \brief Statistics snapshot
+          *
+          *  Sums the counters of all the shards and of the loads. Counters are read without locking the shards, so the
+          *  sum may be slightly inconsistent, when other threads use the cache.
+          *
+          *  \return counters since the cache construction or the last reset
+          *
+          *  \see cache::stats
+          */
+        cache_stats stats() const {
+            cache_stats result;
+            for (std::size_t indx=0;indx<_shardCount;indx++) {
+                result+=_shards[indx].storage.stats();
+                result+=_flights[indx].stats.snapshot();
+            }
+            return result;
+        }
+
+        /*! \brief Resets the statistics counters of all the shards to zero
+          */
+        void reset_stats() {
+            for (std::size_t indx=0;indx<_shardCount;indx++) {
+                lock_type guard(_shards[indx]);
+                _shards[indx].storage.reset_stats();
+                _flights[indx].stats.reset();
+            }
+        }
+
+        /*! \brief Number of shards accessor
+          *
+          *  \return Number of independent shards, the keys are partitioned to.
+          */
+        std::size_t shards() const throw() {
+            return _shardCount;
+        }
+
+        /*!
+         * \brief Access cache data
+         *
+         * Looks up the key and touches it once. Data must be default constructible.
+         *
+         * \param <_k> key to the data
+         *
+         * \throw  <exception_invalid_key> Thrown when non-existent key is supplied.
+         *
+         * \return copy of the data, mapped by the key.
+         */
+        Data fetch(const Key& _k) {
+            Data result;
+            if (!this->try_get(_k,result)) {
+                throw exception_invalid_key("Key is not in cache",_k);
+            }
+            return result;
+        }
+
+        /*!
+         * \brief Access cache data without exceptions
+         *
+         * \param <_k> key to the data
+         * \param <_d> receives a copy of the data, when the key is found
+         *
+         * \return true if the key was found and false otherwise
+         *
+         * \see cache::try_get
+         */
+        bool try_get(const Key& _k, Data& _d) {
+            return shard(_k).read(_k,[&_d](const Data& _v) { _d=_v; });
+        }
+
+        /*!
+         * \brief Access cache data, loading it on a miss
+         *
+         * Read-through access with request coalescing. On a hit the value is returned like \link concurrent_cache::fetch fetch \endlink does.
+         * On a miss, only the first caller runs the _loader, while all the other threads, that are missing the same key at the same
+         * time, wait for it and share the loaded value. The loader runs without any cache lock held. Exceptions, thrown by the loader, are
+         * passed to every waiting caller and nothing is inserted, so the next call will try to load the key again.
+         *
+         * The loaded value is returned even when it can't be inserted into the cache. Data must be default constructible.
+         *
+         * \param <_k> key to the data
+         * \param <_loader> functor, that takes the key and returns a value for it
+         *
+         * \return copy of the data, mapped by the key.
+         *
+         * \see cache::get_or_load
+         */
+        template <class Loader>
+        Data get_or_load(const Key& _k, Loader _loader) {
+            Data result;
+            if (this->try_get(_k,result)) {
+                return result;
+            }
+
+            flight_type& flight=_flights[shard_index(_k)];
+            std::promise<Data> promise;
+            std::shared_future<Data> future;
+            bool leader=false;
+            {
+                std::lock_guard<std::mutex> guard(flight.lock);
+                typename std::unordered_map<Key,std::shared_future<Data>,Hash>::iterator it=flight.calls.find(_k);
+                if (it!=flight.calls.end()) {
+                    future=it->second;
+                } else {
+                    future=promise.get_future().share();
+                    flight.calls.insert(std::make_pair(_k,future));
+                    leader=true;
+                }
+            }
+            if (!leader) {
+                return future.get();
+            }
+
+            try {
+                //Previous load may have finished between the miss and the registration, the miss is counted already
+                if (!this->peek(_k,result)) {
+                    typename Stats::timer_type timer=flight.stats.load_started();
+                    try {
+                        result=_loader(_k);
+                    } catch (...) {
+                        flight.stats.load_finished(timer,false);
+                        throw;
+                    }
+                    flight.stats.load_finished(timer,true);
+                    try {
+                        this->insert(_k,result);
+                    } catch (...) {
+                    }
+                }
+                promise.set_value(result);
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+            {
+                std::lock_guard<std::mutex> guard(flight.lock);
+                flight.calls.erase(_k);
+            }
+            return future.get();
+        }
+
+        /*!
+         * \brief Access cache data without touching it
+         *
+         * \param <_k> key to the data
+         * \param <_d> receives a copy of the data, when the key is found
+         *
+         * \return true if the key was found and false otherwise
+         *
+         * \see cache::peek
+         */
+        bool peek(const Key& _k, Data& _d) const {
+            shard_type& s=shard(_k);
+            shared_lock_type guard(s);
+            const Data* data=s.storage.peek(_k);
+            if (!data) {
+                return false;
+            }
+            _d=*data;
+            return true;
+        }
+
+        /*!
+         * \brief Check for the key presence in cache
+         *
+         *  \param <_k> key to test
+         *
+         * \return true if key exists in the cache and false otherwise
+         *
+         * \see cache::check
+         */
+        bool check(const Key& _k) {
+            return shard(_k).read(_k,[](const Data&) { });
+        }
+
+        /*!
+         * \brief Increase usage count for entry
+         *
+         *  \param _k key to touch
+         */
+        void touch(const Key& _k) {
+            shard(_k).touch(_k);
+        }
+
+        concurrent_cache(const concurrent_cache<Key,Data,Policy,Container,Weigher,Hash,Concurrency,Allocator,Stats>& x) = delete;
+        concurrent_cache<Key,Data,Policy,Container,Weigher,Hash,Concurrency,Allocator,Stats>& operator= (const concurrent_cache<Key,Data,Policy,Container,Weigher,Hash,Concurrency,Allocator,Stats>& x) = delete;
+
+        /*!
+         * \brief Primary constructor.
+         *
+         * The number of shards is rounded down to a power of two and never exceeds the number of entries, so every shard could hold
+         * at least one entry. The entries and the weight are divided between the shards evenly.
+         *
+         * \param <size> Maximum number of entries, allowed in the cache.
+         * \param <shards> Number of shards. By default it is four times the number of hardware threads.
+         * \param <max_weight> Maximum total weight of the entries, allowed in the cache. Unlimited by default.
+         */
+        explicit concurrent_cache(const size_type size, std::size_t shards = 0, const std::size_t max_weight = std::numeric_limits<std::size_t>::max()) : _memory(nullptr), _shards(nullptr), _shardCount(1), _shardBits(0), _maxEntries(size), _hash(), _flights() {
+            if (shards==0) {
+                shards=default_shards();
+            }
+            while ((_shardCount<<1)<=shards && (_shardCount<<1)<=size) {
+                _shardCount<<=1;
+                _shardBits++;
+            }
+
+            _flights.reset(new flight_type[_shardCount]);
+            _memory=::operator new(_shardCount*sizeof(shard_type)+_cache_line_size);
+            std::uintptr_t aligned=(reinterpret_cast<std::uintptr_t>(_memory)+_cache_line_size-1)&~static_cast<std::uintptr_t>(_cache_line_size-1);
+            _shards=reinterpret_cast<shard_type*>(aligned);
+
+            std::size_t weight=max_weight==std::numeric_limits<std::size_t>::max() ? max_weight : max_weight/_shardCount;
+            std::size_t constructed=0;
+            try {
+                for (;constructed<_shardCount;constructed++) {
+                    std::size_t entries=size/_shardCount+(constructed<size%_shardCount ? 1 : 0);
+                    new (&_shards[constructed]) shard_type(entries,weight);
+                }
+            } catch (...) {
+                this->destroy(constructed);
+                throw;
+            }
+        }
+
+        ~concurrent_cache() {
+            this->destroy(_shardCount);
+        }
+    };
+}
+
+#endif /* STLCACHE_CONCURRENT_CACHE_HPP_INCLUDED */
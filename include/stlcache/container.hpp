@@ -8,13 +8,23 @@
 #ifndef STLCACHE_CONTAINER_HPP_INCLUDED
 #define STLCACHE_CONTAINER_HPP_INCLUDED
 
+#include <cstddef>
 #include <map>
+#include <type_traits>
 
 namespace stlcache {
     /*! \brief Abstract interface cache container.
      * 
      * Container class defines the internal container for caching.
      * 
+     * Every container binder provides a map_type and a static try_emplace(map_type&, key, args...) helper, that inserts a new element
+     * only when the key is missing and never touches the arguments otherwise. The cache relies on it to decide between insertion and
+     * update with a single lookup.
+     * 
+     * A binder may also provide a static reserve(map_type&, size) hook, that is called with the maximum number of entries, when the cache
+     * is constructed, and a stable_references constant, that is false, when the container relocates it's elements on insertion, like
+     * \link stlcache::container_flat_hash_map container_flat_hash_map \endlink does. Both are optional.
+     * 
      *     \tparam <Key> The cache's Key data type
      *     \tparam <Data> Type of data to be stored by the container.
      * 
@@ -23,9 +33,31 @@ namespace stlcache {
      *     \see stlcache::container_multimap
      *     \see stlcache::container_unordered_map
      *     \see stlcache::container_unordered_multimap
+     *     \see stlcache::container_flat_hash_map
      * 
      * \author chollya (5/19/2016)
      */
+
+    /*
+     * Whether references to the container elements survive insertions of other elements. True, unless the binder says otherwise.
+     */
+    template <class Binder, class Enable = void>
+    struct _container_stable_references : std::true_type {
+    };
+    template <class Binder>
+    struct _container_stable_references<Binder,typename std::enable_if<!Binder::stable_references>::type> : std::false_type {
+    };
+
+    /*
+     * Calls the reserve hook of the binder, if there is one.
+     */
+    template <class Binder>
+    auto _container_reserve(typename Binder::map_type& _m, std::size_t _size, int) -> decltype(Binder::reserve(_m,_size)) {
+        return Binder::reserve(_m,_size);
+    }
+    template <class Binder>
+    void _container_reserve(typename Binder::map_type&, std::size_t, long) {
+    }
 }
 
 #endif /* STLCACHE_CONTAINER_HPP_INCLUDED */
@@ -0,0 +1,608 @@
+//
+// Copyright (C) 2016 Sebastien Besombes
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_CONTAINER_FLAT_HASH_MAP_HPP_INCLUDED
+#define STLCACHE_CONTAINER_FLAT_HASH_MAP_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STLCACHE_FLAT_HASH_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <stlcache/bits.hpp>
+
+namespace stlcache {
+
+	/*
+	 * Control bytes of the flat hash map. A full slot keeps the 7 high bits of it's hash, free slots have the high bit set,
+	 * so the 16 slots of a group are filtered by a single comparison and keys are compared only for the matching slots.
+	 */
+	typedef signed char _ctrl_type;
+	const _ctrl_type _ctrl_empty = -128;
+	const _ctrl_type _ctrl_deleted = -2;
+
+	/*
+	 * A window of 16 control bytes, starting at any slot. Every match returns a bitmask, where the bit N stands for the slot N of the window.
+	 */
+	class _ctrl_group {
+	public:
+		static const std::size_t width = 16;
+	private:
+#ifdef STLCACHE_FLAT_HASH_MAP_SSE2
+		__m128i _ctrl;
+	public:
+		explicit _ctrl_group(const _ctrl_type* _p) throw() : _ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_p))) { }
+
+		std::uint32_t match(_ctrl_type _h) const throw() {
+			return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(_h),_ctrl)));
+		}
+		std::uint32_t match_free() const throw() {
+			return static_cast<std::uint32_t>(_mm_movemask_epi8(_ctrl));
+		}
+#else
+		const _ctrl_type* _ctrl;
+	public:
+		explicit _ctrl_group(const _ctrl_type* _p) throw() : _ctrl(_p) { }
+
+		std::uint32_t match(_ctrl_type _h) const throw() {
+			std::uint32_t result=0;
+			for (std::size_t indx=0;indx<width;indx++) {
+				result|=static_cast<std::uint32_t>(_ctrl[indx]==_h)<<indx;
+			}
+			return result;
+		}
+		std::uint32_t match_free() const throw() {
+			std::uint32_t result=0;
+			for (std::size_t indx=0;indx<width;indx++) {
+				result|=static_cast<std::uint32_t>(_ctrl[indx]<0)<<indx;
+			}
+			return result;
+		}
+#endif
+		std::uint32_t match_empty() const throw() {
+			return this->match(_ctrl_empty);
+		}
+	};
+
+	/*
+	 * Open addressing hash map with the SwissTable layout: a flat array of slots and a parallel array of control bytes.
+	 *
+	 * The capacity is a power of two and the first 15 control bytes are mirrored after the last one, so a group could be loaded
+	 * at any slot without wrapping. Groups are probed with triangular steps, which visit every group of the table. Erased slots
+	 * become empty, when no probe window could have seen them full, and tombstones otherwise. When the empty slots are exhausted,
+	 * the tombstones are dropped in place, if the table is sparse enough, and the table grows otherwise. Elements are relocated
+	 * by move on rehash, so references are stable between rehashes only.
+	 */
+	template <class Key, class Data, class Hash = std::hash<Key>, class Pred = std::equal_to<Key>, class Allocator = std::allocator<std::pair<const Key,Data> > >
+	class _flat_hash_map {
+	public:
+		using key_type = Key ;
+		using mapped_type = Data ;
+		using value_type = std::pair<const Key, Data> ;
+		using size_type = std::size_t ;
+		using difference_type = std::ptrdiff_t ;
+		using hasher = Hash ;
+		using key_equal = Pred ;
+		using allocator_type = Allocator ;
+		using reference = value_type& ;
+		using const_reference = const value_type& ;
+		using pointer = value_type* ;
+		using const_pointer = const value_type* ;
+
+		template <class Value>
+		class basic_iterator {
+			friend class _flat_hash_map<Key,Data,Hash,Pred,Allocator>;
+			template <class Other> friend class basic_iterator;
+
+			const _ctrl_type* _ctrl;
+			const _ctrl_type* _last;
+			Value* _slot;
+
+			basic_iterator(const _ctrl_type* _c, const _ctrl_type* _l, Value* _s) throw() : _ctrl(_c), _last(_l), _slot(_s) {
+				this->skip();
+			}
+			void skip() throw() {
+				while (_ctrl!=_last && *_ctrl<0) {
+					++_ctrl;
+					++_slot;
+				}
+			}
+		public:
+			using iterator_category = std::forward_iterator_tag ;
+			using value_type = typename std::remove_const<Value>::type ;
+			using difference_type = std::ptrdiff_t ;
+			using pointer = Value* ;
+			using reference = Value& ;
+
+			basic_iterator() throw() : _ctrl(nullptr), _last(nullptr), _slot(nullptr) { }
+			template <class Other, class = typename std::enable_if<std::is_convertible<Other*,Value*>::value>::type>
+			basic_iterator(const basic_iterator<Other>& x) throw() : _ctrl(x._ctrl), _last(x._last), _slot(x._slot) { }
+
+			reference operator*() const throw() {
+				return *_slot;
+			}
+			pointer operator->() const throw() {
+				return _slot;
+			}
+			basic_iterator<Value>& operator++() throw() {
+				++_ctrl;
+				++_slot;
+				this->skip();
+				return *this;
+			}
+			basic_iterator<Value> operator++(int) throw() {
+				basic_iterator<Value> result(*this);
+				++(*this);
+				return result;
+			}
+			bool operator==(const basic_iterator<Value>& x) const throw() {
+				return _ctrl==x._ctrl;
+			}
+			bool operator!=(const basic_iterator<Value>& x) const throw() {
+				return _ctrl!=x._ctrl;
+			}
+		};
+
+		using iterator = basic_iterator<value_type> ;
+		using const_iterator = basic_iterator<const value_type> ;
+	private:
+		using alloc_traits = std::allocator_traits<Allocator> ;
+		using ctrl_allocator = typename alloc_traits::template rebind_alloc<_ctrl_type> ;
+		using ctrl_traits = std::allocator_traits<ctrl_allocator> ;
+
+		static const size_type _width = _ctrl_group::width;
+
+		Hash _hash;
+		Pred _equal;
+		Allocator _allocator;
+		_ctrl_type* _ctrl;
+		value_type* _slots;
+		size_type _capacity;
+		size_type _size;
+		size_type _growthLeft;
+
+		/*
+		 * std::hash is the identity for integers, so the hash is mixed before it is split into the position and the control byte.
+		 */
+		size_type hash(const Key& _k) const {
+			std::uint64_t h=static_cast<std::uint64_t>(_hash(_k))*UINT64_C(0x9E3779B97F4A7C15);
+			return static_cast<size_type>(h^(h>>32));
+		}
+		static _ctrl_type fingerprint(size_type _h) throw() {
+			return static_cast<_ctrl_type>(_h>>(std::numeric_limits<size_type>::digits-7));
+		}
+		static size_type growth(size_type _capacity) throw() {
+			return _capacity-_capacity/8;
+		}
+
+		void set_ctrl(size_type _indx, _ctrl_type _c) throw() {
+			_ctrl[_indx]=_c;
+			if (_indx<_width-1) {
+				_ctrl[_capacity+_indx]=_c;
+			}
+		}
+
+		template <class K>
+		size_type find_index(const K& _k, size_type _h) const {
+			if (!_capacity) {
+				return _capacity;
+			}
+			size_type mask=_capacity-1;
+			size_type pos=_h&mask;
+			_ctrl_type fp=fingerprint(_h);
+			for (size_type step=_width;;step+=_width) {
+				_ctrl_group group(_ctrl+pos);
+				for (std::uint32_t match=group.match(fp);match;match&=match-1) {
+					size_type indx=(pos+_bit_low(match))&mask;
+					if (_equal(_slots[indx].first,_k)) {
+						return indx;
+					}
+				}
+				if (group.match_empty()) {
+					return _capacity;
+				}
+				pos=(pos+step)&mask;
+			}
+		}
+		size_type find_free(size_type _h) const throw() {
+			size_type mask=_capacity-1;
+			size_type pos=_h&mask;
+			for (size_type step=_width;;step+=_width) {
+				std::uint32_t match=_ctrl_group(_ctrl+pos).match_free();
+				if (match) {
+					return (pos+_bit_low(match))&mask;
+				}
+				pos=(pos+step)&mask;
+			}
+		}
+
+		/*
+		 * Returns a free slot for the new element with the hash _h, growing the table or dropping the tombstones when needed.
+		 */
+		size_type prepare_insert(size_type _h) {
+			if (_capacity) {
+				size_type indx=this->find_free(_h);
+				if (_growthLeft || _ctrl[indx]==_ctrl_deleted) {
+					return indx;
+				}
+			}
+			if (!_capacity) {
+				this->resize(_width);
+			} else if (_size*32<=_capacity*25) {
+				this->drop_deleted();
+			} else {
+				this->resize(_capacity*2);
+			}
+			return this->find_free(_h);
+		}
+		void commit_insert(size_type _indx, size_type _h) throw() {
+			if (_ctrl[_indx]==_ctrl_empty) {
+				_growthLeft--;
+			}
+			this->set_ctrl(_indx,fingerprint(_h));
+			_size++;
+		}
+
+		void allocate(size_type _capacity) {
+			ctrl_allocator ctrlAllocator(_allocator);
+			_ctrl=ctrl_traits::allocate(ctrlAllocator,_capacity+_width-1);
+			try {
+				_slots=alloc_traits::allocate(_allocator,_capacity);
+			} catch (...) {
+				ctrl_traits::deallocate(ctrlAllocator,_ctrl,_capacity+_width-1);
+				throw;
+			}
+			for (size_type indx=0;indx<_capacity+_width-1;indx++) {
+				_ctrl[indx]=_ctrl_empty;
+			}
+		}
+		void deallocate() throw() {
+			if (!_capacity) {
+				return;
+			}
+			ctrl_allocator ctrlAllocator(_allocator);
+			ctrl_traits::deallocate(ctrlAllocator,_ctrl,_capacity+_width-1);
+			alloc_traits::deallocate(_allocator,_slots,_capacity);
+		}
+		void destroy() throw() {
+			for (size_type indx=0;indx<_capacity && _size;indx++) {
+				if (_ctrl[indx]>=0) {
+					alloc_traits::destroy(_allocator,_slots+indx);
+					_size--;
+				}
+			}
+		}
+
+		void resize(size_type _newCapacity) {
+			_ctrl_type* oldCtrl=_ctrl;
+			value_type* oldSlots=_slots;
+			size_type oldCapacity=_capacity;
+
+			this->allocate(_newCapacity);
+			_capacity=_newCapacity;
+			_growthLeft=growth(_capacity)-_size;
+
+			for (size_type indx=0;indx<oldCapacity;indx++) {
+				if (oldCtrl[indx]<0) {
+					continue;
+				}
+				size_type h=this->hash(oldSlots[indx].first);
+				size_type pos=this->find_free(h);
+				alloc_traits::construct(_allocator,_slots+pos,std::move(const_cast<Key&>(oldSlots[indx].first)),std::move(oldSlots[indx].second));
+				this->set_ctrl(pos,fingerprint(h));
+				alloc_traits::destroy(_allocator,oldSlots+indx);
+			}
+
+			if (oldCapacity) {
+				ctrl_allocator ctrlAllocator(_allocator);
+				ctrl_traits::deallocate(ctrlAllocator,oldCtrl,oldCapacity+_width-1);
+				alloc_traits::deallocate(_allocator,oldSlots,oldCapacity);
+			}
+		}
+
+		/*
+		 * Position of the slot _indx in the probe sequence of the hash _h, counted in groups.
+		 */
+		size_type probe_group(size_type _indx, size_type _h) const throw() {
+			return ((_indx-(_h&(_capacity-1)))&(_capacity-1))/_width;
+		}
+
+		/*
+		 * Rehashes the table in place, turning all the tombstones into the empty slots without allocating. Full slots are
+		 * marked as deleted first and then every element is moved to the first free slot of it's probe sequence, swapping
+		 * with the elements, that are not placed yet.
+		 */
+		void drop_deleted() {
+			for (size_type indx=0;indx<_capacity;indx++) {
+				_ctrl[indx]=_ctrl[indx]==_ctrl_deleted || _ctrl[indx]==_ctrl_empty ? _ctrl_empty : _ctrl_deleted;
+			}
+			for (size_type indx=0;indx<_width-1;indx++) {
+				_ctrl[_capacity+indx]=_ctrl[indx];
+			}
+
+			for (size_type indx=0;indx<_capacity;indx++) {
+				if (_ctrl[indx]!=_ctrl_deleted) {
+					continue;
+				}
+				size_type h=this->hash(_slots[indx].first);
+				size_type target=this->find_free(h);
+				if (this->probe_group(target,h)==this->probe_group(indx,h)) {
+					this->set_ctrl(indx,fingerprint(h));
+					continue;
+				}
+				if (_ctrl[target]==_ctrl_empty) {
+					alloc_traits::construct(_allocator,_slots+target,std::move(const_cast<Key&>(_slots[indx].first)),std::move(_slots[indx].second));
+					alloc_traits::destroy(_allocator,_slots+indx);
+					this->set_ctrl(target,fingerprint(h));
+					this->set_ctrl(indx,_ctrl_empty);
+				} else {
+					value_type moved(std::move(const_cast<Key&>(_slots[target].first)),std::move(_slots[target].second));
+					alloc_traits::destroy(_allocator,_slots+target);
+					alloc_traits::construct(_allocator,_slots+target,std::move(const_cast<Key&>(_slots[indx].first)),std::move(_slots[indx].second));
+					alloc_traits::destroy(_allocator,_slots+indx);
+					alloc_traits::construct(_allocator,_slots+indx,std::move(const_cast<Key&>(moved.first)),std::move(moved.second));
+					this->set_ctrl(target,fingerprint(h));
+					indx--; //The swapped in element isn't placed yet
+				}
+			}
+			_growthLeft=growth(_capacity)-_size;
+		}
+
+		void erase_index(size_type _indx) throw() {
+			alloc_traits::destroy(_allocator,_slots+_indx);
+			_size--;
+
+			std::uint32_t emptyAfter=_ctrl_group(_ctrl+_indx).match_empty();
+			std::uint32_t emptyBefore=_ctrl_group(_ctrl+((_indx-_width)&(_capacity-1))).match_empty();
+			if (emptyAfter && emptyBefore && _bit_low(emptyAfter)+(_width-1-_bit_high(emptyBefore))<_width) {
+				this->set_ctrl(_indx,_ctrl_empty);
+				_growthLeft++;
+			} else {
+				this->set_ctrl(_indx,_ctrl_deleted);
+			}
+		}
+
+		iterator make_iterator(size_type _indx) throw() {
+			return iterator(_ctrl+_indx,_ctrl+_capacity,_slots+_indx);
+		}
+		const_iterator make_iterator(size_type _indx) const throw() {
+			return const_iterator(_ctrl+_indx,_ctrl+_capacity,_slots+_indx);
+		}
+	public:
+		_flat_hash_map() : _hash(), _equal(), _allocator(), _ctrl(nullptr), _slots(nullptr), _capacity(0), _size(0), _growthLeft(0) { }
+		explicit _flat_hash_map(size_type _n, const Hash& _h = Hash(), const Pred& _eq = Pred(), const Allocator& _a = Allocator()) : _hash(_h), _equal(_eq), _allocator(_a), _ctrl(nullptr), _slots(nullptr), _capacity(0), _size(0), _growthLeft(0) {
+			this->reserve(_n);
+		}
+		_flat_hash_map(const _flat_hash_map<Key,Data,Hash,Pred,Allocator>& x) : _hash(x._hash), _equal(x._equal), _allocator(alloc_traits::select_on_container_copy_construction(x._allocator)), _ctrl(nullptr), _slots(nullptr), _capacity(0), _size(0), _growthLeft(0) {
+			this->reserve(x._size);
+			try {
+				for (const_iterator it=x.begin();it!=x.end();++it) {
+					size_type h=this->hash(it->first);
+					size_type indx=this->find_free(h);
+					alloc_traits::construct(_allocator,_slots+indx,*it);
+					this->commit_insert(indx,h);
+				}
+			} catch (...) {
+				this->destroy();
+				this->deallocate();
+				throw;
+			}
+		}
+		_flat_hash_map(_flat_hash_map<Key,Data,Hash,Pred,Allocator>&& x) throw() : _hash(x._hash), _equal(x._equal), _allocator(x._allocator), _ctrl(x._ctrl), _slots(x._slots), _capacity(x._capacity), _size(x._size), _growthLeft(x._growthLeft) {
+			x._ctrl=nullptr;
+			x._slots=nullptr;
+			x._capacity=0;
+			x._size=0;
+			x._growthLeft=0;
+		}
+		_flat_hash_map<Key,Data,Hash,Pred,Allocator>& operator=(const _flat_hash_map<Key,Data,Hash,Pred,Allocator>& x) {
+			if (this!=&x) {
+				_flat_hash_map<Key,Data,Hash,Pred,Allocator> tmp(x);
+				this->swap(tmp);
+			}
+			return *this;
+		}
+		_flat_hash_map<Key,Data,Hash,Pred,Allocator>& operator=(_flat_hash_map<Key,Data,Hash,Pred,Allocator>&& x) throw() {
+			this->swap(x);
+			return *this;
+		}
+		~_flat_hash_map() {
+			this->destroy();
+			this->deallocate();
+		}
+
+		allocator_type get_allocator() const throw() {
+			return _allocator;
+		}
+		hasher hash_function() const {
+			return _hash;
+		}
+		key_equal key_eq() const {
+			return _equal;
+		}
+
+		iterator begin() throw() {
+			return this->make_iterator(0);
+		}
+		const_iterator begin() const throw() {
+			return this->make_iterator(0);
+		}
+		iterator end() throw() {
+			return this->make_iterator(_capacity);
+		}
+		const_iterator end() const throw() {
+			return this->make_iterator(_capacity);
+		}
+
+		bool empty() const throw() {
+			return _size==0;
+		}
+		size_type size() const throw() {
+			return _size;
+		}
+		size_type max_size() const throw() {
+			return alloc_traits::max_size(_allocator)/8*7;
+		}
+		size_type capacity() const throw() {
+			return _capacity;
+		}
+
+		/*
+		 * Makes room for _n elements, so they are inserted without a rehash to a larger table. The table is kept sparse enough,
+		 * that the tombstones of the erased elements are always dropped in place, so a table, that never holds more than _n
+		 * elements, never allocates again.
+		 */
+		void reserve(size_type _n) {
+			if (_n*32<=_capacity*25) {
+				return;
+			}
+			size_type capacity=_width;
+			while (capacity*25<_n*32) {
+				capacity*=2;
+			}
+			this->resize(capacity);
+		}
+
+		/*
+		 * Destroys all the elements, but keeps the memory.
+		 */
+		void clear() throw() {
+			this->destroy();
+			for (size_type indx=0;_capacity && indx<_capacity+_width-1;indx++) {
+				_ctrl[indx]=_ctrl_empty;
+			}
+			_growthLeft=growth(_capacity);
+		}
+		void swap(_flat_hash_map<Key,Data,Hash,Pred,Allocator>& x) throw() {
+			std::swap(_hash,x._hash);
+			std::swap(_equal,x._equal);
+			std::swap(_allocator,x._allocator);
+			std::swap(_ctrl,x._ctrl);
+			std::swap(_slots,x._slots);
+			std::swap(_capacity,x._capacity);
+			std::swap(_size,x._size);
+			std::swap(_growthLeft,x._growthLeft);
+		}
+
+		iterator find(const key_type& _k) {
+			return this->make_iterator(this->find_index(_k,this->hash(_k)));
+		}
+		const_iterator find(const key_type& _k) const {
+			return this->make_iterator(this->find_index(_k,this->hash(_k)));
+		}
+		size_type count(const key_type& _k) const {
+			return this->find_index(_k,this->hash(_k))<_capacity ? 1 : 0;
+		}
+
+		template <class K, class... Args>
+		std::pair<iterator,bool> try_emplace(K&& _k, Args&&... args) {
+			size_type h=this->hash(_k);
+			size_type indx=this->find_index(_k,h);
+			if (indx<_capacity) {
+				return std::make_pair(this->make_iterator(indx),false);
+			}
+			indx=this->prepare_insert(h);
+			alloc_traits::construct(_allocator,_slots+indx,std::piecewise_construct,std::forward_as_tuple(std::forward<K>(_k)),std::forward_as_tuple(std::forward<Args>(args)...));
+			this->commit_insert(indx,h);
+			return std::make_pair(this->make_iterator(indx),true);
+		}
+		template <class... Args>
+		std::pair<iterator,bool> emplace(Args&&... args) {
+			value_type value(std::forward<Args>(args)...);
+			size_type h=this->hash(value.first);
+			size_type indx=this->find_index(value.first,h);
+			if (indx<_capacity) {
+				return std::make_pair(this->make_iterator(indx),false);
+			}
+			indx=this->prepare_insert(h);
+			alloc_traits::construct(_allocator,_slots+indx,std::move(value));
+			this->commit_insert(indx,h);
+			return std::make_pair(this->make_iterator(indx),true);
+		}
+		std::pair<iterator,bool> insert(const value_type& _v) {
+			return this->try_emplace(_v.first,_v.second);
+		}
+
+		/*
+		 * Erasure never relocates the other elements, so iterators to them stay valid.
+		 */
+		iterator erase(const_iterator _pos) throw() {
+			size_type indx=static_cast<size_type>(_pos._slot-_slots);
+			this->erase_index(indx);
+			return this->make_iterator(indx+1);
+		}
+		iterator erase(iterator _pos) throw() {
+			return this->erase(const_iterator(_pos));
+		}
+		size_type erase(const key_type& _k) {
+			size_type indx=this->find_index(_k,this->hash(_k));
+			if (indx>=_capacity) {
+				return 0;
+			}
+			this->erase_index(indx);
+			return 1;
+		}
+	};
+
+	template <class Key, class Data>
+	struct _container_flat_hash_map_type {
+		using compare_type = std::hash<Key> ;
+		using predicate_type = std::equal_to<Key> ;
+
+		template <class T>
+		using allocator_type = std::allocator<T> ;
+
+		using map_type = _flat_hash_map<Key, Data, compare_type, predicate_type, allocator_type<std::pair<const Key, Data>> > ;
+
+		static const bool stable_references = false;
+
+		template <class K, class... Args>
+		static std::pair<typename map_type::iterator,bool> try_emplace(map_type& m, K&& k, Args&&... args) {
+			return m.try_emplace(std::forward<K>(k),std::forward<Args>(args)...);
+		}
+
+		/*
+		 * The new entry is emplaced before the victim is removed, so the full cache briefly holds one entry more.
+		 */
+		static void reserve(map_type& m, std::size_t n) {
+			m.reserve(n+1);
+		}
+	};
+
+	/*!
+	 * \brief Open addressing hash table container
+	 *
+	 * Keeps the entries in a single flat array, probed by groups of 16 control bytes, so a lookup usually touches one or two
+	 * cache lines and an insertion doesn't allocate. The table is sized for the maximum number of entries and the one, that is
+	 * inserted before the victim is removed, when the cache is constructed, unless the cache is limited by the weight only.
+	 * The tombstones of the removed entries are dropped in place, so a full cache never allocates under churn.
+	 *
+	 * Elements are relocated, when the table grows, so it can't be used with the \link stlcache::intrusive_cache intrusive_cache \endlink.
+	 *
+	 * \code
+	 *     cache<int,string,policy_lru,container_flat_hash_map> c(100000);
+	 * \endcode
+	 */
+	struct container_flat_hash_map {
+		template <class Key, class Data>
+		struct bind : _container_flat_hash_map_type<Key,Data> {
+		} ;
+	};
+
+}
+
+#endif /* STLCACHE_CONTAINER_FLAT_HASH_MAP_HPP_INCLUDED */
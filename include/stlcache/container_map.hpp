@@ -8,22 +8,49 @@
 #ifndef STLCACHE_CONTAINER_MAP_HPP_INCLUDED
 #define STLCACHE_CONTAINER_MAP_HPP_INCLUDED
 
+#include <cstddef>
+#include <map>
+#include <tuple>
+#include <utility>
+
+#include <stlcache/allocator.hpp>
+
 namespace stlcache {
 
-	template <class Key, class Data>
+	template <class Key, class Data, class Allocator = allocator_std>
 	struct _container_map_type {
 		using compare_type = std::less<Key> ;
 
 		template <class T>
-		using allocator_type = std::allocator<T> ;
+		using allocator_type = typename Allocator::template bind<T> ;
 
 		using map_type = std::map<Key, Data, compare_type, allocator_type<std::pair<const Key, Data>> > ;
+
+		/*
+		 * Lets the node pools grow up to the cache size.
+		 */
+		static void reserve(map_type& m, std::size_t n) {
+			_allocator_reserve(m.get_allocator(),n,0);
+		}
+
+		template <class K, class... Args>
+		static std::pair<typename map_type::iterator,bool> try_emplace(map_type& m, K&& k, Args&&... args) {
+			typename map_type::iterator it=m.lower_bound(k);
+			if (it!=m.end() && !m.key_comp()(k,it->first)) {
+				return std::make_pair(it,false);
+			}
+			it=m.emplace_hint(it,std::piecewise_construct,std::forward_as_tuple(std::forward<K>(k)),std::forward_as_tuple(std::forward<Args>(args)...));
+			return std::make_pair(it,true);
+		}
 	};
 
     struct container_map {
 		template <class Key, class Data>
 		struct bind : _container_map_type<Key,Data> {
 		} ;
+		template <class Key, class Data, class Allocator>
+		struct allocator_bind : _container_map_type<Key,Data,Allocator> {
+		} ;
     };
 
 }
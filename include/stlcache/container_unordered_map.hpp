@@ -8,23 +8,53 @@
 #ifndef STLCACHE_CONTAINER_UNORDERED_MAP_HPP_INCLUDED
 #define STLCACHE_CONTAINER_UNORDERED_MAP_HPP_INCLUDED
 
+#include <cstddef>
+#include <unordered_map>
+#include <tuple>
+#include <utility>
+
+#include <stlcache/allocator.hpp>
+
 namespace stlcache {
 
-	template <class Key, class Data>
+	template <class Key, class Data, class Allocator = allocator_std>
 	struct _container_unordered_map_type {
 		using compare_type = std::hash<Key> ;
 		using predicate_type =  std::equal_to<Key> ;
 
 		template <class T>
-		using allocator_type = std::allocator<T> ;
+		using allocator_type = typename Allocator::template bind<T> ;
 
 		using map_type = std::unordered_map<Key, Data, compare_type, predicate_type, allocator_type<std::pair<const Key, Data>> > ;
+
+		/*
+		 * Lets the node pools grow up to the cache size.
+		 */
+		static void reserve(map_type& m, std::size_t n) {
+			_allocator_reserve(m.get_allocator(),n,0);
+		}
+
+		template <class K, class... Args>
+		static std::pair<typename map_type::iterator,bool> try_emplace(map_type& m, K&& k, Args&&... args) {
+#if __cplusplus >= 201703L
+			return m.try_emplace(std::forward<K>(k),std::forward<Args>(args)...);
+#else
+			typename map_type::iterator it=m.find(k);
+			if (it!=m.end()) {
+				return std::make_pair(it,false);
+			}
+			return m.emplace(std::piecewise_construct,std::forward_as_tuple(std::forward<K>(k)),std::forward_as_tuple(std::forward<Args>(args)...));
+#endif
+		}
 	};
 
 	struct container_unordered_map {
 		template <class Key, class Data>
 		struct bind : _container_unordered_map_type<Key,Data> {
 		} ;
+		template <class Key, class Data, class Allocator>
+		struct allocator_bind : _container_unordered_map_type<Key,Data,Allocator> {
+		} ;
 	};
 
 }
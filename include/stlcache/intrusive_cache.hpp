@@ -0,0 +1,354 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_INTRUSIVE_CACHE_HPP_INCLUDED
+#define STLCACHE_INTRUSIVE_CACHE_HPP_INCLUDED
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4290 )
+#endif /* _MSC_VER */
+
+#include <tuple>
+#include <utility>
+
+#include <stlcache/exceptions.hpp>
+#include <stlcache/container.hpp>
+
+namespace stlcache {
+    /*!
+     * \brief Storage node payload of the intrusive_cache
+     *
+     * Keeps the cached value together with the policy hook, so the key, the value and the policy links share a single
+     * storage node.
+     *
+     * \tparam <Data> The value data type.
+     * \tparam <Hook> The hook type of the intrusive policy.
+     */
+    template <class Data, class Hook>
+    struct _intrusive_entry {
+        Data data;
+        Hook hook;
+
+        template <class... Args>
+        explicit _intrusive_entry(Args&&... args) : data(std::forward<Args>(args)...), hook() { }
+    };
+
+    /*! \brief Cache that keeps the policy bookkeeping inside the storage nodes.
+     *
+     * The intrusive_cache behaves like a \link stlcache::cache cache \endlink, but instead of keeping a separate copy of every key in the policy
+     * structures, it embeds the policy links (a list hook for LRU/MRU, a bucket hook for LFU) into the storage node, next to the key and the value.
+     * So every entry is a single allocation and a \link intrusive_cache::fetch fetch \endlink is one storage lookup followed by a pointer relink.
+     *
+     * \code
+     *     intrusive_cache<string,string,policy_lru> cache_lru(3);
+     *     cache_lru.insert("key","value");
+     *     if (cache_lru.check("key")) {
+     *         cout<<"We have some value in the cache: "<<cache_lru.fetch("key");
+     *     }
+     * \endcode
+     *
+     * Only policies that provide an intrusive_bind are supported: \link stlcache::policy_lru LRU \endlink, \link stlcache::policy_mru MRU \endlink
+     * and \link stlcache::policy_lfu LFU \endlink. Because the hooks are pointing to the storage nodes, the intrusive_cache could be moved and swapped,
+     * but not copied.
+     *
+     * \tparam <Key> The key data type.
+     * \tparam <Data> The value data type.
+     * \tparam <Policy> The expiration policy type. Must provide an intrusive_bind.
+     * \tparam <Container> A specialiser for internal container. Must be node based, as hooks rely on stable node addresses.
+     *
+     * \see cache
+     */
+    template<
+        class Key,
+        class Data,
+        class Policy,
+        class Container = container_unordered_map
+    >
+    class intrusive_cache {
+        using policy_type = typename Policy::template intrusive_bind<Key> ;
+        using hook_type = typename policy_type::hook_type ;
+        using entry_type = _intrusive_entry<Data,hook_type> ;
+        using container_type = typename Container::template bind<Key,entry_type> ;
+        using storage_type = typename container_type::map_type ;
+        using storage_iterator = typename storage_type::iterator ;
+
+        static_assert(_container_stable_references<container_type>::value,"intrusive_cache requires a node based container");
+
+        storage_type _storage;
+        std::size_t _maxEntries;
+        policy_type _policy;
+
+        void evict(hook_type* _h) throw() {
+            storage_iterator it=_storage.find(*_h->key);
+            _policy.remove(it->second.hook);
+            _storage.erase(it);
+        }
+        void admit(storage_iterator _it) {
+            try {
+                while (_storage.size() > _maxEntries) {
+                    hook_type* victim=_policy.victim();
+                    if (!victim) {
+                        throw exception_cache_full("The cache is full and no element can be expired at the moment. Remove some elements manually");
+                    }
+                    this->evict(victim);
+                }
+                _policy.insert(_it->second.hook,_it->first);
+            } catch (...) {
+                _storage.erase(_it);
+                throw;
+            }
+        }
+    public:
+        /*! \brief The Key type
+         */
+        using key_type = Key ;
+        /*!  \brief The Data type
+         */
+        using mapped_type = Data ;
+        /*! \brief Type used for storing object sizes, specific to a current platform (usually a size_t)
+          */
+        using size_type = typename storage_type::size_type ;
+
+        /*! \brief Counts entries with specified key in the cache.
+          *
+          *  Same as \link cache::count cache::count \endlink, doesn't touch the entry.
+          *
+          *  \param <x> key to count
+          *
+          *  \return 1 if object is on the cache and 0 for non-existent object
+          */
+        size_type count ( const key_type& x ) const throw() {
+            return _storage.count(x);
+        }
+
+        /*! \brief Test whether cache is empty
+          *
+          *   \return true if the container size is 0, false otherwise.
+          */
+        bool empty() const throw() {
+            return _storage.empty();
+        }
+
+        /*!
+         * \brief Clear the cache
+         *
+         * Removes all cache entries, drops all usage count data and so on.
+         */
+        void clear() throw() {
+            _policy.clear();
+            _storage.clear();
+        }
+
+        /*!
+         * \brief Swaps contents of two caches
+         *
+         * Exchanges the content of the cache with the content of mp. Nodes are not relocated, so the hooks stay valid.
+         *
+         * \param <mp> Another intrusive_cache of the same type.
+         */
+        void swap ( intrusive_cache<Key,Data,Policy,Container>& mp ) throw() {
+            _storage.swap(mp._storage);
+            _policy.swap(mp._policy);
+            std::swap(_maxEntries,mp._maxEntries);
+        }
+
+        /*!
+         * \brief Removes a entry from cache
+         *
+         * \param <x> Key to remove.
+         *
+         * \return 1 when entry is removed or zero when nothing was done.
+         */
+        size_type erase ( const key_type& x ) throw() {
+            storage_iterator it=_storage.find(x);
+            if (it==_storage.end()) {
+                return 0;
+            }
+            _policy.remove(it->second.hook);
+            _storage.erase(it);
+            return 1;
+        }
+
+        /*!
+         * \brief Insert element to the cache
+         *
+         * Works like \link cache::insert cache::insert \endlink: existing entries are not updated, excessive entries are expired by the policy.
+         *
+         * \throw <exception_cache_full>  Thrown when there are no available space in the cache and policy doesn't allows removal of elements.
+         *
+         * \return true if the new elemented was inserted or false if an element with the same key existed.
+         */
+        bool insert(Key _k, Data _d) throw(exception_cache_full) {
+            return this->try_emplace(std::move(_k),std::move(_d));
+        }
+
+        /*!
+         * \brief Construct element in place if the key doesn't exist
+         *
+         * \param <_k> key of the entry
+         * \param <args> arguments to forward to the Data constructor
+         *
+         * \return true if the new elemented was inserted or false if an element with the same key existed.
+         *
+         * \see cache::try_emplace
+         */
+        template <class K, class... Args>
+        bool try_emplace(K&& _k, Args&&... args) {
+            std::pair<storage_iterator,bool> result=container_type::try_emplace(_storage,std::forward<K>(_k),std::forward<Args>(args)...);
+            if (result.second) {
+                this->admit(result.first);
+            }
+            return result.second;
+        }
+
+        /*!
+         * \brief Insert element or update the existing one
+         *
+         * \param <_k> key of the entry
+         * \param <_d> new value of the entry
+         *
+         * \return true if the new elemented was inserted or false if the existing entry was updated.
+         *
+         * \see cache::insert_or_assign
+         */
+        template <class K, class M>
+        bool insert_or_assign(K&& _k, M&& _d) {
+            std::pair<storage_iterator,bool> result=container_type::try_emplace(_storage,std::forward<K>(_k),std::forward<M>(_d));
+            if (result.second) {
+                this->admit(result.first);
+            } else {
+                result.first->second.data=std::forward<M>(_d);
+                _policy.touch(result.first->second.hook);
+            }
+            return result.second;
+        }
+
+        /*!
+         * \brief Maximum cache size accessor
+         *
+         * \return The maximum number of elements a cache can have as its content.
+         */
+        size_type max_size() const throw() {
+            return this->_maxEntries;
+        }
+
+        /*! \brief Counts entries in the cache.
+          *
+          *  \return Number of object in the cache (size of cache)
+          */
+        size_type size() const throw() {
+            return _storage.size();
+        }
+
+        /*!
+         * \brief Access cache data
+         *
+         * Looks up the entry once and touches it's hook in place.
+         *
+         * \param <_k> key to the data
+         *
+         * \throw  <exception_invalid_key> Thrown when non-existent key is supplied.
+         *
+         * \return constant reference to the data, mapped by the key.
+         */
+        const Data& fetch(const Key& _k) throw(exception_invalid_key) {
+            const Data* data=try_get(_k);
+            if (!data) {
+                throw exception_invalid_key("Key is not in cache",_k);
+            }
+            return *data;
+        }
+
+        /*!
+         * \brief Access cache data without exceptions
+         *
+         * \param <_k> key to the data
+         *
+         * \return pointer to the data, mapped by the key, or nullptr when the key is not in the cache
+         *
+         * \see cache::try_get
+         */
+        const Data* try_get(const Key& _k) throw() {
+            storage_iterator it=_storage.find(_k);
+            if (it==_storage.end()) {
+                return nullptr;
+            }
+            _policy.touch(it->second.hook);
+            return &(it->second.data);
+        }
+
+        /*!
+         * \brief Access cache data without touching it
+         *
+         * \param <_k> key to the data
+         *
+         * \return pointer to the data, mapped by the key, or nullptr when the key is not in the cache
+         *
+         * \see cache::peek
+         */
+        const Data* peek(const Key& _k) const throw() {
+            typename storage_type::const_iterator it=_storage.find(_k);
+            if (it==_storage.end()) {
+                return nullptr;
+            }
+            return &(it->second.data);
+        }
+
+        /*!
+         * \brief Check for the key presence in cache
+         *
+         *  Tests, whether key exists in the cache or not. Existing entry is touched.
+         *
+         *  \param <_k> key to test
+         *
+         * \return true if key exists in the cache and false otherwise
+         */
+        bool check(const Key& _k) throw() {
+            storage_iterator it=_storage.find(_k);
+            if (it==_storage.end()) {
+                return false;
+            }
+            _policy.touch(it->second.hook);
+            return true;
+        }
+
+        /*!
+         * \brief Increase usage count for entry
+         *
+         *  \param _k key to touch, non-existent keys are ignored.
+         */
+        void touch(const Key& _k) throw() {
+            this->check(_k);
+        }
+
+        /*!
+         * \brief Move constructor
+         *
+         * Takes over the nodes of x, leaving it empty.
+         *
+         * \param <x> an intrusive_cache object with the same template parameters
+         */
+        intrusive_cache(intrusive_cache<Key,Data,Policy,Container>&& x) : _storage(), _maxEntries(x._maxEntries), _policy(x._maxEntries) {
+            this->swap(x);
+        }
+        intrusive_cache(const intrusive_cache<Key,Data,Policy,Container>& x) = delete;
+        intrusive_cache<Key,Data,Policy,Container>& operator= (const intrusive_cache<Key,Data,Policy,Container>& x) = delete;
+
+        /*!
+         * \brief Primary constructor.
+         *
+         * \param <size> Maximum number of entries, allowed in the cache.
+         */
+        explicit intrusive_cache(const size_type size) : _storage(), _maxEntries(size), _policy(size) { }
+
+        ~intrusive_cache() {
+            this->clear();
+        }
+    };
+}
+
+#endif /* STLCACHE_INTRUSIVE_CACHE_HPP_INCLUDED */
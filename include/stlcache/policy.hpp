@@ -9,6 +9,8 @@
 #define STLCACHE_POLICY_HPP_INCLUDED
 
 #include <set>
+#include <type_traits>
+#include <utility>
 
 #include <stlcache/exceptions.hpp>
 #include <stlcache/victim.hpp>
@@ -36,6 +38,7 @@ namespace stlcache {
      *       template <typename Key, template <typename T> class Allocator>
      *          struct bind : _policy_none_type<Key,Allocator> { 
      *             bind(const bind& x) : _policy_none_type<Key,Allocator>(x)  { }
+     *             bind& operator= (const bind& x) = default;
      *             bind(const size_t& size) : _policy_none_type<Key,Allocator>(size) { }
      *         };
      *     };
@@ -44,6 +47,11 @@ namespace stlcache {
      * 
      *     Details of the implementation of the any of the policies are not documented and subject to change, but you still may read the sources. 
      * 
+     *     The \link stlcache::cache cache \endlink keeps the bound policy by value and calls it through it's concrete type, so the calls are resolved 
+     *     at compile time. Strictly speaking the policy doesn't need to derive from this class, it only needs to provide the same members (this is 
+     *     checked at compile time). Deriving from it is still the way to go, when you need to select policies at runtime, as it gives you 
+     *     a common type-erased interface for all of them. Mark your bind wrapper final, to let the compiler devirtualize calls inside the policy too. 
+     * 
      *     All policies are configured with the cache's key type and used allocator. It is expected, that policy uses supplied allocator type when doing internal
      *     memory allocations.
      * 
@@ -54,11 +62,24 @@ namespace stlcache {
      *     \see stlcache::policy_none
      *     \see stlcache::policy_lru
      *     \see stlcache::policy_mru
+     *     \see stlcache::policy_indexed_lru
+     *     \see stlcache::policy_indexed_mru
      *     \see stlcache::policy_lfu
      *     \see stlcache::policy_lfustar
      *     \see stlcache::policy_lfuaging
      *     \see stlcache::policy_lfuagingstar
      *     \see stlcache::policy_adaptive
+     *     \see stlcache::policy_indexed_adaptive
+     *     \see stlcache::policy_wtinylfu
+     *     \see stlcache::policy_clock
+     *     \see stlcache::policy_gclock
+     *     \see stlcache::policy_sieve
+     *     \see stlcache::policy_s3fifo
+     *     \see stlcache::policy_lirs
+     *     \see stlcache::policy_2q
+     *     \see stlcache::policy_slru
+     *     \see stlcache::policy_sampled_lru
+     *     \see stlcache::policy_sampled_lfu
      * 
      * \author chollya (5/19/2011)
      */
@@ -148,6 +169,36 @@ namespace stlcache {
         }
     };
 
+    /*
+     * Compile time check of the policy interface. The cache calls the policy through it's concrete bind type, so a policy doesn't have to
+     * derive from the policy class, it only needs to provide the same members.
+     */
+    template <class P, class Key>
+    struct _is_policy {
+        template <class T> static auto check(T* p) -> decltype(
+            (void)p->insert(std::declval<const Key&>()),
+            (void)p->remove(std::declval<const Key&>()),
+            (void)p->touch(std::declval<const Key&>()),
+            (void)p->clear(),
+            (void)p->swap(*p),
+            (void)_victim<Key>(p->victim()),
+            std::true_type());
+        template <class T> static std::false_type check(...);
+
+        static const bool value = decltype(check<P>(nullptr))::value;
+    };
+
+    /*
+     * Whether the policy touches could run concurrently with each other, under the shared side of a lock. False, unless the policy
+     * says otherwise.
+     */
+    template <class P, class Enable = void>
+    struct _policy_concurrent_touch : std::false_type {
+    };
+    template <class P>
+    struct _policy_concurrent_touch<P,typename std::enable_if<P::concurrent_touch>::type> : std::true_type {
+    };
+
     template <class Key, template <typename T> class Container>
     class _policy_none_type : public policy<Key> {
         using set = typename Container<Key>::set ;
@@ -174,12 +225,14 @@ namespace stlcache {
         }
         virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
             try {
-                _policy_none_type<Key,Container>& _pn=dynamic_cast<_policy_none_type<Key,Container>& >(_p);
-                _entries.swap(_pn._entries);
+                this->swap(dynamic_cast<_policy_none_type<Key,Container>& >(_p));
             } catch (const std::bad_cast& ) {
                 throw exception_invalid_policy("Attempted to swap incompatible policies");
             }
         }
+        void swap(_policy_none_type<Key,Container>& _p) throw() {
+            _entries.swap(_p._entries);
+        }
 
         virtual const _victim<Key> victim() throw() {
             if (_entries.rbegin()==_entries.rend()) {
@@ -205,8 +258,9 @@ namespace stlcache {
      */
     struct policy_none {
         template <typename Key>
-            struct bind : _policy_none_type<Key,none_set_container> {
+            struct bind final : _policy_none_type<Key,none_set_container> {
                 bind(const bind& x) : _policy_none_type<Key,none_set_container>(x)  { }
+                bind& operator= (const bind& x) = default;
                 bind(const size_t& size) : _policy_none_type<Key,none_set_container>(size) { }
             };
     };
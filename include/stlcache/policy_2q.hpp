@@ -0,0 +1,140 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_POLICY_2Q_HPP_INCLUDED
+#define STLCACHE_POLICY_2Q_HPP_INCLUDED
+
+#include <cstddef>
+
+#include <stlcache/policy.hpp>
+#include <stlcache/policy_lru.hpp>
+
+namespace stlcache {
+    template <class Key, template <typename T> class Container>
+    class _policy_2q_type : public policy<Key> {
+        /*
+         * New entries go to the A1in FIFO queue. Entries, expired from it, are remembered in the A1out queue, and only the ones, that
+         * come back while they are remembered, get into the Am LRU segment.
+         */
+        enum { _in=0, _out=1, _main=2, _segments=3 };
+
+        using entriesType = _lru_segments<Key,Container,_segments> ;
+        using entriesMapIterator = typename entriesType::entriesMapIterator ;
+
+        entriesType _entries;
+        std::size_t _inSize;
+        std::size_t _outSize;
+    public:
+        /*
+         * A1in takes 25% of the cache and A1out remembers as many keys, as a half of the cache holds. A1in holds everything, until
+         * Am gets it's first entries, so both are reserved for the whole cache, while the index only holds the resident entries and
+         * the ghosts.
+         */
+        _policy_2q_type(const size_t& size ) : _entries(), _inSize(size/4<1 ? 1 : size/4), _outSize(size/2<1 ? 1 : size/2) {
+            std::size_t sizes[_segments]={size+1,_outSize+1,size+1};
+            _entries.reserve(sizes,size+_outSize+2);
+        }
+
+        virtual void insert(const Key& _k) throw(exception_invalid_key) {
+            entriesMapIterator it=_entries.find(_k);
+            if (it==_entries.end()) {
+                _entries.insert(_k,_in);
+            } else if (entriesType::segment(it)==_out) {
+                _entries.move(it,_main);
+            }
+        }
+
+        /*
+         * Entries, removed from A1in, are remembered in A1out. The oldest ones are forgotten, when there are too many of them.
+         */
+        virtual void remove(const Key& _k) throw() {
+            entriesMapIterator it=_entries.find(_k);
+            if (it==_entries.end() || entriesType::segment(it)==_out) {
+                return;
+            }
+            if (entriesType::segment(it)==_main) {
+                _entries.erase(it);
+                return;
+            }
+            try {
+                _entries.move(it,_out);
+            } catch (...) {
+                _entries.erase(it);
+                return;
+            }
+            if (_entries.size(_out)>_outSize) {
+                _entries.erase(_entries.find(_entries.back(_out)));
+            }
+        }
+
+        /*
+         * Hits in A1in are correlated references, that don't say anything about the entry popularity, so only Am entries are moved.
+         */
+        virtual void touch(const Key& _k) throw() {
+            entriesMapIterator it=_entries.find(_k);
+            if (it==_entries.end() || entriesType::segment(it)!=_main) {
+                return;
+            }
+            _entries.touch(it);
+        }
+        virtual void clear() throw() {
+            _entries.clear();
+        }
+        virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
+            try {
+                this->swap(dynamic_cast<_policy_2q_type<Key,Container>& >(_p));
+            } catch (const std::bad_cast& ) {
+                throw exception_invalid_policy("Attempted to swap incompatible policies");
+            }
+        }
+        void swap(_policy_2q_type<Key,Container>& _p) throw() {
+            _entries.swap(_p._entries);
+            std::swap(_inSize,_p._inSize);
+            std::swap(_outSize,_p._outSize);
+        }
+
+        /*
+         * Expires from A1in, while it is over it's share, and from Am otherwise.
+         */
+        virtual const _victim<Key> victim() throw()  {
+            if (!_entries.empty(_in) && (_entries.size(_in)>_inSize || _entries.empty(_main))) {
+                return _victim<Key>(_entries.back(_in));
+            }
+            if (!_entries.empty(_main)) {
+                return _victim<Key>(_entries.back(_main));
+            }
+            return _victim<Key>();
+        }
+    };
+
+    /*!
+     * \brief A '2Q' policy
+     *
+     * Implements the full version of the <a href="http://www.vldb.org/conf/1994/P439.PDF">2Q</a> cache algorithm. New entries go to the A1in
+     * FIFO queue, that takes 25% of the cache. When they are expired from it, their keys are remembered in the A1out queue, for as many
+     * keys as a half of the cache holds. An entry, that is inserted again while it's key is in A1out, goes to the Am LRU segment, that
+     * holds the rest of the cache. So the entries, that are used only once, like the ones produced by a scan, never get into Am.
+     *
+     * \link cache::touch Touching \endlink an Am entry decreases item's expiration probability, touching an A1in entry does nothing.
+     * Every operation is O(1): the queues are \link stlcache::policy_indexed_lru indexed lists \endlink, sharing one
+     * \link stlcache::container_flat_hash_map flat hash map \endlink, so the key must be hashable. This policy is always able to expire any
+     * amount of entries. The cache size should be a realistic entry count, as the queues are sized by it.
+     *
+     * \see policy_slru
+     * \see policy_adaptive
+     */
+    struct policy_2q {
+        template <typename Key>
+            struct bind final : _policy_2q_type<Key,lru_segments_container> {
+                bind(const bind& x) : _policy_2q_type<Key,lru_segments_container>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_2q_type<Key,lru_segments_container>(size) { }
+            };
+    };
+}
+
+#endif /* STLCACHE_POLICY_2Q_HPP_INCLUDED */
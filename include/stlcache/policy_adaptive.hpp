@@ -9,174 +9,330 @@
 #define STLCACHE_POLICY_ADAPTIVE_HPP_INCLUDED
 
 #include <list>
+#include <map>
 
+#include <stlcache/allocator.hpp>
 #include <stlcache/policy.hpp>
+#include <stlcache/policy_lru.hpp>
+#include <stlcache/container_flat_hash_map.hpp>
 
 namespace stlcache {
+    /*
+     * Index entry of the ARC policy: the list, that holds the key, the key's position in it and whether the ghost hit on the key
+     * was already accounted in the target size.
+     */
+    template <class Iterator>
+    struct _adaptive_entry {
+        unsigned int list;
+        bool adapted;
+        Iterator position;
+    };
+
     template <class Key,template <typename T> class Container> class _policy_adaptive_type : public policy<Key> {
-    	using keyAllocator = typename Container<Key>::AdaptativeKeyAllocator ;
-    	using lruMapContainer = typename Container<Key>::AdaptativeLruMapContainer ;
-    	using lfuMapContainer = typename Container<Key>::AdaptativeLfuMapContainer ;
-    	using EntriesType = typename Container<Key>::AdaptativeEntriesType ;
-
-    	size_t _size;
-    	lruMapContainer T1;
-    	EntriesType t1Entries;
-        lruMapContainer B1;
-        EntriesType b1Entries;
-
-        lfuMapContainer T2;
-        EntriesType t2Entries;
-        lfuMapContainer B2;
-        EntriesType b2Entries;
+        using entriesType = typename Container<Key>::entriesType ;
+        using entriesIterator = typename entriesType::iterator ;
+        using entriesMap = typename Container<Key>::entriesMap ;
+        using entriesMapIterator = typename entriesMap::iterator ;
+        using entry = _adaptive_entry<entriesIterator> ;
+
+        /*
+         * T1 and T2 are the resident entries, that were used once and more than once. B1 and B2 are the ghosts: keys, that were
+         * recently expired from T1 and T2. Every list is ordered from the most recently used entry.
+         */
+        enum { _t1=0, _t2=1, _b1=2, _b2=3, _lists=4 };
+
+        size_t _size;
+        size_t _target;
+        bool _b2Hit;
+        entriesType _entries[_lists];
+        entriesMap _entriesMap;
 
+        /*
+         * Moves the key to the front of another list.
+         */
+        void move(entriesMapIterator _it, unsigned int _list) {
+            entriesIterator pos=_entries[_list].insert(_entries[_list].begin(),_it->first);
+            _entries[_it->second.list].erase(_it->second.position);
+            _it->second.list=_list;
+            _it->second.position=pos;
+            _it->second.adapted=false;
+        }
+        void forget(unsigned int _list) throw() {
+            entriesMapIterator it=_entriesMap.find(_entries[_list].back());
+            _entries[_list].erase(it->second.position);
+            _entriesMap.erase(it);
+        }
+
+        /*
+         * A ghost hit means, that the list the key was expired from is too short: a hit in B1 grows the target size of T1 and a hit
+         * in B2 shrinks it. The step is larger, when the other ghost list is longer.
+         */
+        void adapt(entriesMapIterator _it) throw() {
+            if (_it->second.adapted) {
+                return;
+            }
+            size_t b1=_entries[_b1].size();
+            size_t b2=_entries[_b2].size();
+            if (_it->second.list==_b1) {
+                size_t delta=b2>b1 ? b2/b1 : 1;
+                _target=_size-_target>delta ? _target+delta : _size;
+                _b2Hit=false;
+            } else {
+                size_t delta=b1>b2 ? b1/b2 : 1;
+                _target=_target>delta ? _target-delta : 0;
+                _b2Hit=true;
+            }
+            _it->second.adapted=true;
+        }
+
+        void reindex(const _policy_adaptive_type<Key,Container>& x) {
+            _entriesMap.clear();
+            for (unsigned int list=0;list<_lists;list++) {
+                for (entriesIterator it=_entries[list].begin();it!=_entries[list].end();++it) {
+                    entry e={list,x._entriesMap.find(*it)->second.adapted,it};
+                    _entriesMap.insert(std::make_pair(*it,e));
+                }
+            }
+        }
     public:
         _policy_adaptive_type<Key,Container>& operator= ( const _policy_adaptive_type<Key,Container>& x) throw() {
+            if (this==&x) {
+                return *this;
+            }
             this->_size=x._size;
-
-            this->T1=x.T1;
-            this->t1Entries=x.t1Entries;
-            this->B1=x.B1;
-            this->b1Entries=x.b1Entries;
-            this->T2=x.T2;
-            this->t2Entries=x.t2Entries;
-            this->B2=x.B2;
-            this->b2Entries=x.b2Entries;
+            this->_target=x._target;
+            this->_b2Hit=x._b2Hit;
+            for (unsigned int list=0;list<_lists;list++) {
+                this->_entries[list]=x._entries[list];
+            }
+            this->reindex(x);
 
             return *this;
         }
-        _policy_adaptive_type(const _policy_adaptive_type<Key,Container>& x) throw() : T1(x.T1),T2(x.T2),B1(x.B1),B2(x.B2) {
-            this->_size=x._size;
-
-            this->t1Entries=x.t1Entries;
-            this->b1Entries=x.b1Entries;
-            this->t2Entries=x.t2Entries;
-            this->b2Entries=x.b2Entries;
+        _policy_adaptive_type(const _policy_adaptive_type<Key,Container>& x) throw() : _size(x._size), _target(x._target), _b2Hit(x._b2Hit) {
+            *this=x;
         }
-        _policy_adaptive_type(const size_t& size ) throw() : T1(size),T2(size),B1(size),B2(size) { 
-            this->_size=size;
+        _policy_adaptive_type(const size_t& size ) throw() : _size(size), _target(0), _b2Hit(false) {
+            _lru_reserve<Container<Key> >(_entries,_entriesMap,size,0);
         }
 
+        /*
+         * A key from a ghost list comes back into T2. A completely new key goes to T1, and the ghost lists are trimmed, so T1 with
+         * B1 never remember more than the cache size and all four lists never remember more than twice of it.
+         */
         virtual void insert(const Key& _k) throw(exception_invalid_key) {
-            if (b1Entries.find(_k)!=b1Entries.end()) {
-                //Check, whether we are outsized
-                b1Entries.erase(_k);
-                B1.remove(_k);
-
-                t1Entries.insert(_k);
-                T1.insert(_k);
-            } else if (b2Entries.find(_k)!=b2Entries.end()) {
-                B2.remove(_k);
-                b2Entries.erase(_k);
-
-                t2Entries.insert(_k);
-                T2.insert(_k);
-            } else {
-                //Completely new!
+            entriesMapIterator it=_entriesMap.find(_k);
+            if (it!=_entriesMap.end()) {
+                if (it->second.list==_b1 || it->second.list==_b2) {
+                    this->adapt(it);
+                    this->move(it,_t2);
+                }
+                _b2Hit=false;
+                return;
+            }
 
-                t1Entries.insert(_k);
-                T1.insert(_k);
+            entriesIterator pos=_entries[_t1].insert(_entries[_t1].begin(),_k);
+            try {
+                entry e={static_cast<unsigned int>(_t1),false,pos};
+                _entriesMap.insert(std::make_pair(_k,e));
+            } catch (...) {
+                _entries[_t1].erase(pos);
+                throw;
+            }
+            _b2Hit=false;
+
+            while (!_entries[_b1].empty() && _entries[_t1].size()+_entries[_b1].size()>_size) {
+                this->forget(_b1);
+            }
+            while (_entriesMap.size()>_size && _entriesMap.size()-_size>_size) {
+                this->forget(_entries[_b2].empty() ? _b1 : _b2);
             }
         }
-        virtual void remove(const Key& _k) throw() {
-            if (t1Entries.find(_k)!=t1Entries.end()) {
-                B1.insert(_k);
-                b1Entries.insert(_k);
-
-                if (b1Entries.size()>=_size/2) {
-                    _victim<Key> bKey=B1.victim();
-                    B1.remove(*bKey);
-                    b1Entries.erase(*bKey);
-                }
-                t1Entries.erase(_k);
-                T1.remove(_k);
-            } else {
-                B2.insert(_k);
-                b2Entries.insert(_k);
 
-                if (b2Entries.size()>=_size/2) {
-                    _victim<Key> bKey=B2.victim();
-                    B2.remove(*bKey);
-                    b2Entries.erase(*bKey);
-                }
-                t2Entries.erase(_k);
-                T2.remove(_k);
+        /*
+         * Removed entries are remembered in the ghost list of the list they were in.
+         */
+        virtual void remove(const Key& _k) throw() {
+            entriesMapIterator it=_entriesMap.find(_k);
+            if (it==_entriesMap.end() || it->second.list==_b1 || it->second.list==_b2) {
+                return;
+            }
+            try {
+                this->move(it,it->second.list==_t1 ? _b1 : _b2);
+            } catch (...) {
+                _entries[it->second.list].erase(it->second.position);
+                _entriesMap.erase(it);
             }
         }
-        virtual void touch(const Key& _k) throw() { 
-            if (t1Entries.find(_k)!=t1Entries.end()) {
-                t1Entries.erase(_k);
-                T1.remove(_k);
-                t2Entries.insert(_k);
-                T2.insert(_k);
-            } else {
-                T2.touch(_k);
+
+        /*
+         * Touching a resident entry promotes it to the front of T2. Touching a ghost, which happens when the cache is checked
+         * for a key, that was recently expired, adapts the target size right away, so the upcoming insertion already expires
+         * the entry from the list, that deserves it.
+         */
+        virtual void touch(const Key& _k) throw() {
+            entriesMapIterator it=_entriesMap.find(_k);
+            if (it==_entriesMap.end()) {
+                return;
+            }
+            switch (it->second.list) {
+            case _t1:
+                try {
+                    this->move(it,_t2);
+                } catch (...) {
+                }
+                break;
+            case _t2:
+                _entries[_t2].splice(_entries[_t2].begin(),_entries[_t2],it->second.position);
+                break;
+            default:
+                this->adapt(it);
             }
         }
         virtual void clear() throw() {
-            T1.clear();
-            t1Entries.clear();
-            T2.clear();
-            t2Entries.clear();
-            B1.clear();
-            b1Entries.clear();
-            B2.clear();
-            b2Entries.clear();
+            for (unsigned int list=0;list<_lists;list++) {
+                _entries[list].clear();
+            }
+            _entriesMap.clear();
+            _target=0;
+            _b2Hit=false;
         }
         virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
             try {
-                _policy_adaptive_type<Key,Container>& _pn=dynamic_cast<_policy_adaptive_type<Key,Container>& >(_p);
-                T1.swap(_pn.T1);
-                T2.swap(_pn.T2);
-                B1.swap(_pn.B1);
-                B2.swap(_pn.B2);
-
-                size_t _oldSize=_size;
-                _size=_pn._size;
-                _size=_oldSize;
+                this->swap(dynamic_cast<_policy_adaptive_type<Key,Container>& >(_p));
             } catch (const std::bad_cast& ) {
                 throw exception_invalid_policy("Attempted to swap incompatible policies");
             }
         }
+        void swap(_policy_adaptive_type<Key,Container>& _p) throw() {
+            for (unsigned int list=0;list<_lists;list++) {
+                _entries[list].swap(_p._entries[list]);
+            }
+            _entriesMap.swap(_p._entriesMap);
+            std::swap(_size,_p._size);
+            std::swap(_target,_p._target);
+            std::swap(_b2Hit,_p._b2Hit);
+        }
 
+        /*
+         * Expires from T1, while it is longer than it's target size, and from T2 otherwise.
+         */
         virtual const _victim<Key> victim() throw()  {
-            if (t1Entries.size()>t2Entries.size()) {
-                return T1.victim();
-            } else {
-                return T2.victim();
+            size_t t1=_entries[_t1].size();
+            if (t1>0 && (_entries[_t2].empty() || t1>_target || (t1==_target && _b2Hit))) {
+                return _victim<Key>(_entries[_t1].back());
             }
+            if (_entries[_t2].empty()) {
+                return _victim<Key>();
+            }
+            return _victim<Key>(_entries[_t2].back());
         }
     };
 
     template <class Key>
     struct adaptative_default_container
     {
-    	using AdaptativeKeyAllocator = std::allocator<Key> ;
+        using entriesAllocator = std::allocator<Key> ;
+        using entriesType = std::list<Key, entriesAllocator> ;
+        using entriesIterator = typename entriesType::iterator ;
+
+        using entriesMapAllocator = std::allocator<std::pair<const Key, _adaptive_entry<entriesIterator> > > ;
+        using entriesMap = std::map<Key, _adaptive_entry<entriesIterator>, std::less<Key>, entriesMapAllocator> ;
+    } ;
+
+    /*
+     * The default adaptive container with the nodes allocated by the cache allocation model.
+     */
+    template <class Allocator>
+    struct adaptive_allocator_container
+    {
+        template <class Key>
+        struct bind
+        {
+            using entriesAllocator = typename Allocator::template bind<Key> ;
+            using entriesType = std::list<Key, entriesAllocator> ;
+            using entriesIterator = typename entriesType::iterator ;
 
-    	using AdaptativeLruMapContainer = _policy_lru_type<Key, lru_default_container> ;
-    	using AdaptativeLfuMapContainer = _policy_lfu_type<Key, lfu_default_container> ;
+            using entriesMapAllocator = typename Allocator::template bind<std::pair<const Key, _adaptive_entry<entriesIterator> > > ;
+            using entriesMap = std::map<Key, _adaptive_entry<entriesIterator>, std::less<Key>, entriesMapAllocator> ;
 
-    	using AdaptativeEntriesType = std::set<Key, std::less<Key>, AdaptativeKeyAllocator> ;
+            template <std::size_t Lists>
+            static void reserve(entriesType (&_entries)[Lists], entriesMap& _map, std::size_t _size) {
+                for (std::size_t list=0;list<Lists;list++) {
+                    _allocator_reserve(_entries[list].get_allocator(),_size,0);
+                }
+                _allocator_reserve(_map.get_allocator(),_size*2+1,0);
+            }
+        } ;
+    } ;
+
+    template <class Key>
+    struct adaptive_indexed_container
+    {
+        using entriesType = _indexed_list<Key> ;
+        using entriesIterator = typename entriesType::iterator ;
+
+        using entriesMap = _flat_hash_map<Key, _adaptive_entry<entriesIterator> > ;
+
+        /*
+         * Every list is allocated for the cache size and the index for the resident entries together with the ghosts. A new key is
+         * indexed before the ghosts are trimmed, so the index briefly holds one key more.
+         */
+        template <std::size_t Lists>
+        static void reserve(entriesType (&_entries)[Lists], entriesMap& _map, std::size_t _size) {
+            if (_size<entriesType::max_size()/2) {
+                for (std::size_t list=0;list<Lists;list++) {
+                    _entries[list].reserve(_size);
+                }
+                _map.reserve(_size*2+1);
+            }
+        }
     } ;
 
     /*!
      * \brief A 'Adaptive replacement' policy
-     * 
-     * Implements <a href="http://en.wikipedia.org/wiki/Adaptive_replacement_cache">'Adaptive replacement'</a> cache algorithm. 
-     *  
-     * The adaptive cache algorithm is balancing between internal LRU and LFU caches, trying to adapt to the external expectations on it.
-     *    
-     * \link cache::touch Touching \endlink the entry decreases item's expiration probability. This policy is always able to expire any amount of entries.     
-     *  
-     * No additional configuration is required. 
-     *  
+     *
+     * Implements <a href="http://en.wikipedia.org/wiki/Adaptive_replacement_cache">'Adaptive replacement'</a> cache algorithm.
+     *
+     * The adaptive cache algorithm keeps two LRU lists: the entries, that were used once, and the entries, that were used more than once.
+     * It also remembers the keys, that were recently expired from each list. When an expired key is requested again, the cache learns,
+     * that the list it was expired from is too short, and moves the balance between the lists. A ghost hit is noticed, when the key
+     * is \link cache::check checked \endlink or \link cache::touch touched \endlink, as well as when it is inserted again.
+     *
+     * \link cache::touch Touching \endlink the entry decreases item's expiration probability. This policy is always able to expire any amount of entries.
+     *
+     * No additional configuration is required. The policy remembers up to the cache size of expired keys.
+     *
      */
     struct policy_adaptive {
         template <typename Key>
-            struct bind : _policy_adaptive_type<Key,adaptative_default_container> {
+            struct bind final : _policy_adaptive_type<Key,adaptative_default_container> {
                 bind(const bind& x) : _policy_adaptive_type<Key,adaptative_default_container>(x)  { }
+                bind& operator= (const bind& x) = default;
                 bind(const size_t& size) : _policy_adaptive_type<Key,adaptative_default_container>(size) { }
             };
+        template <typename Key, class Allocator>
+            struct allocator_bind final : _policy_adaptive_type<Key,adaptive_allocator_container<Allocator>::template bind> {
+                allocator_bind(const allocator_bind& x) : _policy_adaptive_type<Key,adaptive_allocator_container<Allocator>::template bind>(x)  { }
+                allocator_bind& operator= (const allocator_bind& x) = default;
+                allocator_bind(const size_t& size) : _policy_adaptive_type<Key,adaptive_allocator_container<Allocator>::template bind>(size) { }
+            };
+    };
+
+    /*!
+     * \brief A 'Adaptive replacement' policy without allocations
+     *
+     * Same as the \link stlcache::policy_adaptive policy_adaptive \endlink, but the lists are \link stlcache::policy_indexed_lru indexed \endlink
+     * and the keys are hashed by the \link stlcache::container_flat_hash_map flat hash map \endlink, so every operation is O(1). The key
+     * must be hashable and the cache size must be below 2^31.
+     */
+    struct policy_indexed_adaptive {
+        template <typename Key>
+            struct bind final : _policy_adaptive_type<Key,adaptive_indexed_container> {
+                bind(const bind& x) : _policy_adaptive_type<Key,adaptive_indexed_container>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_adaptive_type<Key,adaptive_indexed_container>(size) { }
+            };
     };
 }
 
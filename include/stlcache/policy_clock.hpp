@@ -0,0 +1,228 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_POLICY_CLOCK_HPP_INCLUDED
+#define STLCACHE_POLICY_CLOCK_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <stlcache/policy.hpp>
+#include <stlcache/policy_lru.hpp>
+#include <stlcache/container_flat_hash_map.hpp>
+
+namespace stlcache {
+    /*
+     * Reference counter of a single clock slot. It is atomic, so touches could be done concurrently under a shared lock, and copyable,
+     * so the counters could live in a plain vector.
+     */
+    class _clock_reference {
+        std::atomic<unsigned char> _value;
+    public:
+        explicit _clock_reference(unsigned char _v) throw() : _value(_v) { }
+        _clock_reference(const _clock_reference& x) throw() : _value(x.load()) { }
+        _clock_reference& operator=(const _clock_reference& x) throw() {
+            this->store(x.load());
+            return *this;
+        }
+
+        unsigned char load() const throw() {
+            return _value.load(std::memory_order_relaxed);
+        }
+        void store(unsigned char _v) throw() {
+            _value.store(_v,std::memory_order_relaxed);
+        }
+    };
+
+    template <class Key, template <typename T> class Container, unsigned char Max>
+    class _policy_clock_type : public policy<Key> {
+        using keysType = typename Container<Key>::keysType ;
+        using entriesMap = typename Container<Key>::entriesMap ;
+        using entriesMapIterator = typename entriesMap::iterator ;
+
+        static const unsigned char _free = 0xFF;
+        static const std::size_t _maxReserved = std::size_t(1)<<24;
+
+        /*
+         * The keys are kept in slots. Every slot has a reference counter, that is set by touches and decremented by the clock hand, when it
+         * passes the slot. Removed slots are marked free and reused by the following insertions.
+         */
+        keysType _keys;
+        std::vector<_clock_reference> _references;
+        std::vector<std::size_t> _freeSlots;
+        std::size_t _hand;
+        entriesMap _entriesMap;
+    public:
+        /*
+         * Touching the policy only stores into the slot counter, so it could be done concurrently with other touches.
+         */
+        static const bool concurrent_touch = true;
+
+        _policy_clock_type(const size_t& size) : _keys(), _references(), _freeSlots(), _hand(0), _entriesMap() {
+            if (size<_maxReserved) {
+                _lru_reserve<Container<Key> >(_keys,_entriesMap,size,0);
+                _references.reserve(size);
+                _freeSlots.reserve(size);
+            }
+        }
+
+        virtual void insert(const Key& _k) throw(exception_invalid_key) {
+            std::size_t slot;
+            if (_freeSlots.empty()) {
+                slot=_keys.size();
+                _keys.push_back(_k);
+                try {
+                    _references.push_back(_clock_reference(_free));
+                    _freeSlots.reserve(_keys.size());
+                } catch (...) {
+                    _references.resize(slot,_clock_reference(_free));
+                    _keys.pop_back();
+                    throw;
+                }
+            } else {
+                slot=_freeSlots.back();
+                _keys[slot]=_k;
+                _freeSlots.pop_back();
+            }
+            try {
+                _entriesMap.insert(std::make_pair(_k,slot));
+            } catch (...) {
+                _freeSlots.push_back(slot);
+                throw;
+            }
+            _references[slot].store(0);
+        }
+        virtual void remove(const Key& _k) throw() {
+            entriesMapIterator it=_entriesMap.find(_k);
+            if (it==_entriesMap.end()) {
+                return;
+            }
+            _references[it->second].store(_free);
+            _freeSlots.push_back(it->second);
+            _entriesMap.erase(it);
+        }
+        virtual void touch(const Key& _k) throw() {
+            entriesMapIterator it=_entriesMap.find(_k);
+            if (it==_entriesMap.end()) {
+                return;
+            }
+            _clock_reference& reference=_references[it->second];
+            unsigned char value=reference.load();
+            if (value<Max) {
+                reference.store(value+1);
+            }
+        }
+        virtual void clear() throw() {
+            _keys.clear();
+            _references.clear();
+            _freeSlots.clear();
+            _hand=0;
+            _entriesMap.clear();
+        }
+        virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
+            try {
+                this->swap(dynamic_cast<_policy_clock_type<Key,Container,Max>& >(_p));
+            } catch (const std::bad_cast& ) {
+                throw exception_invalid_policy("Attempted to swap incompatible policies");
+            }
+        }
+        void swap(_policy_clock_type<Key,Container,Max>& _p) throw() {
+            _keys.swap(_p._keys);
+            _references.swap(_p._references);
+            _freeSlots.swap(_p._freeSlots);
+            std::swap(_hand,_p._hand);
+            _entriesMap.swap(_p._entriesMap);
+        }
+
+        /*
+         * The hand sweeps the slots, decrementing the counters, and stops at the first unreferenced entry.
+         */
+        virtual const _victim<Key> victim() throw()  {
+            if (_entriesMap.empty()) {
+                return _victim<Key>();
+            }
+            for (;;) {
+                if (_hand>=_keys.size()) {
+                    _hand=0;
+                }
+                _clock_reference& reference=_references[_hand];
+                unsigned char value=reference.load();
+                if (value==0) {
+                    return _victim<Key>(_keys[_hand++]);
+                }
+                if (value!=_free) {
+                    reference.store(value-1);
+                }
+                _hand++;
+            }
+        }
+    };
+
+    template <class Key>
+    struct clock_default_container
+    {
+        using keysType = std::vector<Key> ;
+        using entriesMap = _flat_hash_map<Key, std::size_t> ;
+
+        static void reserve(keysType& _keys, entriesMap& _map, std::size_t _size) {
+            _keys.reserve(_size);
+            _map.reserve(_size);
+        }
+    } ;
+
+    /*!
+     * \brief A 'CLOCK' policy
+     *
+     * Implements the <a href="http://en.wikipedia.org/wiki/Page_replacement_algorithm#Clock">CLOCK</a> cache algorithm, an approximation of
+     * the \link stlcache::policy_lru LRU \endlink policy.
+     *
+     * The keys are kept in a ring of slots, each with a reference bit. \link cache::touch Touching \endlink the entry only sets it's bit, without
+     * moving anything. The victim is selected by a hand, that sweeps the ring, clearing the bits, until it finds an entry, that wasn't
+     * touched since the previous sweep. So hits are a single lookup and a single store, which makes this policy a good fit for read mostly
+     * workloads. With the \link stlcache::concurrency_buffered concurrency_buffered \endlink mode of the \link stlcache::concurrent_cache concurrent_cache \endlink
+     * hits touch the policy directly under the shared lock, without buffering.
+     *
+     * This policy is always able to expire any amount of entries. The key must be hashable.
+     *
+     * \see policy_gclock
+     * \see policy_lru
+     */
+    struct policy_clock {
+        template <typename Key>
+            struct bind final : _policy_clock_type<Key,clock_default_container,1> {
+                bind(const bind& x) : _policy_clock_type<Key,clock_default_container,1>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_clock_type<Key,clock_default_container,1>(size) { }
+            };
+    };
+
+    /*!
+     * \brief A 'Generalized CLOCK' policy
+     *
+     * Same as the \link stlcache::policy_clock policy_clock \endlink, but every slot has a saturating counter of up to N touches instead of a
+     * single bit, and the hand decrements it on every pass. So the entry, that was touched more often, survives more sweeps, which makes
+     * the policy closer to the \link stlcache::policy_lfu LFU \endlink one.
+     *
+     * \tparam <N> Maximal value of the counter, from 1 to 254. policy_gclock<1> is the same as policy_clock.
+     *
+     * \see policy_clock
+     */
+    template <unsigned int N>
+    struct policy_gclock {
+        static_assert(N>0 && N<0xFF, "GCLOCK counter must be between 1 and 254");
+
+        template <typename Key>
+            struct bind final : _policy_clock_type<Key,clock_default_container,N> {
+                bind(const bind& x) : _policy_clock_type<Key,clock_default_container,N>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_clock_type<Key,clock_default_container,N>(size) { }
+            };
+    };
+}
+
+#endif /* STLCACHE_POLICY_CLOCK_HPP_INCLUDED */
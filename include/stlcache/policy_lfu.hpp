@@ -8,17 +8,238 @@
 #ifndef STLCACHE_POLICY_LFU_HPP_INCLUDED
 #define STLCACHE_POLICY_LFU_HPP_INCLUDED
 
+#include <cstddef>
+#include <iterator>
+#include <list>
 #include <set>
-#include <map>
+#include <memory>
+#include <utility>
 
+#include <stlcache/allocator.hpp>
+#include <stlcache/container_flat_hash_map.hpp>
 #include <stlcache/policy.hpp>
+#include <stlcache/policy_lru.hpp>
 
 namespace stlcache {
+    /*
+     * Entries of the LFU policy, grouped into buckets of the same reference count. Buckets are kept in the increasing reference count
+     * order and keys inside of a bucket in the order they got there, so the entries are iterated just like a multimap from the reference
+     * count to the key. Moving a key to the neighbour bucket is a list splice, so both touch and untouch are O(1). Emptied buckets are
+     * kept aside and reused, so a key changing it's count doesn't allocate at all. Keys are spliced between the buckets, so all the lists
+     * share the allocator of the bucket list.
+     */
+    template <class Key, class Allocator = std::allocator<Key> >
+    class _lfu_entries {
+    public:
+        using value_type = std::pair<unsigned int, Key> ;
+    private:
+        using keyAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type> ;
+        using keyList = std::list<value_type, keyAllocator> ;
+
+        struct bucket_type {
+            unsigned int refCount;
+            keyList keys;
+
+            bucket_type(unsigned int _refCount, const keyAllocator& _allocator) : refCount(_refCount), keys(_allocator) { }
+        };
+        using bucketAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<bucket_type> ;
+        using bucketList = std::list<bucket_type, bucketAllocator> ;
+        using bucketIterator = typename bucketList::iterator ;
+
+        bucketList _buckets;
+        bucketList _spare;
+
+        bucketIterator make_bucket(bucketIterator _before, unsigned int _refCount) {
+            if (_spare.empty()) {
+                return _buckets.insert(_before,bucket_type(_refCount,keyAllocator(_buckets.get_allocator())));
+            }
+            bucketIterator b=_spare.begin();
+            b->refCount=_refCount;
+            _buckets.splice(_before,_spare,b);
+            return b;
+        }
+        void release(bucketIterator _b) throw() {
+            _spare.splice(_spare.begin(),_buckets,_b);
+        }
+        /*
+         * Moves the key to the bucket with the _refCount reference count, that is either _b itself or it's _neighbour.
+         */
+        void move(bucketIterator& _b, typename keyList::iterator _k, bucketIterator _neighbour, bucketIterator _before, unsigned int _refCount) {
+            if (_neighbour==_buckets.end() || _neighbour->refCount!=_refCount) {
+                if (_b->keys.size()==1) {
+                    _b->refCount=_refCount;
+                    _k->first=_refCount;
+                    return;
+                }
+                _neighbour=this->make_bucket(_before,_refCount);
+            }
+            _neighbour->keys.splice(_neighbour->keys.end(),_b->keys,_k);
+            _k->first=_refCount;
+            if (_b->keys.empty()) {
+                this->release(_b);
+            }
+            _b=_neighbour;
+        }
+    public:
+        /*
+         * Handle of the key in the entries, that stays valid until the key is erased.
+         */
+        struct position {
+            bucketIterator bucket;
+            typename keyList::iterator key;
+
+            position(bucketIterator _b, typename keyList::iterator _k) : bucket(_b), key(_k) { }
+        };
+
+        class const_iterator {
+            friend class _lfu_entries<Key,Allocator>;
+
+            typename bucketList::const_iterator _bucket;
+            typename bucketList::const_iterator _last;
+            typename keyList::const_iterator _key;
+
+            const_iterator(typename bucketList::const_iterator _b, typename bucketList::const_iterator _l, typename keyList::const_iterator _k) : _bucket(_b), _last(_l), _key(_k) { }
+        public:
+            using iterator_category = std::forward_iterator_tag ;
+            using value_type = typename _lfu_entries<Key,Allocator>::value_type ;
+            using difference_type = std::ptrdiff_t ;
+            using pointer = const value_type* ;
+            using reference = const value_type& ;
+
+            reference operator*() const {
+                return *_key;
+            }
+            pointer operator->() const {
+                return &*_key;
+            }
+            const_iterator& operator++() {
+                if (++_key==_bucket->keys.end() && ++_bucket!=_last) {
+                    _key=_bucket->keys.begin();
+                }
+                return *this;
+            }
+            const_iterator operator++(int) {
+                const_iterator result(*this);
+                ++(*this);
+                return result;
+            }
+            bool operator==(const const_iterator& x) const {
+                return _bucket==x._bucket && (_bucket==_last || _key==x._key);
+            }
+            bool operator!=(const const_iterator& x) const {
+                return !(*this==x);
+            }
+        };
+        using iterator = const_iterator ;
+
+        _lfu_entries() : _buckets(), _spare(_buckets.get_allocator()) { }
+        _lfu_entries(const _lfu_entries<Key,Allocator>& x) : _buckets(), _spare(_buckets.get_allocator()) {
+            *this=x;
+        }
+        _lfu_entries<Key,Allocator>& operator=(const _lfu_entries<Key,Allocator>& x) {
+            if (this==&x) {
+                return *this;
+            }
+            _buckets.clear();
+            for (typename bucketList::const_iterator b=x._buckets.begin();b!=x._buckets.end();++b) {
+                this->make_bucket(_buckets.end(),b->refCount)->keys.assign(b->keys.begin(),b->keys.end());
+            }
+            return *this;
+        }
+
+        Allocator get_allocator() const {
+            return Allocator(_buckets.get_allocator());
+        }
+
+        const_iterator begin() const {
+            if (_buckets.empty()) {
+                return this->end();
+            }
+            return const_iterator(_buckets.begin(),_buckets.end(),_buckets.begin()->keys.begin());
+        }
+        const_iterator end() const {
+            return const_iterator(_buckets.end(),_buckets.end(),typename keyList::const_iterator());
+        }
+        bool empty() const throw() {
+            return _buckets.empty();
+        }
+
+        /*
+         * The oldest key with the _refCount reference count. Only the buckets below it are looked at, so the smallest counts are found fast.
+         */
+        const_iterator find(unsigned int _refCount) const {
+            for (typename bucketList::const_iterator b=_buckets.begin();b!=_buckets.end() && b->refCount<=_refCount;++b) {
+                if (b->refCount==_refCount) {
+                    return const_iterator(b,_buckets.end(),b->keys.begin());
+                }
+            }
+            return this->end();
+        }
+
+        template <class F>
+        void for_each(F _f) {
+            for (bucketIterator b=_buckets.begin();b!=_buckets.end();++b) {
+                for (typename keyList::iterator k=b->keys.begin();k!=b->keys.end();++k) {
+                    _f(k->second,position(b,k));
+                }
+            }
+        }
+
+        position insert(unsigned int _refCount, const Key& _k) {
+            bucketIterator b=_buckets.begin();
+            while (b!=_buckets.end() && b->refCount<_refCount) {
+                ++b;
+            }
+            if (b==_buckets.end() || b->refCount!=_refCount) {
+                b=this->make_bucket(b,_refCount);
+            }
+            try {
+                b->keys.push_back(value_type(_refCount,_k));
+            } catch (...) {
+                if (b->keys.empty()) {
+                    this->release(b);
+                }
+                throw;
+            }
+            return position(b,--b->keys.end());
+        }
+        void erase(const position& _p) throw() {
+            _p.bucket->keys.erase(_p.key);
+            if (_p.bucket->keys.empty()) {
+                this->release(_p.bucket);
+            }
+        }
+        void increment(position& _p) {
+            unsigned int refCount=_p.bucket->refCount+1;
+            bucketIterator next=_p.bucket;
+            ++next;
+            this->move(_p.bucket,_p.key,next,next,refCount);
+        }
+        void decrement(position& _p) {
+            unsigned int refCount=_p.bucket->refCount-1;
+            bucketIterator prev=_p.bucket;
+            if (prev==_buckets.begin()) {
+                prev=_buckets.end();
+            } else {
+                --prev;
+            }
+            this->move(_p.bucket,_p.key,prev,_p.bucket,refCount);
+        }
+
+        void clear() throw() {
+            _buckets.clear();
+            _spare.clear();
+        }
+        void swap(_lfu_entries<Key,Allocator>& x) throw() {
+            _buckets.swap(x._buckets);
+            _spare.swap(x._spare);
+        }
+    };
+
     template <class Key,template <typename T> class Container> class _policy_lfu_type : public policy<Key> {
     protected:
-        using entriesPair = typename Container<Key>::LFUEntriesPair ;
         using entriesType = typename Container<Key>::LFUEntriesType ;
-        using entriesIterator = typename entriesType::iterator ;
+        using entriesPosition = typename entriesType::position ;
         entriesType _entries;
 
         using backEntriesPair =  typename Container<Key>::LFUBackEntriesPair;
@@ -29,18 +250,28 @@ namespace stlcache {
     public:
         _policy_lfu_type<Key,Container>& operator= ( const _policy_lfu_type<Key,Container>& x) throw() {
             this->_entries=x._entries;
-            this->_backEntries=x._backEntries;
+            this->_backEntries.clear();
+            backEntriesType& backEntries=this->_backEntries;
+            this->_entries.for_each([&backEntries](const Key& _k, const entriesPosition& _p) {
+                backEntries.insert(backEntriesPair(_k,_p));
+            });
             return *this;
         }
         _policy_lfu_type(const _policy_lfu_type<Key,Container>& x) throw() {
             *this=x;
         }
-        _policy_lfu_type(const size_t& size ) throw() { }
+        _policy_lfu_type(const size_t& size ) throw() {
+            _lru_reserve<Container<Key> >(_entries,_backEntries,size,0);
+        }
 
         virtual void insert(const Key& _k,unsigned int refCount) throw(exception_invalid_key) {
-            //1 - is initial reference value
-            entriesIterator newEntryIter = _entries.insert(entriesPair(refCount,_k));
-            _backEntries.insert(backEntriesPair(_k,newEntryIter));
+            entriesPosition pos=_entries.insert(refCount,_k);
+            try {
+                _backEntries.insert(backEntriesPair(_k,pos));
+            } catch (...) {
+                _entries.erase(pos);
+                throw;
+            }
         }
         virtual void insert(const Key& _k) throw(exception_invalid_key) {
             //1 - is initial reference value
@@ -54,7 +285,7 @@ namespace stlcache {
             }
 
             _entries.erase(backIter->second);
-            _backEntries.erase(_k);
+            _backEntries.erase(backIter);
         }
         virtual void touch(const Key& _k) throw() { 
             backEntriesIterator backIter = _backEntries.find(_k);
@@ -62,11 +293,7 @@ namespace stlcache {
                 return;
             }
 
-            unsigned int refCount=backIter->second->first;
-            
-            _entries.erase(backIter->second);
-            entriesIterator entryIter=_entries.insert(entriesPair(refCount+1,_k));
-            backIter->second=entryIter;
+            _entries.increment(backIter->second);
         }
         virtual void clear() throw() {
             _entries.clear();
@@ -74,16 +301,18 @@ namespace stlcache {
         }
         virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
             try {
-                _policy_lfu_type<Key,Container>& _pn=dynamic_cast<_policy_lfu_type<Key,Container>& >(_p);
-                _entries.swap(_pn._entries);
-                _backEntries.swap(_pn._backEntries);
+                this->swap(dynamic_cast<_policy_lfu_type<Key,Container>& >(_p));
             } catch (const std::bad_cast& ) {
                 throw exception_invalid_policy("Attempted to swap incompatible policies");
             }
         }
+        void swap(_policy_lfu_type<Key,Container>& _p) throw() {
+            _entries.swap(_p._entries);
+            _backEntries.swap(_p._backEntries);
+        }
 
         virtual const _victim<Key> victim() throw()  {
-            if (_entries.begin()==_entries.end()) {
+            if (_entries.empty()) {
                 return _victim<Key>();
             }
 
@@ -99,7 +328,7 @@ namespace stlcache {
             if (backIter==_backEntries.end()) {
                 return 0;
             }
-            unsigned int refCount=backIter->second->first;
+            unsigned int refCount=backIter->second.key->first;
 
 
             if (!(refCount>1)) {
@@ -107,25 +336,203 @@ namespace stlcache {
             }
 
 
-            _entries.erase(backIter->second);
-            entriesIterator entryIter=_entries.insert(entriesPair(refCount-1,_k));
-            backIter->second=entryIter;
+            _entries.decrement(backIter->second);
 
             return refCount;
         }
     };
 
+    /*
+     * Intrusive flavour of the LFU policy, used by the intrusive_cache. Entries with the same reference count are
+     * linked into a bucket and buckets are kept in increasing reference count order, so touch just moves a hook to
+     * the neighbour bucket and victim is the oldest hook of the first bucket.
+     */
+    template <class Key>
+    class _intrusive_lfu_type {
+    public:
+        struct bucket_type;
+        struct hook_type {
+            hook_type* prev;
+            hook_type* next;
+            bucket_type* bucket;
+            const Key* key;
+
+            hook_type() throw() : prev(nullptr), next(nullptr), bucket(nullptr), key(nullptr) { }
+        };
+        struct bucket_type {
+            unsigned int refCount;
+            bucket_type* prev;
+            bucket_type* next;
+            hook_type* head;
+            hook_type* tail;
+        };
+    private:
+        using bucketAllocator = std::allocator<bucket_type> ;
+
+        bucket_type* _buckets; //Bucket with the smallest reference count
+        bucketAllocator _bucketAlloc;
+
+        bucket_type* make_bucket(unsigned int refCount, bucket_type* prev, bucket_type* next) {
+            bucket_type* b=_bucketAlloc.allocate(1);
+            b->refCount=refCount;
+            b->prev=prev;
+            b->next=next;
+            b->head=nullptr;
+            b->tail=nullptr;
+            if (prev) {
+                prev->next=b;
+            } else {
+                _buckets=b;
+            }
+            if (next) {
+                next->prev=b;
+            }
+            return b;
+        }
+        void drop_bucket(bucket_type* b) throw() {
+            if (b->prev) {
+                b->prev->next=b->next;
+            } else {
+                _buckets=b->next;
+            }
+            if (b->next) {
+                b->next->prev=b->prev;
+            }
+            _bucketAlloc.deallocate(b,1);
+        }
+        void link(hook_type& _h, bucket_type* b) throw() {
+            _h.bucket=b;
+            _h.next=nullptr;
+            _h.prev=b->tail;
+            if (b->tail) {
+                b->tail->next=&_h;
+            } else {
+                b->head=&_h;
+            }
+            b->tail=&_h;
+        }
+        void unlink(hook_type& _h) throw() {
+            bucket_type* b=_h.bucket;
+            if (_h.prev) {
+                _h.prev->next=_h.next;
+            } else {
+                b->head=_h.next;
+            }
+            if (_h.next) {
+                _h.next->prev=_h.prev;
+            } else {
+                b->tail=_h.prev;
+            }
+            _h.prev=nullptr;
+            _h.next=nullptr;
+            _h.bucket=nullptr;
+        }
+    public:
+        _intrusive_lfu_type(const size_t&) throw() : _buckets(nullptr) { }
+        _intrusive_lfu_type(const _intrusive_lfu_type<Key>& x) = delete;
+        _intrusive_lfu_type<Key>& operator= (const _intrusive_lfu_type<Key>& x) = delete;
+        ~_intrusive_lfu_type() {
+            this->clear();
+        }
+
+        void insert(hook_type& _h, const Key& _k) {
+            //1 - is initial reference value
+            bucket_type* b=_buckets;
+            if (!b || b->refCount!=1) {
+                b=make_bucket(1,nullptr,_buckets);
+            }
+            _h.key=&_k;
+            link(_h,b);
+        }
+        void remove(hook_type& _h) throw() {
+            bucket_type* b=_h.bucket;
+            unlink(_h);
+            if (!b->head) {
+                drop_bucket(b);
+            }
+        }
+        void touch(hook_type& _h) {
+            bucket_type* b=_h.bucket;
+            bucket_type* next=b->next;
+            if (!next || next->refCount!=b->refCount+1) {
+                if (b->head==&_h && b->tail==&_h) {
+                    b->refCount++; //The only entry of the bucket, that has no neighbour to join, keeps it
+                    return;
+                }
+                next=make_bucket(b->refCount+1,b,next);
+            }
+            unlink(_h);
+            link(_h,next);
+            if (!b->head) {
+                drop_bucket(b);
+            }
+        }
+        void clear() throw() {
+            while (_buckets) {
+                bucket_type* next=_buckets->next;
+                _bucketAlloc.deallocate(_buckets,1);
+                _buckets=next;
+            }
+        }
+        void swap(_intrusive_lfu_type<Key>& _p) throw() {
+            std::swap(_buckets,_p._buckets);
+        }
+        hook_type* victim() throw() {
+            if (!_buckets) {
+                return nullptr;
+            }
+            return _buckets->head;
+        }
+    };
+
+    /*
+     * Keys are indexed by the flat hash map, so finding the entry to touch is O(1) just like moving it. The index is allocated for the
+     * whole cache up front, unless the size is too large to be a real bound.
+     */
     template <class Key>
     struct lfu_default_container
     {
-    	using LFUEntriesPair = std::pair<const unsigned int, Key> ;
-    	using LFUEntriesAllocator = std::allocator<LFUEntriesPair> ;
-    	using LFUEntriesType = std::multimap<unsigned int, Key, std::less<Key>, LFUEntriesAllocator> ;
-        using LFUEntriesIterator = typename LFUEntriesType::iterator ;
+    	using LFUEntriesAllocator = std::allocator<Key> ;
+    	using LFUEntriesType = _lfu_entries<Key, LFUEntriesAllocator> ;
+        using LFUEntriesPosition = typename LFUEntriesType::position ;
 
-        using LFUBackEntriesPair = std::pair<const Key,LFUEntriesIterator> ;
+        using LFUBackEntriesPair = std::pair<const Key,LFUEntriesPosition> ;
     	using LFUBackEntriesAllocator = std::allocator<LFUBackEntriesPair> ;
-    	using LFUBackEntriesType = std::map<Key, LFUEntriesIterator, std::less<Key>, LFUBackEntriesAllocator> ;
+    	using LFUBackEntriesType = _flat_hash_map<Key, LFUEntriesPosition, std::hash<Key>, std::equal_to<Key>, LFUBackEntriesAllocator> ;
+
+        static const std::size_t _maxReserved = std::size_t(1)<<24;
+
+        static void reserve(LFUEntriesType&, LFUBackEntriesType& _map, std::size_t _size) {
+            if (_size<_maxReserved) {
+                _map.reserve(_size);
+            }
+        }
+    } ;
+
+    /*
+     * The default LFU container with the nodes allocated by the cache allocation model.
+     */
+    template <class Allocator>
+    struct lfu_allocator_container
+    {
+        template <class Key>
+        struct bind
+        {
+            using LFUEntriesAllocator = typename Allocator::template bind<Key> ;
+            using LFUEntriesType = _lfu_entries<Key, LFUEntriesAllocator> ;
+            using LFUEntriesPosition = typename LFUEntriesType::position ;
+
+            using LFUBackEntriesPair = std::pair<const Key,LFUEntriesPosition> ;
+            using LFUBackEntriesAllocator = typename Allocator::template bind<LFUBackEntriesPair> ;
+            using LFUBackEntriesType = _flat_hash_map<Key, LFUEntriesPosition, std::hash<Key>, std::equal_to<Key>, LFUBackEntriesAllocator> ;
+
+            static void reserve(LFUEntriesType& _entries, LFUBackEntriesType& _map, std::size_t _size) {
+                _allocator_reserve(_entries.get_allocator(),_size,0);
+                if (_size<lfu_default_container<Key>::_maxReserved) {
+                    _map.reserve(_size);
+                }
+            }
+        } ;
     } ;
 
     /*!
@@ -138,6 +545,9 @@ namespace stlcache {
      * the account the number of entry usages. 
      * \link cache::touch Touching \endlink the entry greatly decreases item's expiration probability. This policy is always able to expire any amount of entries. 
      *  
+     * Touching the entry and selecting a victim are O(1): keys are indexed by the \link stlcache::container_flat_hash_map flat hash map \endlink,
+     * so the key must be hashable.
+     *  
      * No additional configuration is required. 
      *  
      * \see policy_lfustar
@@ -147,10 +557,21 @@ namespace stlcache {
      */
     struct policy_lfu {
         template <typename Key>
-            struct bind : _policy_lfu_type<Key,lfu_default_container> {
+            struct bind final : _policy_lfu_type<Key,lfu_default_container> {
                 bind(const bind& x) : _policy_lfu_type<Key,lfu_default_container>(x)  { }
+                bind& operator= (const bind& x) = default;
                 bind(const size_t& size) : _policy_lfu_type<Key,lfu_default_container>(size) { }
             };
+        template <typename Key, class Allocator>
+            struct allocator_bind final : _policy_lfu_type<Key,lfu_allocator_container<Allocator>::template bind> {
+                allocator_bind(const allocator_bind& x) : _policy_lfu_type<Key,lfu_allocator_container<Allocator>::template bind>(x)  { }
+                allocator_bind& operator= (const allocator_bind& x) = default;
+                allocator_bind(const size_t& size) : _policy_lfu_type<Key,lfu_allocator_container<Allocator>::template bind>(size) { }
+            };
+        template <typename Key>
+            struct intrusive_bind final : _intrusive_lfu_type<Key> {
+                intrusive_bind(const size_t& size) : _intrusive_lfu_type<Key>(size) { }
+            };
     };
 }
 
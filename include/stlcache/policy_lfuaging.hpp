@@ -8,26 +8,41 @@
 #ifndef STLCACHE_POLICY_LFUAGING_HPP_INCLUDED
 #define STLCACHE_POLICY_LFUAGING_HPP_INCLUDED
 
-#include <set>
 #include <map>
+#include <list>
 #include <ctime>
 
+#include <stlcache/allocator.hpp>
 #include <stlcache/policy.hpp>
 
 namespace stlcache {
     template <time_t Age,class Key,template <typename T> class Container> class _policy_lfuaging_type : public virtual _policy_lfu_type<Key,Container> {
-        using keyAllocator = typename Container<Key>::LFUAgingKeySetAllocator ;
-    	using keySet = typename Container<Key>::LFUAgingKeySetType ;
+        using recencyType = typename Container<Key>::LFUAgingRecencyType ;
+        using recencyIterator = typename recencyType::iterator ;
         using timeKeeperType = typename Container<Key>::LFUAgingTimeKeeperType ;
+        using timeKeeperIterator = typename timeKeeperType::iterator ;
 
+        /*
+         * Maximal number of stale entries, that are aged by a single policy call.
+         */
+        static const std::size_t _agingBatch = 16;
+
+        recencyType _recency;
         timeKeeperType _timeKeeper ;
-        time_t _oldestEntry;
         time_t age;
+
+        void track(const Key& _k, time_t _now) {
+            _recency.push_back(std::pair<Key,time_t>(_k,_now));
+            _timeKeeper.insert(std::pair<Key,recencyIterator>(_k,--_recency.end()));
+        }
     public:
         _policy_lfuaging_type<Age,Key,Container>& operator= ( const _policy_lfuaging_type<Age,Key,Container>& x) throw() {
             _policy_lfu_type<Key,Container>::operator=(x);
-            this->_timeKeeper=x._timeKeeper;
-            this->_oldestEntry=x._oldestEntry;
+            this->_recency=x._recency;
+            this->_timeKeeper.clear();
+            for (recencyIterator it=_recency.begin();it!=_recency.end();++it) {
+                this->_timeKeeper.insert(std::pair<Key,recencyIterator>(it->first,it));
+            }
             this->age=x.age;
             return *this;
         }
@@ -36,94 +51,123 @@ namespace stlcache {
         }
         _policy_lfuaging_type(const size_t& size ) throw() : _policy_lfu_type<Key,Container>(size) {
             this->age=Age;
-            this->_oldestEntry=time(NULL);
         }
 
         virtual void insert(const Key& _k) throw(exception_invalid_key) {
+            time_t now=time(NULL);
+            this->expire(now);
             _policy_lfu_type<Key,Container>::insert(_k);
-            _timeKeeper.insert(std::pair<Key,time_t>(_k,time(NULL))); //Because touch always increases the refcount, so it couldn't be 1 after touch
+            this->track(_k,now);
         }
         virtual void remove(const Key& _k) throw() {
             _policy_lfu_type<Key,Container>::remove(_k);
-            _timeKeeper.erase(_k);
+            timeKeeperIterator it=_timeKeeper.find(_k);
+            if (it!=_timeKeeper.end()) {
+                _recency.erase(it->second);
+                _timeKeeper.erase(it);
+            }
         }
         virtual void touch(const Key& _k) throw() { 
+            time_t now=time(NULL);
+            this->expire(now);
             _policy_lfu_type<Key,Container>::touch(_k);
-            _timeKeeper.erase(_k);
-            _timeKeeper.insert(std::pair<Key,time_t>(_k,time(NULL))); //Because touch always increases the refcount, so it couldn't be 1 after touch
+            timeKeeperIterator it=_timeKeeper.find(_k);
+            if (it!=_timeKeeper.end()) {
+                it->second->second=now;
+                _recency.splice(_recency.end(),_recency,it->second);
+            } else if (this->_backEntries.find(_k)!=this->_backEntries.end()) {
+                this->track(_k,now); //Was aged down to the minimal reference count and untracked
+            }
         }   
         virtual void clear() throw() {
             _policy_lfu_type<Key,Container>::clear();
+            _recency.clear();
             _timeKeeper.clear();
         }
         virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
             try {
-                _policy_lfuaging_type<Age,Key,Container>& _pn=dynamic_cast<_policy_lfuaging_type<Age,Key,Container>& >(_p);
-                _timeKeeper.swap(_pn._timeKeeper);
-
-                time_t _oldest=this->_oldestEntry;
-                this->_oldestEntry=_pn._oldestEntry;
-                _pn._oldestEntry=_oldest;
-
-                time_t a = this->age;
-                this->age=_pn.age;
-                _pn.age=a;
-
-                _policy_lfu_type<Key,Container>::swap(_pn);
+                this->swap(dynamic_cast<_policy_lfuaging_type<Age,Key,Container>& >(_p));
             } catch (const std::bad_cast& ) {
                 throw exception_invalid_policy("Attempted to swap incompatible policies");
             }
         }
+        void swap(_policy_lfuaging_type<Age,Key,Container>& _p) throw() {
+            _recency.swap(_p._recency);
+            _timeKeeper.swap(_p._timeKeeper);
+
+            time_t a = this->age;
+            this->age=_p.age;
+            _p.age=a;
+
+            _policy_lfu_type<Key,Container>::swap(static_cast<_policy_lfu_type<Key,Container>&>(_p));
+        }
         virtual const _victim<Key> victim() throw()  {
 			this->expire();
             return _policy_lfu_type<Key,Container>::victim();
         }
 	protected:
+        /*
+         * Before a victim is selected, stale entries are aged past the batch, until the least used entries have the minimal reference
+         * count. Any stale entry left after that may only go to the back of that bucket, so it can't change the victim.
+         */
 		virtual void expire() {
-            if ((_oldestEntry+age)<time(NULL)) {
-                std::list<Key,keyAllocator> toErase;
-                std::list<Key,keyAllocator> toInsert;
-
-                //Time to clean up
-                this->_oldestEntry=time(NULL);
-                using timeMapIterator = typename Container<Key>::LFUAgingTimeKeeperType::iterator ;
-                for (timeMapIterator it=_timeKeeper.begin();it!=_timeKeeper.end();++it) {
-                    if ((*it).second+age<time(NULL)) {
-                        //Too old :(
-                        Key itCopy=(*it).first;
-                        unsigned long long currentRef=this->untouch((*it).first);
-                        toErase.push_front(itCopy);
-                        
-                        if (currentRef>1) {
-                            toInsert.push_front(itCopy);
-                        }
-                    } else {
-                        if ((*it).second<this->_oldestEntry) {
-                            this->_oldestEntry=(*it).second;
-                        }
-                    }
-                }
-
-                //Delete entries
-                typedef typename std::list<Key,keyAllocator>::iterator listIterator;
-                for(listIterator it=toErase.begin();it!=toErase.end();++it) {
-                    _timeKeeper.erase(*it);
-                }
-                for(listIterator it=toInsert.begin();it!=toInsert.end();++it) {
-                    _timeKeeper.insert(std::pair<Key,time_t>(*it,time(NULL)));
-                }
+            time_t now=time(NULL);
+            this->expire(now);
+            while (!this->entries().empty() && this->entries().begin()->first>1 && this->ageOldest(now)) {
+            }
+        }
+
+        /*
+         * Entries are kept in the order of their last touch (or aging), so the stale ones are always at the front. Every stale entry
+         * loses one reference and goes to the back, until it reaches the minimal reference count. Only a bounded batch is aged
+         * per call, so the cost of a policy call doesn't depend on the number of entries.
+         */
+		void expire(time_t _now) {
+            for (std::size_t processed=0;processed<_agingBatch && this->ageOldest(_now);processed++) {
             }
 		}
+
+        bool ageOldest(time_t _now) {
+            if (_recency.empty() || !(_recency.begin()->second+age<_now)) {
+                return false;
+            }
+            recencyIterator oldest=_recency.begin();
+            if (this->untouch(oldest->first)>1) {
+                oldest->second=_now;
+                _recency.splice(_recency.end(),_recency,oldest);
+            } else {
+                _timeKeeper.erase(oldest->first);
+                _recency.erase(oldest);
+            }
+            return true;
+        }
     };
 
     template <class Key>
     struct lfuaging_default_container : public lfu_default_container<Key>
     {
-    	using LFUAgingKeySetAllocator = std::allocator<Key> ;
-    	using LFUAgingKeySetType = std::set<Key, std::less<Key>, LFUAgingKeySetAllocator> ;
+    	using LFUAgingRecencyAllocator = std::allocator<std::pair<Key, time_t>> ;
+    	using LFUAgingRecencyType = std::list<std::pair<Key, time_t>, LFUAgingRecencyAllocator> ;
 
-    	using LFUAgingTimeKeeperAllocator = std::allocator<std::pair<const Key, time_t>> ;
-    	using LFUAgingTimeKeeperType = std::map<Key, time_t, std::less<Key>, LFUAgingTimeKeeperAllocator> ;
+    	using LFUAgingTimeKeeperAllocator = std::allocator<std::pair<const Key, typename LFUAgingRecencyType::iterator>> ;
+    	using LFUAgingTimeKeeperType = std::map<Key, typename LFUAgingRecencyType::iterator, std::less<Key>, LFUAgingTimeKeeperAllocator> ;
+    } ;
+
+    /*
+     * The default LFU-Aging container with the nodes allocated by the cache allocation model.
+     */
+    template <class Allocator>
+    struct lfuaging_allocator_container
+    {
+        template <class Key>
+        struct bind : public lfu_allocator_container<Allocator>::template bind<Key>
+        {
+            using LFUAgingRecencyAllocator = typename Allocator::template bind<std::pair<Key, time_t>> ;
+            using LFUAgingRecencyType = std::list<std::pair<Key, time_t>, LFUAgingRecencyAllocator> ;
+
+            using LFUAgingTimeKeeperAllocator = typename Allocator::template bind<std::pair<const Key, typename LFUAgingRecencyType::iterator>> ;
+            using LFUAgingTimeKeeperType = std::map<Key, typename LFUAgingRecencyType::iterator, std::less<Key>, LFUAgingTimeKeeperAllocator> ;
+        } ;
     } ;
 
     /*!
@@ -142,6 +186,9 @@ namespace stlcache {
      *  
      * \link cache::touch Touching \endlink the entry may not change item's expiration probability. This policy is always able to expire any amount of entries. 
      *  
+     * Entries are aged lazily, in the order of their last access: every policy call ages at most a small fixed number of stale entries, 
+     * so there are no stalls, even when the whole cache becomes stale at once. 
+     *  
      * The policy must be configured with the length of a aging interval: 
      *  
      * \tparam <Age>  aging interval in seconds
@@ -151,10 +198,17 @@ namespace stlcache {
      */
     template <time_t Age> struct policy_lfuaging {
         template <typename Key>
-            struct bind : _policy_lfuaging_type<Age,Key,lfuaging_default_container> {
+            struct bind final : _policy_lfuaging_type<Age,Key,lfuaging_default_container> {
                 bind(const bind& x) : _policy_lfuaging_type<Age,Key,lfuaging_default_container>(x),_policy_lfu_type<Key,lfuaging_default_container>(x)  { }
+                bind& operator= (const bind& x) = default;
                 bind(const size_t& size) : _policy_lfuaging_type<Age,Key,lfuaging_default_container>(size),_policy_lfu_type<Key,lfuaging_default_container>(size) { }
             };
+        template <typename Key, class Allocator>
+            struct allocator_bind final : _policy_lfuaging_type<Age,Key,lfuaging_allocator_container<Allocator>::template bind> {
+                allocator_bind(const allocator_bind& x) : _policy_lfuaging_type<Age,Key,lfuaging_allocator_container<Allocator>::template bind>(x),_policy_lfu_type<Key,lfuaging_allocator_container<Allocator>::template bind>(x)  { }
+                allocator_bind& operator= (const allocator_bind& x) = default;
+                allocator_bind(const size_t& size) : _policy_lfuaging_type<Age,Key,lfuaging_allocator_container<Allocator>::template bind>(size),_policy_lfu_type<Key,lfuaging_allocator_container<Allocator>::template bind>(size) { }
+            };
     };
 }
 
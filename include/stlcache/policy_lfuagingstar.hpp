@@ -64,8 +64,9 @@ namespace stlcache {
      */
     template <time_t Age> struct policy_lfuagingstar {
         template <typename Key>
-            struct bind : _policy_lfuagingstar_type<Age,Key,lfuagingstar_default_container> {
+            struct bind final : _policy_lfuagingstar_type<Age,Key,lfuagingstar_default_container> {
                 bind(const bind& x) : _policy_lfuagingstar_type<Age,Key,lfuagingstar_default_container>(x),_policy_lfuaging_type<Age,Key,lfuagingstar_default_container>(x),_policy_lfustar_type<Key,lfuagingstar_default_container>(x),_policy_lfu_type<Key,lfuagingstar_default_container>(x)  { }
+                bind& operator= (const bind& x) = default;
                 bind(const size_t& size) : _policy_lfuagingstar_type<Age,Key,lfuagingstar_default_container>(size),_policy_lfuaging_type<Age,Key,lfuagingstar_default_container>(size),_policy_lfustar_type<Key,lfuagingstar_default_container>(size),_policy_lfu_type<Key,lfuagingstar_default_container>(size)  { }
             };
     };
@@ -66,8 +66,9 @@ namespace stlcache {
      */
     struct policy_lfustar {
         template <typename Key>
-            struct bind : _policy_lfustar_type<Key, lfustar_default_container> {
+            struct bind final : _policy_lfustar_type<Key, lfustar_default_container> {
                 bind(const bind& x) : _policy_lfustar_type<Key,lfustar_default_container>(x),_policy_lfu_type<Key,lfustar_default_container>(x)  { }
+                bind& operator= (const bind& x) = default;
                 bind(const size_t& size) : _policy_lfustar_type<Key,lfustar_default_container>(size),_policy_lfu_type<Key,lfustar_default_container>(size) { }
             };
     };
@@ -0,0 +1,326 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_POLICY_LIRS_HPP_INCLUDED
+#define STLCACHE_POLICY_LIRS_HPP_INCLUDED
+
+#include <iterator>
+#include <list>
+#include <map>
+
+#include <stlcache/policy.hpp>
+
+namespace stlcache {
+    /*
+     * Index entry of the LIRS policy: the entry status, it's position in the recency stack, if it is there, and it's position in the
+     * resident HIR queue or in the non-resident list.
+     */
+    template <class Iterator>
+    struct _lirs_entry {
+        unsigned char status;
+        bool stacked;
+        Iterator stackPosition;
+        Iterator queuePosition;
+    };
+
+    template <class Key, template <typename T> class Container>
+    class _policy_lirs_type : public policy<Key> {
+        using entriesType = typename Container<Key>::entriesType ;
+        using entriesIterator = typename entriesType::iterator ;
+        using entriesMap = typename Container<Key>::entriesMap ;
+        using entriesMapIterator = typename entriesMap::iterator ;
+        using entry = _lirs_entry<entriesIterator> ;
+
+        /*
+         * LIR entries have a short reuse distance and are never expired directly. Resident HIR entries are the expiration candidates.
+         * Non-resident HIR entries are already expired, but still remembered by the stack, so they are recognized, when they come back.
+         */
+        enum { _lir=0, _hir=1, _nonresident=2 };
+
+        std::size_t _lirSize;
+        std::size_t _ghostSize;
+        std::size_t _lirCount;
+        entriesType _stack;
+        entriesType _queue;
+        entriesType _ghosts;
+        entriesMap _entriesMap;
+
+        void push(entriesMapIterator _it) {
+            if (_it->second.stacked) {
+                _stack.splice(_stack.begin(),_stack,_it->second.stackPosition);
+            } else {
+                _it->second.stackPosition=_stack.insert(_stack.begin(),_it->first);
+                _it->second.stacked=true;
+            }
+        }
+
+        /*
+         * Removes HIR entries from the bottom of the stack, until the bottom one is LIR. Non-resident entries, that leave the stack,
+         * are forgotten.
+         */
+        void prune() throw() {
+            while (!_stack.empty()) {
+                entriesMapIterator it=_entriesMap.find(_stack.back());
+                if (it->second.status==_lir) {
+                    return;
+                }
+                _stack.pop_back();
+                it->second.stacked=false;
+                if (it->second.status==_nonresident) {
+                    _ghosts.erase(it->second.queuePosition);
+                    _entriesMap.erase(it);
+                }
+            }
+        }
+
+        /*
+         * Turns the LIR entry at the bottom of the stack into a resident HIR one.
+         */
+        void demote() {
+            entriesMapIterator it=_entriesMap.find(_stack.back());
+            it->second.queuePosition=_queue.insert(_queue.begin(),it->first);
+            it->second.status=_hir;
+            _stack.pop_back();
+            it->second.stacked=false;
+            _lirCount--;
+            this->prune();
+        }
+
+        void forget(entriesMapIterator _it) throw() {
+            if (_it->second.stacked) {
+                _stack.erase(_it->second.stackPosition);
+            }
+            _ghosts.erase(_it->second.queuePosition);
+            _entriesMap.erase(_it);
+        }
+    public:
+        _policy_lirs_type<Key,Container>& operator= ( const _policy_lirs_type<Key,Container>& x) throw() {
+            if (this==&x) {
+                return *this;
+            }
+            _lirSize=x._lirSize;
+            _ghostSize=x._ghostSize;
+            _lirCount=x._lirCount;
+            _stack=x._stack;
+            _queue=x._queue;
+            _ghosts=x._ghosts;
+
+            _entriesMap.clear();
+            for (entriesIterator it=_stack.begin();it!=_stack.end();++it) {
+                entry e={x._entriesMap.find(*it)->second.status,true,it,_queue.end()};
+                _entriesMap.insert(std::make_pair(*it,e));
+            }
+            entriesType* lists[2]={&_queue,&_ghosts};
+            for (unsigned int list=0;list<2;list++) {
+                for (entriesIterator it=lists[list]->begin();it!=lists[list]->end();++it) {
+                    entriesMapIterator mapIter=_entriesMap.find(*it);
+                    if (mapIter==_entriesMap.end()) {
+                        entry e={static_cast<unsigned char>(_hir),false,_stack.end(),it};
+                        _entriesMap.insert(std::make_pair(*it,e));
+                    } else {
+                        mapIter->second.queuePosition=it;
+                    }
+                }
+            }
+            return *this;
+        }
+        _policy_lirs_type(const _policy_lirs_type<Key,Container>& x) throw() {
+            *this=x;
+        }
+        /*
+         * 1% of the cache is reserved for the resident HIR entries, the rest is for the LIR ones. Up to the cache size of non-resident
+         * entries is remembered.
+         */
+        _policy_lirs_type(const size_t& size ) throw() : _lirSize(0), _ghostSize(size<1 ? 1 : size), _lirCount(0) {
+            std::size_t hirSize=size/100<1 ? 1 : size/100;
+            _lirSize=size>hirSize ? size-hirSize : 1;
+        }
+
+        /*
+         * A new entry is LIR, while there are not enough LIR entries, and resident HIR otherwise. A non-resident entry, that comes back,
+         * has proven it's short reuse distance and becomes LIR, replacing the least recent LIR entry.
+         */
+        virtual void insert(const Key& _k) throw(exception_invalid_key) {
+            entriesMapIterator it=_entriesMap.find(_k);
+            if (it!=_entriesMap.end()) {
+                if (it->second.status!=_nonresident) {
+                    return;
+                }
+                _ghosts.erase(it->second.queuePosition);
+                it->second.status=_lir;
+                _lirCount++;
+                this->push(it);
+                if (_lirCount>_lirSize) {
+                    this->demote();
+                }
+                return;
+            }
+
+            entry e={static_cast<unsigned char>(_lirCount<_lirSize ? _lir : _hir),true,_stack.end(),_queue.end()};
+            e.stackPosition=_stack.insert(_stack.begin(),_k);
+            try {
+                if (e.status==_hir) {
+                    e.queuePosition=_queue.insert(_queue.begin(),_k);
+                }
+                try {
+                    _entriesMap.insert(std::make_pair(_k,e));
+                } catch (...) {
+                    if (e.status==_hir) {
+                        _queue.erase(e.queuePosition);
+                    }
+                    throw;
+                }
+            } catch (...) {
+                _stack.erase(e.stackPosition);
+                throw;
+            }
+            if (e.status==_lir) {
+                _lirCount++;
+            }
+        }
+
+        /*
+         * A removed HIR entry stays in the stack as non-resident one, a removed LIR entry is forgotten.
+         */
+        virtual void remove(const Key& _k) throw() {
+            entriesMapIterator it=_entriesMap.find(_k);
+            if (it==_entriesMap.end() || it->second.status==_nonresident) {
+                return;
+            }
+            if (it->second.status==_lir) {
+                _stack.erase(it->second.stackPosition);
+                _entriesMap.erase(it);
+                _lirCount--;
+                this->prune();
+                return;
+            }
+            _queue.erase(it->second.queuePosition);
+            if (!it->second.stacked) {
+                _entriesMap.erase(it);
+                return;
+            }
+            try {
+                it->second.queuePosition=_ghosts.insert(_ghosts.begin(),_k);
+                it->second.status=_nonresident;
+            } catch (...) {
+                _stack.erase(it->second.stackPosition);
+                _entriesMap.erase(it);
+                return;
+            }
+            if (_ghosts.size()>_ghostSize) {
+                this->forget(_entriesMap.find(_ghosts.back()));
+            }
+        }
+
+        /*
+         * A LIR entry just moves to the top of the stack. A resident HIR entry, that is still in the stack, was reused sooner, than
+         * the least recent LIR entry, so they swap their statuses.
+         */
+        virtual void touch(const Key& _k) throw() {
+            entriesMapIterator it=_entriesMap.find(_k);
+            if (it==_entriesMap.end() || it->second.status==_nonresident) {
+                return;
+            }
+            try {
+                if (it->second.status==_lir) {
+                    bool bottom=it->second.stackPosition==std::prev(_stack.end());
+                    this->push(it);
+                    if (bottom) {
+                        this->prune();
+                    }
+                } else if (it->second.stacked) {
+                    this->push(it);
+                    _queue.erase(it->second.queuePosition);
+                    it->second.status=_lir;
+                    _lirCount++;
+                    if (_lirCount>_lirSize) {
+                        this->demote();
+                    }
+                } else {
+                    this->push(it);
+                    _queue.splice(_queue.begin(),_queue,it->second.queuePosition);
+                }
+            } catch (...) {
+            }
+        }
+        virtual void clear() throw() {
+            _stack.clear();
+            _queue.clear();
+            _ghosts.clear();
+            _entriesMap.clear();
+            _lirCount=0;
+        }
+        virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
+            try {
+                this->swap(dynamic_cast<_policy_lirs_type<Key,Container>& >(_p));
+            } catch (const std::bad_cast& ) {
+                throw exception_invalid_policy("Attempted to swap incompatible policies");
+            }
+        }
+        void swap(_policy_lirs_type<Key,Container>& _p) throw() {
+            std::swap(_lirSize,_p._lirSize);
+            std::swap(_ghostSize,_p._ghostSize);
+            std::swap(_lirCount,_p._lirCount);
+            _stack.swap(_p._stack);
+            _queue.swap(_p._queue);
+            _ghosts.swap(_p._ghosts);
+            _entriesMap.swap(_p._entriesMap);
+        }
+
+        /*
+         * Expires the oldest resident HIR entry. When there are none, the least recent LIR entry is expired.
+         */
+        virtual const _victim<Key> victim() throw()  {
+            if (!_queue.empty()) {
+                return _victim<Key>(_queue.back());
+            }
+            if (!_stack.empty()) {
+                return _victim<Key>(_stack.back());
+            }
+            return _victim<Key>();
+        }
+    };
+
+    template <class Key>
+    struct lirs_default_container
+    {
+        using entriesAllocator = std::allocator<Key> ;
+        using entriesType = std::list<Key, entriesAllocator> ;
+        using entriesIterator = typename entriesType::iterator ;
+
+        using entriesMapAllocator = std::allocator<std::pair<const Key, _lirs_entry<entriesIterator> > > ;
+        using entriesMap = std::map<Key, _lirs_entry<entriesIterator>, std::less<Key>, entriesMapAllocator> ;
+    } ;
+
+    /*!
+     * \brief A 'Low Inter-reference Recency Set' policy
+     *
+     * Implements the <a href="http://en.wikipedia.org/wiki/LIRS_caching_algorithm">LIRS</a> cache algorithm. Instead of the time since the
+     * last use, like the \link stlcache::policy_lru LRU \endlink does, it looks at the time between the last two uses of the entry.
+     *
+     * The entries, that were reused quickly, are LIR entries and take 99% of the cache. They are never expired, while they are reused quickly.
+     * The rest of the cache holds HIR entries, that are expired in the FIFO order. A recency stack remembers the recent accesses, including
+     * the accesses to the already expired HIR entries, and when an HIR entry is reused sooner, than the least recent LIR entry, they swap.
+     * So a loop over a set, that is slightly larger, than the cache, or a scan keep hitting the LIR part, instead of flushing the whole cache.
+     *
+     * \link cache::touch Touching \endlink the entry decreases item's expiration probability. This policy is always able to expire any amount
+     * of entries. The policy remembers up to the cache size of expired keys, so the cache size should be a realistic entry count.
+     *
+     * \see policy_lru
+     * \see policy_adaptive
+     */
+    struct policy_lirs {
+        template <typename Key>
+            struct bind final : _policy_lirs_type<Key,lirs_default_container> {
+                bind(const bind& x) : _policy_lirs_type<Key,lirs_default_container>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_lirs_type<Key,lirs_default_container>(size) { }
+            };
+    };
+}
+
+#endif /* STLCACHE_POLICY_LIRS_HPP_INCLUDED */
@@ -8,11 +8,32 @@
 #ifndef STLCACHE_POLICY_LRU_HPP_INCLUDED
 #define STLCACHE_POLICY_LRU_HPP_INCLUDED
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <stdexcept>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include <stlcache/allocator.hpp>
 #include <stlcache/policy.hpp>
+#include <stlcache/container_flat_hash_map.hpp>
 
 namespace stlcache {
+    /*
+     * Calls the reserve hook of the LRU container, if there is one.
+     */
+    template <class Container, class List, class Map>
+    auto _lru_reserve(List& _entries, Map& _map, std::size_t _size, int) -> decltype(Container::reserve(_entries,_map,_size)) {
+        return Container::reserve(_entries,_map,_size);
+    }
+    template <class Container, class List, class Map>
+    void _lru_reserve(List&, Map&, std::size_t, long) {
+    }
+
     template <class Key, template <typename T> class Container>
     class _policy_lru_type : public policy<Key> {
         using entriesList = typename Container<Key>::entriesType ;
@@ -25,12 +46,18 @@ namespace stlcache {
     public:
         _policy_lru_type<Key,Container>& operator= ( const _policy_lru_type<Key,Container>& x) throw() {
             this->_entries=x._entries;
+            this->_entriesMap.clear();
+            for (entriesIterator it=_entries.begin();it!=_entries.end();++it) {
+                _entriesMap.insert(std::pair<Key,entriesIterator>(*it,it));
+            }
             return *this;
         }
         _policy_lru_type(const _policy_lru_type<Key,Container>& x) throw() {
             *this=x;
         }
-        _policy_lru_type(const size_t& size ) throw() { }
+        _policy_lru_type(const size_t& size ) throw() {
+            _lru_reserve<Container<Key> >(_entries,_entriesMap,size,0);
+        }
 
         virtual void insert(const Key& _k) throw(exception_invalid_key) {
             entriesIterator entryIter = _entries.insert(_entries.begin(),_k);
@@ -49,22 +76,23 @@ namespace stlcache {
             if (mapIter==_entriesMap.end()) {
                 return;
             }
-            _entries.erase(mapIter->second);
-            entriesIterator entryIter = _entries.insert(_entries.begin(),_k);
-            mapIter->second=entryIter;
+            _entries.splice(_entries.begin(),_entries,mapIter->second);
         }
         virtual void clear() throw() {
             _entries.clear();
+            _entriesMap.clear();
         }
         virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
             try {
-                _policy_lru_type<Key,Container>& _pn=dynamic_cast<_policy_lru_type<Key,Container>& >(_p);
-                _entries.swap(_pn._entries);
-                _entriesMap.swap(_pn._entriesMap);
+                this->swap(dynamic_cast<_policy_lru_type<Key,Container>& >(_p));
             } catch (const std::bad_cast& ) {
                 throw exception_invalid_policy("Attempted to swap incompatible policies");
             }
         }
+        void swap(_policy_lru_type<Key,Container>& _p) throw() {
+            _entries.swap(_p._entries);
+            _entriesMap.swap(_p._entriesMap);
+        }
 
         virtual const _victim<Key> victim() throw()  {
             return _victim<Key>(_entries.back());
@@ -74,6 +102,81 @@ namespace stlcache {
         const entriesList& entries() const  { return this->_entries; }
     };
 
+    /*
+     * Intrusive flavour of the LRU policy, used by the intrusive_cache. The list links are kept in a hook, that lives
+     * inside the storage node together with the key and the value, so the policy does not own any memory and
+     * all operations are just a pointer relink.
+     */
+    template <class Key>
+    class _intrusive_lru_type {
+    public:
+        struct hook_type {
+            hook_type* prev;
+            hook_type* next;
+            const Key* key;
+
+            hook_type() throw() : prev(nullptr), next(nullptr), key(nullptr) { }
+        };
+    protected:
+        hook_type* _head; //Most recently used entry
+        hook_type* _tail; //Least recently used entry
+
+        void unlink(hook_type& _h) throw() {
+            if (_h.prev) {
+                _h.prev->next=_h.next;
+            } else {
+                _head=_h.next;
+            }
+            if (_h.next) {
+                _h.next->prev=_h.prev;
+            } else {
+                _tail=_h.prev;
+            }
+            _h.prev=nullptr;
+            _h.next=nullptr;
+        }
+        void link_front(hook_type& _h) throw() {
+            _h.prev=nullptr;
+            _h.next=_head;
+            if (_head) {
+                _head->prev=&_h;
+            } else {
+                _tail=&_h;
+            }
+            _head=&_h;
+        }
+    public:
+        _intrusive_lru_type(const size_t&) throw() : _head(nullptr), _tail(nullptr) { }
+        _intrusive_lru_type(const _intrusive_lru_type<Key>& x) = delete;
+        _intrusive_lru_type<Key>& operator= (const _intrusive_lru_type<Key>& x) = delete;
+
+        void insert(hook_type& _h, const Key& _k) throw() {
+            _h.key=&_k;
+            link_front(_h);
+        }
+        void remove(hook_type& _h) throw() {
+            unlink(_h);
+        }
+        void touch(hook_type& _h) throw() {
+            if (&_h==_head) {
+                return;
+            }
+            unlink(_h);
+            link_front(_h);
+        }
+        void clear() throw() {
+            _head=nullptr;
+            _tail=nullptr;
+        }
+        void swap(_intrusive_lru_type<Key>& _p) throw() {
+            std::swap(_head,_p._head);
+            std::swap(_tail,_p._tail);
+        }
+        hook_type* victim() throw() {
+            return _tail;
+        }
+    };
+
     template <class Key>
     struct lru_default_container
     {
@@ -86,6 +189,30 @@ namespace stlcache {
     	using entriesMapIterator = typename entriesMap::iterator ;
     } ;
 
+    /*
+     * The default LRU container with the nodes allocated by the cache allocation model.
+     */
+    template <class Allocator>
+    struct lru_allocator_container
+    {
+        template <class Key>
+        struct bind
+        {
+            using entriesAllocator = typename Allocator::template bind<Key> ;
+            using entriesType = std::list<Key, entriesAllocator> ;
+            using entriesIterator = typename entriesType::iterator ;
+
+            using entriesMapAllocator = typename Allocator::template bind<std::pair<const Key, entriesIterator>> ;
+            using entriesMap = std::map<Key, entriesIterator, std::less<Key>, entriesMapAllocator> ;
+            using entriesMapIterator = typename entriesMap::iterator ;
+
+            static void reserve(entriesType& _entries, entriesMap& _map, std::size_t _size) {
+                _allocator_reserve(_entries.get_allocator(),_size,0);
+                _allocator_reserve(_map.get_allocator(),_size,0);
+            }
+        } ;
+    } ;
+
     /*!
      * \brief A 'Least Recently Used' policy
      * 
@@ -98,10 +225,21 @@ namespace stlcache {
      */
     struct policy_lru {
         template <typename Key>
-            struct bind : _policy_lru_type<Key,lru_default_container> {
+            struct bind final : _policy_lru_type<Key,lru_default_container> {
                 bind(const bind& x) : _policy_lru_type<Key,lru_default_container>(x)  { }
+                bind& operator= (const bind& x) = default;
                 bind(const size_t& size) : _policy_lru_type<Key,lru_default_container>(size) { }
             };
+        template <typename Key, class Allocator>
+            struct allocator_bind final : _policy_lru_type<Key,lru_allocator_container<Allocator>::template bind> {
+                allocator_bind(const allocator_bind& x) : _policy_lru_type<Key,lru_allocator_container<Allocator>::template bind>(x)  { }
+                allocator_bind& operator= (const allocator_bind& x) = default;
+                allocator_bind(const size_t& size) : _policy_lru_type<Key,lru_allocator_container<Allocator>::template bind>(size) { }
+            };
+        template <typename Key>
+            struct intrusive_bind final : _intrusive_lru_type<Key> {
+                intrusive_bind(const size_t& size) : _intrusive_lru_type<Key>(size) { }
+            };
     };
 
     template <class Key>
@@ -118,11 +256,361 @@ namespace stlcache {
 
     struct policy_unordered_lru {
         template <typename Key>
-            struct bind : _policy_lru_type<Key,lru_unordered_map_container> {
+            struct bind final : _policy_lru_type<Key,lru_unordered_map_container> {
                 bind(const bind& x) : _policy_lru_type<Key,lru_unordered_map_container>(x)  { }
+                bind& operator= (const bind& x) = default;
                 bind(const size_t& size) : _policy_lru_type<Key,lru_unordered_map_container>(size) { }
             };
     };
+
+    /*
+     * Doubly linked list of keys, that keeps the nodes in a single vector and links them by 32 bit indices. Erased nodes are
+     * put on a free list and reused, so the list doesn't allocate, once it has grown to the cache size. Insertion, erasure and
+     * splice only look at the position of an iterator, so iterators survive the swap() like the std::list ones do.
+     */
+    template <class Key>
+    class _indexed_list {
+    public:
+        using index_type = std::uint32_t ;
+        static const index_type nil = ~index_type(0);
+    private:
+        struct node_type {
+            Key key;
+            index_type prev;
+            index_type next;
+
+            node_type(const Key& _k, index_type _prev, index_type _next) : key(_k), prev(_prev), next(_next) { }
+        };
+
+        std::vector<node_type> _nodes;
+        index_type _head;
+        index_type _tail;
+        index_type _free;
+        std::size_t _size;
+
+        void link(index_type _indx, index_type _next) throw() {
+            index_type prev=_next==nil ? _tail : _nodes[_next].prev;
+            _nodes[_indx].prev=prev;
+            _nodes[_indx].next=_next;
+            if (prev==nil) {
+                _head=_indx;
+            } else {
+                _nodes[prev].next=_indx;
+            }
+            if (_next==nil) {
+                _tail=_indx;
+            } else {
+                _nodes[_next].prev=_indx;
+            }
+        }
+        void unlink(index_type _indx) throw() {
+            node_type& n=_nodes[_indx];
+            if (n.prev==nil) {
+                _head=n.next;
+            } else {
+                _nodes[n.prev].next=n.next;
+            }
+            if (n.next==nil) {
+                _tail=n.prev;
+            } else {
+                _nodes[n.next].prev=n.prev;
+            }
+        }
+    public:
+        class iterator {
+            friend class _indexed_list<Key>;
+
+            const _indexed_list<Key>* _list;
+            index_type _indx;
+
+            iterator(const _indexed_list<Key>* _l, index_type _i) throw() : _list(_l), _indx(_i) { }
+        public:
+            using iterator_category = std::bidirectional_iterator_tag ;
+            using value_type = Key ;
+            using difference_type = std::ptrdiff_t ;
+            using pointer = const Key* ;
+            using reference = const Key& ;
+
+            iterator() throw() : _list(nullptr), _indx(nil) { }
+
+            reference operator*() const throw() {
+                return _list->_nodes[_indx].key;
+            }
+            pointer operator->() const throw() {
+                return &_list->_nodes[_indx].key;
+            }
+            iterator& operator++() throw() {
+                _indx=_list->_nodes[_indx].next;
+                return *this;
+            }
+            iterator operator++(int) throw() {
+                iterator result(*this);
+                ++(*this);
+                return result;
+            }
+            iterator& operator--() throw() {
+                _indx=_indx==nil ? _list->_tail : _list->_nodes[_indx].prev;
+                return *this;
+            }
+            iterator operator--(int) throw() {
+                iterator result(*this);
+                --(*this);
+                return result;
+            }
+            bool operator==(const iterator& x) const throw() {
+                return _indx==x._indx;
+            }
+            bool operator!=(const iterator& x) const throw() {
+                return _indx!=x._indx;
+            }
+        };
+        using const_iterator = iterator ;
+
+        _indexed_list() : _nodes(), _head(nil), _tail(nil), _free(nil), _size(0) { }
+
+        iterator begin() const throw() {
+            return iterator(this,_head);
+        }
+        iterator end() const throw() {
+            return iterator(this,nil);
+        }
+        const Key& front() const throw() {
+            return _nodes[_head].key;
+        }
+        const Key& back() const throw() {
+            return _nodes[_tail].key;
+        }
+        bool empty() const throw() {
+            return _size==0;
+        }
+        std::size_t size() const throw() {
+            return _size;
+        }
+        static std::size_t max_size() throw() {
+            return nil;
+        }
+        void reserve(std::size_t _n) {
+            _nodes.reserve(_n);
+        }
+
+        iterator insert(iterator _pos, const Key& _k) {
+            index_type indx=_free;
+            if (indx!=nil) {
+                _nodes[indx].key=_k;
+                _free=_nodes[indx].next;
+            } else {
+                if (_nodes.size()>=max_size()) {
+                    throw std::length_error("Too many entries for the indexed list");
+                }
+                _nodes.push_back(node_type(_k,nil,nil));
+                indx=static_cast<index_type>(_nodes.size()-1);
+            }
+            this->link(indx,_pos._indx);
+            _size++;
+            return iterator(this,indx);
+        }
+        iterator erase(iterator _pos) throw() {
+            index_type next=_nodes[_pos._indx].next;
+            this->unlink(_pos._indx);
+            _nodes[_pos._indx].next=_free;
+            _free=_pos._indx;
+            _size--;
+            return iterator(this,next);
+        }
+        /*
+         * Moves the _it node before the _pos one. Only splicing within the same list is supported.
+         */
+        void splice(iterator _pos, _indexed_list<Key>&, iterator _it) throw() {
+            if (_pos._indx==_it._indx) {
+                return;
+            }
+            this->unlink(_it._indx);
+            this->link(_it._indx,_pos._indx);
+        }
+
+        void clear() throw() {
+            _nodes.clear();
+            _head=nil;
+            _tail=nil;
+            _free=nil;
+            _size=0;
+        }
+        void swap(_indexed_list<Key>& x) throw() {
+            _nodes.swap(x._nodes);
+            std::swap(_head,x._head);
+            std::swap(_tail,x._tail);
+            std::swap(_free,x._free);
+            std::swap(_size,x._size);
+        }
+    };
+
+    template <class Key>
+    struct lru_indexed_container
+    {
+        using entriesType = _indexed_list<Key> ;
+        using entriesIterator = typename entriesType::iterator ;
+
+        using entriesMap = _flat_hash_map<Key, entriesIterator> ;
+        using entriesMapIterator = typename entriesMap::iterator ;
+
+        /*
+         * Both the list and the index are allocated for the whole cache up front, unless the size is too large to be a real bound.
+         */
+        static void reserve(entriesType& _entries, entriesMap& _map, std::size_t _size) {
+            if (_size<entriesType::max_size()) {
+                _entries.reserve(_size);
+                _map.reserve(_size);
+            }
+        }
+    } ;
+
+    /*!
+     * \brief A 'Least Recently Used' policy without allocations
+     *
+     * Same as the \link stlcache::policy_lru policy_lru \endlink, but the recency list lives in a single array, linked by 32 bit indices,
+     * and keys are indexed by the \link stlcache::container_flat_hash_map flat hash map \endlink. Both are allocated for the cache size,
+     * when the cache is constructed, so touching the entry and selecting a victim are O(1) and never allocate. The key must be hashable
+     * and the cache size must be below 2^32.
+     */
+    struct policy_indexed_lru {
+        template <typename Key>
+            struct bind final : _policy_lru_type<Key,lru_indexed_container> {
+                bind(const bind& x) : _policy_lru_type<Key,lru_indexed_container>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_lru_type<Key,lru_indexed_container>(size) { }
+            };
+    };
+
+    /*
+     * A few LRU segments, that share a single index. The index maps the key to the number of it's segment and it's position there,
+     * so finding the entry and moving it to another segment are O(1). Every segment is ordered from the most recently used entry.
+     * The segmented policies are built of it.
+     */
+    template <class Key, template <typename T> class Container, unsigned int Segments>
+    class _lru_segments {
+    public:
+        using entriesType = typename Container<Key>::entriesType ;
+        using entriesIterator = typename entriesType::iterator ;
+        using entriesMap = typename Container<Key>::entriesMap ;
+        using entriesMapIterator = typename entriesMap::iterator ;
+    private:
+        static const std::size_t _maxReserved = std::size_t(1)<<24;
+
+        entriesType _entries[Segments];
+        entriesMap _entriesMap;
+    public:
+        _lru_segments() : _entries(), _entriesMap() { }
+        _lru_segments(const _lru_segments<Key,Container,Segments>& x) : _entries(), _entriesMap() {
+            *this=x;
+        }
+        _lru_segments<Key,Container,Segments>& operator= ( const _lru_segments<Key,Container,Segments>& x) {
+            if (this==&x) {
+                return *this;
+            }
+            _entriesMap.clear();
+            for (unsigned int segment=0;segment<Segments;segment++) {
+                _entries[segment]=x._entries[segment];
+                for (entriesIterator it=_entries[segment].begin();it!=_entries[segment].end();++it) {
+                    _entriesMap.insert(std::make_pair(*it,std::make_pair(segment,it)));
+                }
+            }
+            return *this;
+        }
+
+        /*
+         * Allocates every segment for it's share of the cache and the index for _indexed keys, or for all the segments together,
+         * when the segments can't be full at the same time, unless the cache size is too large to be a real bound.
+         */
+        void reserve(const std::size_t (&_sizes)[Segments], std::size_t _indexed = 0) {
+            std::size_t total=0;
+            for (unsigned int segment=0;segment<Segments;segment++) {
+                if (_sizes[segment]>=_maxReserved) {
+                    return;
+                }
+                total+=_sizes[segment];
+            }
+            for (unsigned int segment=0;segment<Segments;segment++) {
+                _entries[segment].reserve(_sizes[segment]);
+            }
+            _entriesMap.reserve(_indexed ? _indexed : total);
+        }
+
+        entriesMapIterator find(const Key& _k) {
+            return _entriesMap.find(_k);
+        }
+        entriesMapIterator end() {
+            return _entriesMap.end();
+        }
+        static unsigned int segment(entriesMapIterator _it) throw() {
+            return _it->second.first;
+        }
+        bool empty(unsigned int _segment) const throw() {
+            return _entries[_segment].empty();
+        }
+        std::size_t size(unsigned int _segment) const throw() {
+            return _entries[_segment].size();
+        }
+        const Key& back(unsigned int _segment) const throw() {
+            return _entries[_segment].back();
+        }
+
+        void insert(const Key& _k, unsigned int _segment) {
+            entriesIterator it=_entries[_segment].insert(_entries[_segment].begin(),_k);
+            try {
+                _entriesMap.insert(std::make_pair(_k,std::make_pair(_segment,it)));
+            } catch (...) {
+                _entries[_segment].erase(it);
+                throw;
+            }
+        }
+        /*
+         * Moves the entry to the front of another segment.
+         */
+        void move(entriesMapIterator _it, unsigned int _segment) {
+            entriesIterator pos=_entries[_segment].insert(_entries[_segment].begin(),_it->first);
+            _entries[_it->second.first].erase(_it->second.second);
+            _it->second=std::make_pair(_segment,pos);
+        }
+        /*
+         * Moves the least recently used entry of a segment to the front of another one.
+         */
+        void demote(unsigned int _from, unsigned int _to) {
+            this->move(_entriesMap.find(_entries[_from].back()),_to);
+        }
+        /*
+         * Moves the entry to the front of it's segment.
+         */
+        void touch(entriesMapIterator _it) throw() {
+            entriesType& entries=_entries[_it->second.first];
+            entries.splice(entries.begin(),entries,_it->second.second);
+        }
+        void erase(entriesMapIterator _it) throw() {
+            _entries[_it->second.first].erase(_it->second.second);
+            _entriesMap.erase(_it);
+        }
+        void clear() throw() {
+            for (unsigned int segment=0;segment<Segments;segment++) {
+                _entries[segment].clear();
+            }
+            _entriesMap.clear();
+        }
+        void swap(_lru_segments<Key,Container,Segments>& x) throw() {
+            for (unsigned int segment=0;segment<Segments;segment++) {
+                _entries[segment].swap(x._entries[segment]);
+            }
+            _entriesMap.swap(x._entriesMap);
+        }
+    };
+
+    template <class Key>
+    struct lru_segments_container
+    {
+        using entriesType = _indexed_list<Key> ;
+        using entriesIterator = typename entriesType::iterator ;
+
+        using entriesMap = _flat_hash_map<Key, std::pair<unsigned int, entriesIterator> > ;
+        using entriesMapIterator = typename entriesMap::iterator ;
+    } ;
 }
 
 #endif /* STLCACHE_POLICY_LRU_HPP_INCLUDED */
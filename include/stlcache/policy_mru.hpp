@@ -22,11 +22,25 @@ namespace stlcache {
         }
     };
 
+    template <class Key> class _intrusive_mru_type : public _intrusive_lru_type<Key> {
+    public:
+        _intrusive_mru_type(const size_t& size) throw() : _intrusive_lru_type<Key>(size) { }
+
+        typename _intrusive_lru_type<Key>::hook_type* victim() throw() {
+            return this->_head;
+        }
+    };
+
     template <class Key>
     struct mru_default_container : public lru_default_container<Key>
     {
     } ;
 
+    template <class Key>
+    struct mru_indexed_container : public lru_indexed_container<Key>
+    {
+    } ;
+
     /*!
      * \brief A 'Most Recently Used' policy
      * 
@@ -40,10 +54,29 @@ namespace stlcache {
      */
     struct policy_mru {
         template <typename Key>
-            struct bind : _policy_mru_type<Key,mru_default_container> {
+            struct bind final : _policy_mru_type<Key,mru_default_container> {
                 bind(const bind& x) : _policy_mru_type<Key,mru_default_container>(x)  { }
+                bind& operator= (const bind& x) = default;
                 bind(const size_t& size) : _policy_mru_type<Key,mru_default_container>(size) { }
             };
+        template <typename Key>
+            struct intrusive_bind final : _intrusive_mru_type<Key> {
+                intrusive_bind(const size_t& size) : _intrusive_mru_type<Key>(size) { }
+            };
+    };
+
+    /*!
+     * \brief A 'Most Recently Used' policy without allocations
+     *
+     * The \link stlcache::policy_mru policy_mru \endlink counterpart of the \link stlcache::policy_indexed_lru policy_indexed_lru \endlink.
+     */
+    struct policy_indexed_mru {
+        template <typename Key>
+            struct bind final : _policy_mru_type<Key,mru_indexed_container> {
+                bind(const bind& x) : _policy_mru_type<Key,mru_indexed_container>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_mru_type<Key,mru_indexed_container>(size) { }
+            };
     };
 }
 
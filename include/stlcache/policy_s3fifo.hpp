@@ -0,0 +1,216 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_POLICY_S3FIFO_HPP_INCLUDED
+#define STLCACHE_POLICY_S3FIFO_HPP_INCLUDED
+
+#include <iterator>
+#include <list>
+#include <map>
+
+#include <stlcache/policy.hpp>
+
+namespace stlcache {
+    /*
+     * Queue entry of the S3-FIFO policy: the key, the queue it is in and a usage counter, saturating at 3.
+     */
+    template <class Key>
+    struct _s3fifo_entry {
+        Key key;
+        unsigned char queue;
+        unsigned char frequency;
+    };
+
+    template <class Key, template <typename T> class Container>
+    class _policy_s3fifo_type : public policy<Key> {
+        using entriesType = typename Container<Key>::entriesType ;
+        using entriesIterator = typename entriesType::iterator ;
+        using entriesMap = typename Container<Key>::entriesMap ;
+        using entriesMapIterator = typename entriesMap::iterator ;
+
+        /*
+         * New entries go to the small queue. The ones, that were used while they were in it, are moved to the main queue on expiration,
+         * the others are expired and remembered in the ghost queue, so they go straight to the main queue, if they come back soon.
+         * Every queue is ordered from the newest entry.
+         */
+        enum { _small=0, _main=1, _ghost=2, _queues=3 };
+
+        static const unsigned char _maxFrequency = 3;
+
+        std::size_t _smallSize;
+        std::size_t _ghostSize;
+        entriesType _entries[_queues];
+        entriesMap _entriesMap;
+
+        void move(entriesIterator _it, unsigned char _queue) throw() {
+            _entries[_queue].splice(_entries[_queue].begin(),_entries[_it->queue],_it);
+            _it->queue=_queue;
+            _it->frequency=0;
+        }
+    public:
+        _policy_s3fifo_type<Key,Container>& operator= ( const _policy_s3fifo_type<Key,Container>& x) throw() {
+            if (this==&x) {
+                return *this;
+            }
+            _smallSize=x._smallSize;
+            _ghostSize=x._ghostSize;
+            _entriesMap.clear();
+            for (unsigned int queue=0;queue<_queues;queue++) {
+                _entries[queue]=x._entries[queue];
+                for (entriesIterator it=_entries[queue].begin();it!=_entries[queue].end();++it) {
+                    _entriesMap.insert(std::make_pair(it->key,it));
+                }
+            }
+            return *this;
+        }
+        _policy_s3fifo_type(const _policy_s3fifo_type<Key,Container>& x) throw() {
+            *this=x;
+        }
+        /*
+         * The small queue takes 10% of the cache and the main queue takes the rest. The ghost queue remembers as many keys, as the
+         * main queue holds.
+         */
+        _policy_s3fifo_type(const size_t& size ) throw() : _smallSize(size/10<1 ? 1 : size/10), _ghostSize(size>_smallSize ? size-_smallSize : 1) {
+        }
+
+        virtual void insert(const Key& _k) throw(exception_invalid_key) {
+            entriesMapIterator mapIter=_entriesMap.find(_k);
+            if (mapIter!=_entriesMap.end()) {
+                if (mapIter->second->queue==_ghost) {
+                    this->move(mapIter->second,_main);
+                }
+                return;
+            }
+            _s3fifo_entry<Key> entry={_k,static_cast<unsigned char>(_small),0};
+            entriesIterator it=_entries[_small].insert(_entries[_small].begin(),entry);
+            try {
+                _entriesMap.insert(std::make_pair(_k,it));
+            } catch (...) {
+                _entries[_small].erase(it);
+                throw;
+            }
+        }
+
+        /*
+         * Entries, removed from the small queue, become ghosts. The oldest ghosts are forgotten, when there are too many of them.
+         */
+        virtual void remove(const Key& _k) throw() {
+            entriesMapIterator mapIter=_entriesMap.find(_k);
+            if (mapIter==_entriesMap.end() || mapIter->second->queue==_ghost) {
+                return;
+            }
+            if (mapIter->second->queue==_main) {
+                _entries[_main].erase(mapIter->second);
+                _entriesMap.erase(mapIter);
+                return;
+            }
+            this->move(mapIter->second,_ghost);
+            if (_entries[_ghost].size()>_ghostSize) {
+                _entriesMap.erase(_entries[_ghost].back().key);
+                _entries[_ghost].pop_back();
+            }
+        }
+        virtual void touch(const Key& _k) throw() {
+            entriesMapIterator mapIter=_entriesMap.find(_k);
+            if (mapIter==_entriesMap.end() || mapIter->second->queue==_ghost) {
+                return;
+            }
+            unsigned char& frequency=mapIter->second->frequency;
+            if (frequency<_maxFrequency) {
+                frequency++;
+            }
+        }
+        virtual void clear() throw() {
+            for (unsigned int queue=0;queue<_queues;queue++) {
+                _entries[queue].clear();
+            }
+            _entriesMap.clear();
+        }
+        virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
+            try {
+                this->swap(dynamic_cast<_policy_s3fifo_type<Key,Container>& >(_p));
+            } catch (const std::bad_cast& ) {
+                throw exception_invalid_policy("Attempted to swap incompatible policies");
+            }
+        }
+        void swap(_policy_s3fifo_type<Key,Container>& _p) throw() {
+            std::swap(_smallSize,_p._smallSize);
+            std::swap(_ghostSize,_p._ghostSize);
+            for (unsigned int queue=0;queue<_queues;queue++) {
+                _entries[queue].swap(_p._entries[queue]);
+            }
+            _entriesMap.swap(_p._entriesMap);
+        }
+
+        /*
+         * Expires from the small queue, while it is over it's share, and from the main queue otherwise. A used entry at the end of the
+         * small queue is moved to the main queue instead, and a used entry at the end of the main queue is reinserted with it's
+         * counter decremented.
+         */
+        virtual const _victim<Key> victim() throw()  {
+            entriesType& small=_entries[_small];
+            entriesType& main=_entries[_main];
+            for (;;) {
+                if (!small.empty() && (small.size()>=_smallSize || main.empty())) {
+                    entriesIterator it=std::prev(small.end());
+                    if (it->frequency==0) {
+                        return _victim<Key>(it->key);
+                    }
+                    this->move(it,_main);
+                } else if (!main.empty()) {
+                    entriesIterator it=std::prev(main.end());
+                    if (it->frequency==0) {
+                        return _victim<Key>(it->key);
+                    }
+                    unsigned char frequency=it->frequency-1;
+                    main.splice(main.begin(),main,it);
+                    it->frequency=frequency;
+                } else {
+                    return _victim<Key>();
+                }
+            }
+        }
+    };
+
+    template <class Key>
+    struct s3fifo_default_container
+    {
+        using entriesAllocator = std::allocator<_s3fifo_entry<Key> > ;
+        using entriesType = std::list<_s3fifo_entry<Key>, entriesAllocator> ;
+        using entriesIterator = typename entriesType::iterator ;
+
+        using entriesMapAllocator = std::allocator<std::pair<const Key, entriesIterator> > ;
+        using entriesMap = std::map<Key, entriesIterator, std::less<Key>, entriesMapAllocator> ;
+    } ;
+
+    /*!
+     * \brief A 'S3-FIFO' policy
+     *
+     * Implements the <a href="https://s3fifo.com/">S3-FIFO</a> cache algorithm, that is built of three FIFO queues: a small one, that takes 10%
+     * of the cache, the main one for the rest of the cache, and a ghost queue, that remembers as many recently expired keys, as the main queue holds.
+     *
+     * New entries go to the small queue. When an entry reaches the end of the small queue, it is moved to the main queue, if it was
+     * \link cache::touch touched \endlink, and expired otherwise, so the one-hit wonders leave the cache quickly. The main queue works like
+     * a CLOCK with a usage counter up to 3. Expired keys, that come back while they are in the ghost queue, go straight to the main queue.
+     * Touching the entry only increments it's counter, without reordering the queues.
+     *
+     * This policy is always able to expire any amount of entries. The cache size should be a realistic entry count, as the queues are sized by it.
+     *
+     * \see policy_sieve
+     * \see policy_wtinylfu
+     */
+    struct policy_s3fifo {
+        template <typename Key>
+            struct bind final : _policy_s3fifo_type<Key,s3fifo_default_container> {
+                bind(const bind& x) : _policy_s3fifo_type<Key,s3fifo_default_container>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_s3fifo_type<Key,s3fifo_default_container>(size) { }
+            };
+    };
+}
+
+#endif /* STLCACHE_POLICY_S3FIFO_HPP_INCLUDED */
@@ -0,0 +1,307 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_POLICY_SAMPLED_HPP_INCLUDED
+#define STLCACHE_POLICY_SAMPLED_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <stlcache/policy.hpp>
+#include <stlcache/policy_lru.hpp>
+#include <stlcache/container_flat_hash_map.hpp>
+
+namespace stlcache {
+    /*
+     * Slot of the sampled policies: the key and a single metadata word, that is interpreted by the score.
+     */
+    template <class Key>
+    struct _sampled_entry {
+        Key key;
+        std::uint32_t meta;
+    };
+
+    /*
+     * Expiration candidate, that is kept between the victim() calls, and it's score at the moment it was sampled.
+     */
+    template <class Key>
+    struct _sampled_candidate {
+        Key key;
+        std::uint32_t score;
+    };
+
+    /*
+     * The metadata word is the value of the access clock at the last use, so the score is the number of accesses since then.
+     */
+    struct _sampled_lru_score {
+        static std::uint32_t initial(std::uint32_t _clock) throw() {
+            return _clock;
+        }
+        static std::uint32_t touch(std::uint32_t, std::uint32_t _clock, std::uint64_t) throw() {
+            return _clock;
+        }
+        static std::uint32_t score(std::uint32_t _meta, std::uint32_t _clock) throw() {
+            return _clock-_meta;
+        }
+    };
+
+    /*
+     * The metadata word is a logarithmic usage counter in the low byte and the period of the last use in the upper ones, like the one,
+     * that Redis uses. The counter starts at 5, it is incremented with the probability of 1/((counter-5)*10+1), so 8 bits are enough
+     * for about a million of uses, and it loses a point for every period of 65536 accesses, during which the entry wasn't used.
+     */
+    struct _sampled_lfu_score {
+        static const std::uint32_t _initial = 5;
+        static const std::uint32_t _logFactor = 10;
+        static const unsigned int _periodShift = 16;
+        static const std::uint32_t _periodMask = 0xFFFFFFFFu>>_periodShift;
+
+        static std::uint32_t period(std::uint32_t _clock) throw() {
+            return _clock>>_periodShift;
+        }
+        static std::uint32_t counter(std::uint32_t _meta, std::uint32_t _clock) throw() {
+            std::uint32_t elapsed=(period(_clock)-(_meta>>8))&_periodMask;
+            std::uint32_t value=_meta&0xFF;
+            return elapsed>=value ? 0 : value-elapsed;
+        }
+
+        static std::uint32_t initial(std::uint32_t _clock) throw() {
+            return (period(_clock)<<8)|_initial;
+        }
+        static std::uint32_t touch(std::uint32_t _meta, std::uint32_t _clock, std::uint64_t _random) throw() {
+            std::uint32_t value=counter(_meta,_clock);
+            if (value<0xFF) {
+                std::uint32_t base=value>_initial ? value-_initial : 0;
+                if (_random%(base*_logFactor+1)==0) {
+                    value++;
+                }
+            }
+            return (period(_clock)<<8)|value;
+        }
+        static std::uint32_t score(std::uint32_t _meta, std::uint32_t _clock) throw() {
+            return 0xFF-counter(_meta,_clock);
+        }
+    };
+
+    template <class Key, template <typename T> class Container, class Score, unsigned int Samples>
+    class _policy_sampled_type : public policy<Key> {
+        using entriesType = typename Container<Key>::entriesType ;
+        using entriesMap = typename Container<Key>::entriesMap ;
+        using entriesMapIterator = typename entriesMap::iterator ;
+        using candidate = _sampled_candidate<Key> ;
+
+        static const std::size_t _poolSize = 16;
+        static const std::size_t _maxReserved = std::size_t(1)<<24;
+
+        /*
+         * Entries are packed at the beginning of the vector, so a random slot is a random entry. The pool keeps the best candidates
+         * from the previous samples, ordered by their score, with the best one at the back.
+         */
+        entriesType _entries;
+        entriesMap _entriesMap;
+        std::vector<candidate> _pool;
+        std::uint32_t _clock;
+        std::uint64_t _seed;
+
+        std::uint64_t random() throw() {
+            _seed^=_seed<<13;
+            _seed^=_seed>>7;
+            _seed^=_seed<<17;
+            return _seed;
+        }
+
+        /*
+         * Puts the candidate into the pool, unless the pool is full of the better ones.
+         */
+        void offer(const Key& _k, std::uint32_t _score) {
+            for (std::size_t indx=0;indx<_pool.size();indx++) {
+                if (_pool[indx].key==_k) {
+                    _pool.erase(_pool.begin()+indx);
+                    break;
+                }
+            }
+            if (_pool.size()==_poolSize) {
+                if (_score<=_pool.front().score) {
+                    return;
+                }
+                _pool.erase(_pool.begin());
+            }
+            typename std::vector<candidate>::iterator pos=_pool.begin();
+            while (pos!=_pool.end() && pos->score<=_score) {
+                ++pos;
+            }
+            candidate c={_k,_score};
+            _pool.insert(pos,c);
+        }
+    public:
+        _policy_sampled_type(const size_t& size) : _entries(), _entriesMap(), _pool(), _clock(0), _seed(UINT64_C(0x9E3779B97F4A7C15)) {
+            if (size<_maxReserved) {
+                _lru_reserve<Container<Key> >(_entries,_entriesMap,size,0);
+            }
+            _pool.reserve(_poolSize);
+        }
+
+        virtual void insert(const Key& _k) throw(exception_invalid_key) {
+            _sampled_entry<Key> entry={_k,Score::initial(_clock)};
+            _entries.push_back(entry);
+            try {
+                _entriesMap.insert(std::make_pair(_k,_entries.size()-1));
+            } catch (...) {
+                _entries.pop_back();
+                throw;
+            }
+            _clock++;
+        }
+
+        /*
+         * The last entry is moved into the slot of the removed one, so the entries stay packed.
+         */
+        virtual void remove(const Key& _k) throw() {
+            entriesMapIterator it=_entriesMap.find(_k);
+            if (it==_entriesMap.end()) {
+                return;
+            }
+            std::size_t slot=it->second;
+            _entriesMap.erase(it);
+            if (slot!=_entries.size()-1) {
+                _entries[slot]=_entries.back();
+                _entriesMap.find(_entries[slot].key)->second=slot;
+            }
+            _entries.pop_back();
+        }
+        virtual void touch(const Key& _k) throw() {
+            entriesMapIterator it=_entriesMap.find(_k);
+            if (it==_entriesMap.end()) {
+                return;
+            }
+            std::uint32_t& meta=_entries[it->second].meta;
+            meta=Score::touch(meta,_clock,this->random());
+            _clock++;
+        }
+        virtual void clear() throw() {
+            _entries.clear();
+            _entriesMap.clear();
+            _pool.clear();
+        }
+        virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
+            try {
+                this->swap(dynamic_cast<_policy_sampled_type<Key,Container,Score,Samples>& >(_p));
+            } catch (const std::bad_cast& ) {
+                throw exception_invalid_policy("Attempted to swap incompatible policies");
+            }
+        }
+        void swap(_policy_sampled_type<Key,Container,Score,Samples>& _p) throw() {
+            _entries.swap(_p._entries);
+            _entriesMap.swap(_p._entriesMap);
+            _pool.swap(_p._pool);
+            std::swap(_clock,_p._clock);
+            std::swap(_seed,_p._seed);
+        }
+
+        /*
+         * Samples random entries into the pool and expires the best candidate from it. Candidates, that were removed since they were
+         * sampled, are dropped, and the ones, that were used since then, are put back with their current score.
+         */
+        virtual const _victim<Key> victim() throw()  {
+            if (_entries.empty()) {
+                return _victim<Key>();
+            }
+            try {
+                for (unsigned int sample=0;sample<Samples;sample++) {
+                    const _sampled_entry<Key>& entry=_entries[this->random()%_entries.size()];
+                    this->offer(entry.key,Score::score(entry.meta,_clock));
+                }
+                while (!_pool.empty()) {
+                    candidate best=_pool.back();
+                    _pool.pop_back();
+                    entriesMapIterator it=_entriesMap.find(best.key);
+                    if (it==_entriesMap.end()) {
+                        continue;
+                    }
+                    std::uint32_t score=Score::score(_entries[it->second].meta,_clock);
+                    if (score>=best.score) {
+                        return _victim<Key>(best.key);
+                    }
+                    this->offer(best.key,score);
+                }
+            } catch (...) {
+            }
+            return _victim<Key>(_entries[this->random()%_entries.size()].key);
+        }
+    };
+
+    template <class Key>
+    struct sampled_default_container
+    {
+        using entriesType = std::vector<_sampled_entry<Key> > ;
+        using entriesMap = _flat_hash_map<Key, std::size_t> ;
+
+        static void reserve(entriesType& _entries, entriesMap& _map, std::size_t _size) {
+            _entries.reserve(_size);
+            _map.reserve(_size);
+        }
+    } ;
+
+    /*!
+     * \brief An approximate 'Least Recently Used' policy
+     *
+     * Instead of keeping the entries ordered, like the \link stlcache::policy_lru policy_lru \endlink does, it keeps a single 32 bit word
+     * per entry: the value of the access clock at the last use. The victim is the least recently used one among Samples random entries
+     * and a pool of the 16 best candidates from the previous samples, like the Redis approximated LRU. \link cache::touch Touching \endlink
+     * the entry is a lookup and a store, and the policy takes the key, the word and an index slot per entry, without any per-entry allocation.
+     *
+     * More samples make the expiration closer to the exact LRU, for the cost of a slower victim selection. The key must be hashable.
+     * This policy is always able to expire any amount of entries.
+     *
+     * \code
+     *     cache<int,string,policy_sampled_lru<5> > c(1000);
+     * \endcode
+     *
+     * \see policy_sampled_lfu
+     * \see policy_lru
+     */
+    template <unsigned int Samples = 5>
+    struct policy_sampled_lru {
+        static_assert(Samples>0 && Samples<=64, "Number of samples must be between 1 and 64");
+
+        template <typename Key>
+            struct bind final : _policy_sampled_type<Key,sampled_default_container,_sampled_lru_score,Samples> {
+                bind(const bind& x) : _policy_sampled_type<Key,sampled_default_container,_sampled_lru_score,Samples>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_sampled_type<Key,sampled_default_container,_sampled_lru_score,Samples>(size) { }
+            };
+    };
+
+    /*!
+     * \brief An approximate 'Least Frequently Used' policy
+     *
+     * Same as the \link stlcache::policy_sampled_lru policy_sampled_lru \endlink, but the word per entry is the Redis style logarithmic
+     * usage counter, that is decayed, while the entry is not used, so it reflects the recent popularity. The victim is the least frequently
+     * used one among Samples random entries and the pool of the best candidates. Compared to the \link stlcache::policy_lfu policy_lfu \endlink
+     * it doesn't keep the entries sorted by their usage, so \link cache::touch touching \endlink the entry doesn't reorder anything.
+     *
+     * The key must be hashable. This policy is always able to expire any amount of entries.
+     *
+     * \see policy_sampled_lru
+     * \see policy_lfu
+     */
+    template <unsigned int Samples = 5>
+    struct policy_sampled_lfu {
+        static_assert(Samples>0 && Samples<=64, "Number of samples must be between 1 and 64");
+
+        template <typename Key>
+            struct bind final : _policy_sampled_type<Key,sampled_default_container,_sampled_lfu_score,Samples> {
+                bind(const bind& x) : _policy_sampled_type<Key,sampled_default_container,_sampled_lfu_score,Samples>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_sampled_type<Key,sampled_default_container,_sampled_lfu_score,Samples>(size) { }
+            };
+    };
+}
+
+#endif /* STLCACHE_POLICY_SAMPLED_HPP_INCLUDED */
@@ -0,0 +1,177 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_POLICY_SIEVE_HPP_INCLUDED
+#define STLCACHE_POLICY_SIEVE_HPP_INCLUDED
+
+#include <iterator>
+#include <list>
+#include <map>
+
+#include <stlcache/policy.hpp>
+
+namespace stlcache {
+    /*
+     * Queue entry of the SIEVE policy: the key and whether it was touched since the hand passed it.
+     */
+    template <class Key>
+    struct _sieve_entry {
+        Key key;
+        bool visited;
+    };
+
+    template <class Key, template <typename T> class Container>
+    class _policy_sieve_type : public policy<Key> {
+        using entriesType = typename Container<Key>::entriesType ;
+        using entriesIterator = typename entriesType::iterator ;
+        using entriesMap = typename Container<Key>::entriesMap ;
+        using entriesMapIterator = typename entriesMap::iterator ;
+
+        /*
+         * The queue is ordered from the newest entry to the oldest one. The hand moves from the oldest entries to the newer ones and
+         * end() means it starts over from the oldest one.
+         */
+        entriesType _entries;
+        entriesMap _entriesMap;
+        entriesIterator _hand;
+
+        entriesIterator newer(entriesIterator _it) throw() {
+            return _it==_entries.begin() ? _entries.end() : std::prev(_it);
+        }
+    public:
+        _policy_sieve_type<Key,Container>& operator= ( const _policy_sieve_type<Key,Container>& x) throw() {
+            if (this==&x) {
+                return *this;
+            }
+            _entries=x._entries;
+            _entriesMap.clear();
+            _hand=_entries.end();
+            typename entriesType::const_iterator source=x._entries.begin();
+            for (entriesIterator it=_entries.begin();it!=_entries.end();++it,++source) {
+                _entriesMap.insert(std::make_pair(it->key,it));
+                if (source==x._hand) {
+                    _hand=it;
+                }
+            }
+            return *this;
+        }
+        _policy_sieve_type(const _policy_sieve_type<Key,Container>& x) throw() : _entries(), _entriesMap(), _hand(_entries.end()) {
+            *this=x;
+        }
+        _policy_sieve_type(const size_t& ) throw() : _entries(), _entriesMap(), _hand(_entries.end()) {
+        }
+
+        virtual void insert(const Key& _k) throw(exception_invalid_key) {
+            _sieve_entry<Key> entry={_k,false};
+            entriesIterator it=_entries.insert(_entries.begin(),entry);
+            try {
+                _entriesMap.insert(std::make_pair(_k,it));
+            } catch (...) {
+                _entries.erase(it);
+                throw;
+            }
+        }
+        virtual void remove(const Key& _k) throw() {
+            entriesMapIterator mapIter=_entriesMap.find(_k);
+            if (mapIter==_entriesMap.end()) {
+                return;
+            }
+            if (mapIter->second==_hand) {
+                _hand=this->newer(_hand);
+            }
+            _entries.erase(mapIter->second);
+            _entriesMap.erase(mapIter);
+        }
+        virtual void touch(const Key& _k) throw() {
+            entriesMapIterator mapIter=_entriesMap.find(_k);
+            if (mapIter==_entriesMap.end()) {
+                return;
+            }
+            mapIter->second->visited=true;
+        }
+        virtual void clear() throw() {
+            _entries.clear();
+            _entriesMap.clear();
+            _hand=_entries.end();
+        }
+        virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
+            try {
+                this->swap(dynamic_cast<_policy_sieve_type<Key,Container>& >(_p));
+            } catch (const std::bad_cast& ) {
+                throw exception_invalid_policy("Attempted to swap incompatible policies");
+            }
+        }
+        void swap(_policy_sieve_type<Key,Container>& _p) throw() {
+            bool handAtEnd=_hand==_entries.end();
+            bool otherHandAtEnd=_p._hand==_p._entries.end();
+            _entries.swap(_p._entries);
+            _entriesMap.swap(_p._entriesMap);
+            std::swap(_hand,_p._hand);
+            if (otherHandAtEnd) {
+                _hand=_entries.end();
+            }
+            if (handAtEnd) {
+                _p._hand=_p._entries.end();
+            }
+        }
+
+        /*
+         * The hand clears the visited entries on it's way and stops at the first one, that wasn't visited. The entries are never moved,
+         * so the survivors keep their place in the queue and the new entries are sifted out quickly.
+         */
+        virtual const _victim<Key> victim() throw()  {
+            if (_entries.empty()) {
+                return _victim<Key>();
+            }
+            entriesIterator it=_hand==_entries.end() ? std::prev(_entries.end()) : _hand;
+            while (it->visited) {
+                it->visited=false;
+                it=this->newer(it);
+                if (it==_entries.end()) {
+                    it=std::prev(_entries.end());
+                }
+            }
+            _hand=it;
+            return _victim<Key>(it->key);
+        }
+    };
+
+    template <class Key>
+    struct sieve_default_container
+    {
+        using entriesAllocator = std::allocator<_sieve_entry<Key> > ;
+        using entriesType = std::list<_sieve_entry<Key>, entriesAllocator> ;
+        using entriesIterator = typename entriesType::iterator ;
+
+        using entriesMapAllocator = std::allocator<std::pair<const Key, entriesIterator> > ;
+        using entriesMap = std::map<Key, entriesIterator, std::less<Key>, entriesMapAllocator> ;
+    } ;
+
+    /*!
+     * \brief A 'SIEVE' policy
+     *
+     * Implements the <a href="https://cachemon.github.io/SIEVE-website/">SIEVE</a> cache algorithm. The entries are kept in a FIFO queue and
+     * \link cache::touch touching \endlink the entry only marks it as visited, without moving it. The victim is selected by a hand, that
+     * walks from the oldest entries to the newer ones, unmarking the visited entries, and stops at the first unmarked one. The hand keeps it's
+     * position between the expirations, so the popular entries stay in the old part of the queue, while the new ones are expired fast.
+     *
+     * This policy is always able to expire any amount of entries. No additional configuration is required.
+     *
+     * \see policy_s3fifo
+     * \see policy_clock
+     */
+    struct policy_sieve {
+        template <typename Key>
+            struct bind final : _policy_sieve_type<Key,sieve_default_container> {
+                bind(const bind& x) : _policy_sieve_type<Key,sieve_default_container>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_sieve_type<Key,sieve_default_container>(size) { }
+            };
+    };
+}
+
+#endif /* STLCACHE_POLICY_SIEVE_HPP_INCLUDED */
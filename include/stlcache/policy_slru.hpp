@@ -0,0 +1,135 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_POLICY_SLRU_HPP_INCLUDED
+#define STLCACHE_POLICY_SLRU_HPP_INCLUDED
+
+#include <cstddef>
+
+#include <stlcache/policy.hpp>
+#include <stlcache/policy_lru.hpp>
+
+namespace stlcache {
+    template <class Key, template <typename T> class Container, unsigned int ProbationPct>
+    class _policy_slru_type : public policy<Key> {
+        /*
+         * New entries are on probation. The ones, that were used again, are protected and never expired, while there are entries
+         * on probation.
+         */
+        enum { _probation=0, _protected=1, _segments=2 };
+
+        using entriesType = _lru_segments<Key,Container,_segments> ;
+        using entriesMapIterator = typename entriesType::entriesMapIterator ;
+
+        entriesType _entries;
+        std::size_t _protectedSize;
+    public:
+        /*
+         * ProbationPct percents of the cache, but at least one entry, are left for the probation segment.
+         */
+        _policy_slru_type(const size_t& size ) : _entries(), _protectedSize(0) {
+            std::size_t probationSize=size/100*ProbationPct+size%100*ProbationPct/100;
+            if (probationSize<1) {
+                probationSize=1;
+            }
+            _protectedSize=size>probationSize ? size-probationSize : 0;
+            std::size_t sizes[_segments]={size+1,_protectedSize+1};
+            _entries.reserve(sizes);
+        }
+
+        virtual void insert(const Key& _k) throw(exception_invalid_key) {
+            _entries.insert(_k,_probation);
+        }
+        virtual void remove(const Key& _k) throw() {
+            entriesMapIterator it=_entries.find(_k);
+            if (it==_entries.end()) {
+                return;
+            }
+            _entries.erase(it);
+        }
+
+        /*
+         * A hit on probation promotes the entry to the protected segment. When the protected segment outgrows it's share, it's least
+         * recently used entry goes back to probation, as the most recently used one there.
+         */
+        virtual void touch(const Key& _k) throw() {
+            entriesMapIterator it=_entries.find(_k);
+            if (it==_entries.end()) {
+                return;
+            }
+            if (entriesType::segment(it)==_protected) {
+                _entries.touch(it);
+                return;
+            }
+            try {
+                _entries.move(it,_protected);
+                if (_entries.size(_protected)>_protectedSize) {
+                    _entries.demote(_protected,_probation);
+                }
+            } catch (...) {
+            }
+        }
+        virtual void clear() throw() {
+            _entries.clear();
+        }
+        virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
+            try {
+                this->swap(dynamic_cast<_policy_slru_type<Key,Container,ProbationPct>& >(_p));
+            } catch (const std::bad_cast& ) {
+                throw exception_invalid_policy("Attempted to swap incompatible policies");
+            }
+        }
+        void swap(_policy_slru_type<Key,Container,ProbationPct>& _p) throw() {
+            _entries.swap(_p._entries);
+            std::swap(_protectedSize,_p._protectedSize);
+        }
+
+        virtual const _victim<Key> victim() throw()  {
+            if (!_entries.empty(_probation)) {
+                return _victim<Key>(_entries.back(_probation));
+            }
+            if (!_entries.empty(_protected)) {
+                return _victim<Key>(_entries.back(_protected));
+            }
+            return _victim<Key>();
+        }
+    };
+
+    /*!
+     * \brief A 'Segmented LRU' policy
+     *
+     * Implements the <a href="http://en.wikipedia.org/wiki/Cache_replacement_policies#Segmented_LRU_(SLRU)">Segmented LRU</a> cache algorithm.
+     * The cache is split into two LRU segments: the probation one, that takes ProbationPct percents of the cache, and the protected one
+     * for the rest. New entries are put on probation and \link cache::touch touching \endlink the entry promotes it to the protected segment.
+     * The least recently used protected entry, that doesn't fit there anymore, goes back to probation. Entries are expired from probation
+     * first, so a scan only flushes the probation segment.
+     *
+     * \code
+     *     cache<int,string,policy_slru<20> > c(1000);
+     * \endcode
+     *
+     * Every operation is O(1): the segments are \link stlcache::policy_indexed_lru indexed lists \endlink, sharing one
+     * \link stlcache::container_flat_hash_map flat hash map \endlink, so the key must be hashable. This policy is always able to expire
+     * any amount of entries. The cache size should be a realistic entry count, as the segments are allocated for it.
+     *
+     * \see policy_lru
+     * \see policy_2q
+     */
+    template <unsigned int ProbationPct = 20>
+    struct policy_slru {
+        static_assert(ProbationPct>0 && ProbationPct<100, "SLRU probation share must be between 1 and 99 percents");
+
+        template <typename Key>
+            struct bind final : _policy_slru_type<Key,lru_segments_container,ProbationPct> {
+                bind(const bind& x) : _policy_slru_type<Key,lru_segments_container,ProbationPct>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_slru_type<Key,lru_segments_container,ProbationPct>(size) { }
+            };
+    };
+}
+
+#endif /* STLCACHE_POLICY_SLRU_HPP_INCLUDED */
@@ -0,0 +1,314 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_POLICY_WTINYLFU_HPP_INCLUDED
+#define STLCACHE_POLICY_WTINYLFU_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <stlcache/bits.hpp>
+#include <stlcache/policy.hpp>
+#include <stlcache/policy_lru.hpp>
+#include <stlcache/container_flat_hash_map.hpp>
+
+namespace stlcache {
+    /*
+     * Count-Min sketch of 4 bit counters, that estimates how often a key was seen recently, with a doorkeeper Bloom filter in front of it.
+     *
+     * The first sighting of a key only sets it's doorkeeper bits, so the one-hit wonders never reach the counters. Every key maps to a
+     * 64 byte block of the table and it's four counters lie in different words of that block, so an access touches a single cache line and
+     * the four rows are updated without branches or dependencies between them. After 10 additions per tracked entry all the counters are
+     * halved at once, 16 per word, and the doorkeeper is cleared, so the history decays and the sketch follows the changing popularity.
+     */
+    template <class Key, class Hash = std::hash<Key> >
+    class _frequency_sketch {
+        static const std::size_t _maxTracked = std::size_t(1)<<24;
+
+        Hash _hash;
+        std::vector<std::uint64_t> _table;
+        std::vector<std::uint64_t> _doorkeeper;
+        std::uint64_t _blockMask;
+        std::uint64_t _doorkeeperMask;
+        std::size_t _sampleSize;
+        std::size_t _additions;
+
+        static std::uint64_t spread(std::uint64_t _x) throw() {
+            _x^=_x>>33;
+            _x*=UINT64_C(0xFF51AFD7ED558CCD);
+            _x^=_x>>33;
+            _x*=UINT64_C(0xC4CEB9FE1A85EC53);
+            _x^=_x>>33;
+            return _x;
+        }
+        static std::size_t ceiling_power_of_two(std::size_t _x) throw() {
+            std::size_t result=1;
+            while (result<_x) {
+                result<<=1;
+            }
+            return result;
+        }
+
+        /*
+         * Sets the doorkeeper bits of the key and tells, whether they were set already.
+         */
+        bool admit(std::uint64_t _h) throw() {
+            std::uint64_t bits[2]={_h&_doorkeeperMask,(_h>>32)&_doorkeeperMask};
+            bool seen=true;
+            for (unsigned indx=0;indx<2;indx++) {
+                std::uint64_t& word=_doorkeeper[bits[indx]>>6];
+                std::uint64_t bit=std::uint64_t(1)<<(bits[indx]&63);
+                seen=seen && (word&bit);
+                word|=bit;
+            }
+            return seen;
+        }
+        bool seen(std::uint64_t _h) const throw() {
+            std::uint64_t first=_h&_doorkeeperMask;
+            std::uint64_t second=(_h>>32)&_doorkeeperMask;
+            return (_doorkeeper[first>>6]>>(first&63))&(_doorkeeper[second>>6]>>(second&63))&1;
+        }
+
+        /*
+         * Word of the table and the shift of the counter in it, for the row _row.
+         */
+        std::size_t slot(std::uint64_t _h, unsigned _row, unsigned& _shift) const throw() {
+            std::uint64_t block=(_h&_blockMask)<<3;
+            std::uint64_t counterHash=(_h*UINT64_C(0x9E3779B97F4A7C15))>>(_row<<3);
+            _shift=static_cast<unsigned>((counterHash>>1)&15)<<2;
+            return static_cast<std::size_t>(block+(counterHash&1)+(_row<<1));
+        }
+
+        void reset() throw() {
+            std::size_t odd=0;
+            for (std::size_t indx=0;indx<_table.size();indx++) {
+                odd+=_bit_count(_table[indx]&UINT64_C(0x1111111111111111));
+                _table[indx]=(_table[indx]>>1)&UINT64_C(0x7777777777777777);
+            }
+            for (std::size_t indx=0;indx<_doorkeeper.size();indx++) {
+                _doorkeeper[indx]=0;
+            }
+            _additions=(_additions-(odd>>2))>>1;
+        }
+    public:
+        explicit _frequency_sketch(std::size_t _size) : _hash(), _table(), _doorkeeper(), _blockMask(0), _doorkeeperMask(0), _sampleSize(0), _additions(0) {
+            std::size_t tracked=_size<1 ? 1 : (_size>_maxTracked ? _maxTracked : _size);
+            std::size_t words=ceiling_power_of_two(tracked);
+            words=words<8 ? 8 : words;
+            _table.assign(words,0);
+            _blockMask=(words>>3)-1;
+
+            std::size_t doorkeeperBits=ceiling_power_of_two(tracked)*8;
+            doorkeeperBits=doorkeeperBits<64 ? 64 : doorkeeperBits;
+            _doorkeeper.assign(doorkeeperBits>>6,0);
+            _doorkeeperMask=doorkeeperBits-1;
+
+            _sampleSize=tracked*10;
+        }
+
+        void increment(const Key& _k) throw() {
+            std::uint64_t h=spread(static_cast<std::uint64_t>(_hash(_k)));
+            if (!this->admit(h)) {
+                return;
+            }
+            std::uint64_t added=0;
+            for (unsigned row=0;row<4;row++) {
+                unsigned shift;
+                std::uint64_t& word=_table[this->slot(h,row,shift)];
+                std::uint64_t inc=static_cast<std::uint64_t>(((word>>shift)&15)!=15)<<shift;
+                word+=inc;
+                added|=inc;
+            }
+            if (added && ++_additions>=_sampleSize) {
+                this->reset();
+            }
+        }
+        unsigned estimate(const Key& _k) const throw() {
+            std::uint64_t h=spread(static_cast<std::uint64_t>(_hash(_k)));
+            unsigned result=15;
+            for (unsigned row=0;row<4;row++) {
+                unsigned shift;
+                std::uint64_t word=_table[this->slot(h,row,shift)];
+                unsigned count=static_cast<unsigned>((word>>shift)&15);
+                result=count<result ? count : result;
+            }
+            return result+(this->seen(h) ? 1 : 0);
+        }
+
+        void clear() throw() {
+            for (std::size_t indx=0;indx<_table.size();indx++) {
+                _table[indx]=0;
+            }
+            for (std::size_t indx=0;indx<_doorkeeper.size();indx++) {
+                _doorkeeper[indx]=0;
+            }
+            _additions=0;
+        }
+        void swap(_frequency_sketch<Key,Hash>& x) throw() {
+            std::swap(_hash,x._hash);
+            _table.swap(x._table);
+            _doorkeeper.swap(x._doorkeeper);
+            std::swap(_blockMask,x._blockMask);
+            std::swap(_doorkeeperMask,x._doorkeeperMask);
+            std::swap(_sampleSize,x._sampleSize);
+            std::swap(_additions,x._additions);
+        }
+    };
+
+    template <class Key, template <typename T> class Container> class _policy_wtinylfu_type : public policy<Key> {
+        using sketchType = typename Container<Key>::sketchType ;
+
+        enum { _window=0, _probation=1, _protected=2, _segments=3 };
+
+        using entriesType = _lru_segments<Key,Container,_segments> ;
+        using entriesMapIterator = typename entriesType::entriesMapIterator ;
+
+        sketchType _sketch;
+        entriesType _entries;
+        std::size_t _windowSize;
+        std::size_t _protectedSize;
+
+        bool main_empty() const throw() {
+            return _entries.empty(_probation) && _entries.empty(_protected);
+        }
+        const Key& main_victim() const throw() {
+            return _entries.empty(_probation) ? _entries.back(_protected) : _entries.back(_probation);
+        }
+    public:
+        _policy_wtinylfu_type(const size_t& size) : _sketch(size), _entries(), _windowSize(size/100<1 ? 1 : size/100), _protectedSize(0) {
+            std::size_t mainSize=size>_windowSize ? size-_windowSize : 0;
+            _protectedSize=mainSize-mainSize/5;
+            std::size_t sizes[_segments]={_windowSize+1,mainSize+1,_protectedSize+1};
+            _entries.reserve(sizes);
+        }
+
+        virtual void insert(const Key& _k) throw(exception_invalid_key) {
+            _sketch.increment(_k);
+            _entries.insert(_k,_window);
+            if (_entries.size(_window)>_windowSize) {
+                _entries.demote(_window,_probation);
+            }
+        }
+        virtual void remove(const Key& _k) throw() {
+            entriesMapIterator it=_entries.find(_k);
+            if (it==_entries.end()) {
+                return;
+            }
+            _entries.erase(it);
+        }
+
+        /*
+         * A hit in the probation segment promotes the entry to the protected one. When the protected segment outgrows it's share,
+         * it's least recently used entry gets the second chance in the probation segment.
+         */
+        virtual void touch(const Key& _k) throw() {
+            _sketch.increment(_k);
+            entriesMapIterator it=_entries.find(_k);
+            if (it==_entries.end()) {
+                return;
+            }
+            if (entriesType::segment(it)!=_probation) {
+                _entries.touch(it);
+                return;
+            }
+            try {
+                _entries.move(it,_protected);
+                if (_entries.size(_protected)>_protectedSize) {
+                    _entries.demote(_protected,_probation);
+                }
+            } catch (...) {
+            }
+        }
+        virtual void clear() throw() {
+            _entries.clear();
+            _sketch.clear();
+        }
+        virtual void swap(policy<Key>& _p) throw(exception_invalid_policy) {
+            try {
+                this->swap(dynamic_cast<_policy_wtinylfu_type<Key,Container>& >(_p));
+            } catch (const std::bad_cast& ) {
+                throw exception_invalid_policy("Attempted to swap incompatible policies");
+            }
+        }
+        void swap(_policy_wtinylfu_type<Key,Container>& _p) throw() {
+            _sketch.swap(_p._sketch);
+            _entries.swap(_p._entries);
+            std::swap(_windowSize,_p._windowSize);
+            std::swap(_protectedSize,_p._protectedSize);
+        }
+
+        /*
+         * The window overflows into the probation segment, while the cache is filling up. Once it is full, the least recently used
+         * window entry competes with the main area victim, and the one, that the sketch has seen less often, is evicted. The winner
+         * from the window moves to the probation segment, making room for the new entry in the window.
+         */
+        virtual const _victim<Key> victim() throw()  {
+            if (this->main_empty()) {
+                return _entries.empty(_window) ? _victim<Key>() : _victim<Key>(_entries.back(_window));
+            }
+            if (_entries.empty(_window) || _entries.size(_window)<_windowSize) {
+                return _victim<Key>(this->main_victim());
+            }
+
+            const Key& candidate=_entries.back(_window);
+            const Key& victim=this->main_victim();
+            if (_sketch.estimate(candidate)<=_sketch.estimate(victim)) {
+                return _victim<Key>(candidate);
+            }
+            _victim<Key> result(victim);
+            try {
+                _entries.demote(_window,_probation);
+            } catch (...) {
+                return _victim<Key>(candidate);
+            }
+            return result;
+        }
+    };
+
+    template <class Key>
+    struct wtinylfu_default_container
+    {
+        using entriesType = _indexed_list<Key> ;
+        using entriesIterator = typename entriesType::iterator ;
+
+        using entriesMap = _flat_hash_map<Key, std::pair<unsigned int, entriesIterator> > ;
+        using sketchType = _frequency_sketch<Key> ;
+    } ;
+
+    /*!
+     * \brief A 'Window TinyLFU' policy
+     *
+     * Implements the <a href="https://arxiv.org/abs/1512.00727">W-TinyLFU</a> cache algorithm: an LRU policy with the frequency based admission.
+     *
+     * New entries get into a small LRU window, that takes 1% of the cache. The rest of the cache is a segmented LRU: the entries, that
+     * were used again, are protected (80% of the main area) and the others are on probation. When the window is full, it's oldest entry
+     * has to win against the probation victim to stay in the cache, and the winner is the one, that was used more often recently.
+     * The usage history is kept by a 4 bit Count-Min sketch, that is periodically halved, so it reflects the recent popularity only.
+     *
+     * So the one-hit wonders, like the ones produced by scans and crawls, pass through the window and never push the popular entries out,
+     * while the window still lets the new popular entries in. \link cache::touch Touching \endlink the entry decreases item's
+     * expiration probability. This policy is always able to expire any amount of entries.
+     *
+     * The key must be hashable. The sketch size depends on the cache size, so the cache size should be a realistic entry count.
+     *
+     * \see policy_lru
+     * \see policy_lfu
+     */
+    struct policy_wtinylfu {
+        template <typename Key>
+            struct bind final : _policy_wtinylfu_type<Key,wtinylfu_default_container> {
+                bind(const bind& x) : _policy_wtinylfu_type<Key,wtinylfu_default_container>(x)  { }
+                bind& operator= (const bind& x) = default;
+                bind(const size_t& size) : _policy_wtinylfu_type<Key,wtinylfu_default_container>(size) { }
+            };
+    };
+}
+
+#endif /* STLCACHE_POLICY_WTINYLFU_HPP_INCLUDED */
@@ -0,0 +1,309 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_STATS_HPP_INCLUDED
+#define STLCACHE_STATS_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include <stlcache/concurrency.hpp>
+
+namespace stlcache {
+    /*!
+     * \brief Reasons, the entries are removed from the cache for
+     *
+     * \see cache_stats
+     */
+    enum eviction_reason {
+        /*! \brief Expired by the policy, to make room for the new entries */
+        eviction_size = 0,
+        /*! \brief Expired by the policy, to fit the maximum weight */
+        eviction_weight = 1,
+        /*! \brief Reclaimed after the time to live has passed */
+        eviction_expired = 2,
+        /*! \brief Removed with the \link cache::erase erase \endlink call */
+        eviction_explicit = 3
+    };
+
+    /*!
+     * \brief Snapshot of the cache statistics
+     *
+     * Returned by the \link cache::stats cache::stats \endlink and \link concurrent_cache::stats concurrent_cache::stats \endlink calls.
+     * All the counters are monotonic, since the cache construction or the last reset.
+     *
+     * \see stats_counters
+     */
+    struct cache_stats {
+        static const unsigned int _reasons = 4;
+
+        /*! \brief Lookups, that have found the key */
+        std::uint64_t hits;
+        /*! \brief Lookups, that haven't found the key */
+        std::uint64_t misses;
+        /*! \brief New entries */
+        std::uint64_t inserts;
+        /*! \brief Values, replaced by the \link cache::insert_or_assign insert_or_assign \endlink */
+        std::uint64_t updates;
+        /*! \brief Removed entries, indexed by the \link stlcache::eviction_reason eviction_reason \endlink */
+        std::uint64_t evictions[_reasons];
+        /*! \brief Loader calls, that have returned a value */
+        std::uint64_t loads;
+        /*! \brief Loader calls, that have thrown */
+        std::uint64_t load_failures;
+        /*! \brief Total time, spent in the loader calls */
+        std::chrono::nanoseconds load_time;
+
+        cache_stats() throw() : hits(0), misses(0), inserts(0), updates(0), loads(0), load_failures(0), load_time(0) {
+            for (unsigned int indx=0;indx<_reasons;indx++) {
+                evictions[indx]=0;
+            }
+        }
+
+        /*!
+         * \brief Sum of the evictions for all the reasons
+         */
+        std::uint64_t evictions_total() const throw() {
+            std::uint64_t result=0;
+            for (unsigned int indx=0;indx<_reasons;indx++) {
+                result+=evictions[indx];
+            }
+            return result;
+        }
+
+        /*!
+         * \brief Share of the lookups, that have found the key, or zero, when there were no lookups
+         */
+        double hit_ratio() const throw() {
+            return hits+misses==0 ? 0.0 : double(hits)/double(hits+misses);
+        }
+
+        /*!
+         * \brief Adds the counters of another snapshot, for example of another cache
+         */
+        cache_stats& operator+=(const cache_stats& x) throw() {
+            hits+=x.hits;
+            misses+=x.misses;
+            inserts+=x.inserts;
+            updates+=x.updates;
+            for (unsigned int indx=0;indx<_reasons;indx++) {
+                evictions[indx]+=x.evictions[indx];
+            }
+            loads+=x.loads;
+            load_failures+=x.load_failures;
+            load_time+=x.load_time;
+            return *this;
+        }
+
+        /*!
+         * \brief Exports the snapshot in the Prometheus text exposition format
+         *
+         * Formats all the counters as Prometheus metrics and passes the text to the _writer, so it could be appended to the output
+         * of a metrics endpoint:
+         *
+         * \code
+         *     myCache.stats().prometheus([&response](const std::string& text) { response+=text; },"users_cache");
+         * \endcode
+         *
+         * gives the users_cache_hits_total, users_cache_misses_total, users_cache_inserts_total, users_cache_updates_total,
+         * users_cache_evictions_total (with the reason label), users_cache_loads_total, users_cache_load_failures_total and
+         * users_cache_load_seconds_total counters.
+         *
+         * \param <_writer> functor, that takes the formatted text as a const std::string&
+         * \param <_prefix> prefix of the metric names
+         * \param <_labels> labels, that are added to every metric, like instance="a",shard="1", or an empty string
+         */
+        template <class Writer>
+        void prometheus(Writer _writer, const std::string& _prefix = "stlcache", const std::string& _labels = "") const {
+            static const char* const reasons[_reasons]={"size","weight","expired","explicit"};
+            std::ostringstream out;
+            std::string labels=_labels.empty() ? std::string() : "{"+_labels+"}";
+
+            counter(out,_prefix+"_hits_total","Lookups, that have found the key.",labels,hits);
+            counter(out,_prefix+"_misses_total","Lookups, that haven't found the key.",labels,misses);
+            counter(out,_prefix+"_inserts_total","Entries, inserted into the cache.",labels,inserts);
+            counter(out,_prefix+"_updates_total","Values, replaced in the existing entries.",labels,updates);
+            header(out,_prefix+"_evictions_total","Entries, removed from the cache, by reason.");
+            for (unsigned int indx=0;indx<_reasons;indx++) {
+                out<<_prefix<<"_evictions_total{"<<_labels<<(_labels.empty() ? "" : ",")<<"reason=\""<<reasons[indx]<<"\"} "<<evictions[indx]<<"\n";
+            }
+            counter(out,_prefix+"_loads_total","Loader calls, that have returned a value.",labels,loads);
+            counter(out,_prefix+"_load_failures_total","Loader calls, that have thrown.",labels,load_failures);
+            header(out,_prefix+"_load_seconds_total","Time, spent in the loader calls.");
+            out<<_prefix<<"_load_seconds_total"<<labels<<" "<<std::fixed<<std::setprecision(9)<<std::chrono::duration<double>(load_time).count()<<"\n";
+
+            _writer(out.str());
+        }
+    private:
+        static void header(std::ostringstream& _out, const std::string& _name, const char* _help) {
+            _out<<"# HELP "<<_name<<" "<<_help<<"\n"<<"# TYPE "<<_name<<" counter\n";
+        }
+        static void counter(std::ostringstream& _out, const std::string& _name, const char* _help, const std::string& _labels, std::uint64_t _value) {
+            header(_out,_name,_help);
+            _out<<_name<<_labels<<" "<<_value<<"\n";
+        }
+    };
+
+    /*!
+     * \brief Statistics are not collected
+     *
+     * The default statistics model. Every counting call is an empty inline function and the timer is an empty type, so the cache code
+     * doesn't change at all and \link cache::stats stats \endlink always returns zeros. The model is an empty base of a cache member,
+     * so it doesn't take any space either.
+     *
+     * \see stats_counters
+     */
+    struct stats_none {
+        struct timer_type {
+        };
+
+        void hit() const throw() { }
+        void miss() const throw() { }
+        void insert() const throw() { }
+        void update() const throw() { }
+        void evict(eviction_reason) const throw() { }
+        timer_type load_started() const throw() {
+            return timer_type();
+        }
+        void load_finished(const timer_type&, bool) const throw() { }
+
+        cache_stats snapshot() const throw() {
+            return cache_stats();
+        }
+        void reset() throw() { }
+        void swap(stats_none&) throw() { }
+    };
+
+    /*!
+     * \brief Hit, miss, insert, update, eviction and load counters
+     *
+     * Counters are relaxed atomics, so the hits, that are served under the shared lock of a
+     * \link stlcache::concurrency_buffered concurrency_buffered \endlink shard, are counted without any additional locking. The hit and
+     * the miss counters are padded to their own cache lines, so counting a hit doesn't invalidate the lines, that the other readers of the
+     * same shard are looking the keys up in, or the miss counter. The other counters are only changed under the exclusive lock and share
+     * a line. Every shard of the \link stlcache::concurrent_cache concurrent_cache \endlink has it's own counters, that are summed,
+     * when the statistics are read.
+     *
+     * \code
+     *     cache<int,string,policy_lru,container_unordered_map,weigher_unit,allocator_std,stats_counters> c(100000);
+     *     cout<<"Hit ratio: "<<c.stats().hit_ratio();
+     * \endcode
+     *
+     * \see stats_none
+     * \see cache_stats
+     */
+    class stats_counters {
+        using counter_type = std::atomic<std::uint64_t> ;
+        using clock_type = std::chrono::steady_clock ;
+
+        /*
+         * Padding instead of the alignment, so the caches could still be allocated with the plain operator new. Every padding takes
+         * a whole line, so wherever the counters start, the hit and the miss counters never share a line with each other or with
+         * the members of the cache.
+         */
+        char _before[_cache_line_size];
+        mutable counter_type _hits;
+        char _afterHits[_cache_line_size-sizeof(counter_type)];
+        mutable counter_type _misses;
+        char _afterMisses[_cache_line_size-sizeof(counter_type)];
+        mutable counter_type _inserts;
+        mutable counter_type _updates;
+        mutable counter_type _evictions[cache_stats::_reasons];
+        mutable counter_type _loads;
+        mutable counter_type _loadFailures;
+        mutable counter_type _loadTime;
+        char _after[_cache_line_size];
+
+        static void add(counter_type& _c, std::uint64_t _v) throw() {
+            _c.fetch_add(_v,std::memory_order_relaxed);
+        }
+        static std::uint64_t get(const counter_type& _c) throw() {
+            return _c.load(std::memory_order_relaxed);
+        }
+
+        void assign(const cache_stats& _s) throw() {
+            _hits.store(_s.hits,std::memory_order_relaxed);
+            _misses.store(_s.misses,std::memory_order_relaxed);
+            _inserts.store(_s.inserts,std::memory_order_relaxed);
+            _updates.store(_s.updates,std::memory_order_relaxed);
+            for (unsigned int indx=0;indx<cache_stats::_reasons;indx++) {
+                _evictions[indx].store(_s.evictions[indx],std::memory_order_relaxed);
+            }
+            _loads.store(_s.loads,std::memory_order_relaxed);
+            _loadFailures.store(_s.load_failures,std::memory_order_relaxed);
+            _loadTime.store(static_cast<std::uint64_t>(_s.load_time.count()),std::memory_order_relaxed);
+        }
+    public:
+        using timer_type = clock_type::time_point ;
+
+        stats_counters() throw() {
+            this->assign(cache_stats());
+        }
+        stats_counters(const stats_counters& x) throw() {
+            this->assign(x.snapshot());
+        }
+        stats_counters& operator=(const stats_counters& x) throw() {
+            this->assign(x.snapshot());
+            return *this;
+        }
+
+        void hit() const throw() {
+            add(_hits,1);
+        }
+        void miss() const throw() {
+            add(_misses,1);
+        }
+        void insert() const throw() {
+            add(_inserts,1);
+        }
+        void update() const throw() {
+            add(_updates,1);
+        }
+        void evict(eviction_reason _reason) const throw() {
+            add(_evictions[_reason],1);
+        }
+        timer_type load_started() const throw() {
+            return clock_type::now();
+        }
+        void load_finished(const timer_type& _started, bool _success) const throw() {
+            add(_success ? _loads : _loadFailures,1);
+            add(_loadTime,static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now()-_started).count()));
+        }
+
+        /*!
+         * \brief Reads the counters one by one, so the snapshot, taken while the cache is used, may be slightly inconsistent
+         */
+        cache_stats snapshot() const throw() {
+            cache_stats result;
+            result.hits=get(_hits);
+            result.misses=get(_misses);
+            result.inserts=get(_inserts);
+            result.updates=get(_updates);
+            for (unsigned int indx=0;indx<cache_stats::_reasons;indx++) {
+                result.evictions[indx]=get(_evictions[indx]);
+            }
+            result.loads=get(_loads);
+            result.load_failures=get(_loadFailures);
+            result.load_time=std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(get(_loadTime)));
+            return result;
+        }
+        void reset() throw() {
+            this->assign(cache_stats());
+        }
+        void swap(stats_counters& x) throw() {
+            cache_stats s=x.snapshot();
+            x.assign(this->snapshot());
+            this->assign(s);
+        }
+    };
+}
+
+#endif /* STLCACHE_STATS_HPP_INCLUDED */
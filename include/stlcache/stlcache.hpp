@@ -24,12 +24,29 @@
 #include <stlcache/policy_lfuaging.hpp>
 #include <stlcache/policy_lfuagingstar.hpp>
 #include <stlcache/policy_adaptive.hpp>
+#include <stlcache/policy_wtinylfu.hpp>
+#include <stlcache/policy_clock.hpp>
+#include <stlcache/policy_sieve.hpp>
+#include <stlcache/policy_s3fifo.hpp>
+#include <stlcache/policy_lirs.hpp>
+#include <stlcache/policy_2q.hpp>
+#include <stlcache/policy_slru.hpp>
+#include <stlcache/policy_sampled.hpp>
 
+#include <stlcache/allocator.hpp>
 #include <stlcache/container.hpp>
 
 #include <stlcache/container_map.hpp>
 #include <stlcache/container_unordered_map.hpp>
+#include <stlcache/container_flat_hash_map.hpp>
+#include <stlcache/weigher.hpp>
+#include <stlcache/stats.hpp>
+#include <stlcache/bits.hpp>
+#include <stlcache/timing_wheel.hpp>
 #include <stlcache/cache.hpp>
+#include <stlcache/intrusive_cache.hpp>
+#include <stlcache/concurrency.hpp>
+#include <stlcache/concurrent_cache.hpp>
 
 //TODO: multicache is not yet functional
 //#include <stlcache/container_multimap.hpp>
@@ -120,6 +137,52 @@ namespace stlcache {
      Note, that the \link cache::insert insert \endlink call could throw a \link stlcache::exception_cache_full cache full exception \endlink or
      \link stlcache::exception_invalid_key invalid key exception \endlink As keys have to be unique, the insert call may do nothing, if it meets the
      duplicate key. Don't forget to check it's return value.
+
+     Large values could be moved into the cache or constructed in place with \link cache::emplace emplace \endlink or \link cache::try_emplace try_emplace \endlink,
+     and \link cache::insert_or_assign insert_or_assign \endlink replaces the value of an existing entry. All of them look the key up only once:
+     \code
+     myCache.try_emplace(2,"Two");
+     myCache.insert_or_assign(1,std::move(newOne));
+     \endcode
+     
+     Entries are kept in a std::unordered_map by default. The fourth template parameter selects another \link stlcache::container container \endlink:
+     \link stlcache::container_map container_map \endlink for keys, that could only be ordered, or \link stlcache::container_flat_hash_map container_flat_hash_map \endlink,
+     an open addressing table, that is sized for the whole cache up front and doesn't allocate on insertion:
+     \code
+     cache<int,string,policy_lru,container_flat_hash_map> myCache(100000);
+     \endcode
+
+     When the values differ in size a lot, the entry count doesn't say much about the memory usage. Pass a weigher as the fifth template
+     parameter and the maximum weight as the second constructor argument, so the cache will expire entries until the new one fits:
+     \code
+     cache<int,string,policy_lru,container_unordered_map,weigher_bytes> myCache(100000,64*1024*1024);
+     \endcode
+     \link stlcache::weigher_bytes weigher_bytes \endlink counts the bytes of std::string, std::vector and trivially copyable types, but
+     any functor, that returns a weight for a key and a value, will do. The current weight is returned by \link cache::weight weight \endlink.
+
+     The sixth template parameter selects the allocation model of the entries and the policy nodes. With \link stlcache::allocator_pool allocator_pool \endlink
+     every cache takes it's nodes from it's own pools and reuses the freed ones, so a full cache doesn't go to malloc on every insertion:
+     \code
+     cache<int,string,policy_lru,container_unordered_map,weigher_unit,allocator_pool> myCache(100000);
+     \endcode
+     When the cache is compiled as C++14 and the standard library has the Library Fundamentals TS, \link stlcache::allocator_resource allocator_resource \endlink
+     takes them from a std::experimental::pmr::memory_resource.
+
+     The seventh template parameter turns the statistics on. With \link stlcache::stats_counters stats_counters \endlink the cache counts
+     hits, misses, inserts, updates, evictions by reason and loader calls, and \link cache::stats stats \endlink returns a snapshot, that
+     could be exported in the Prometheus text format:
+     \code
+     cache<int,string,policy_lru,container_unordered_map,weigher_unit,allocator_std,stats_counters> myCache(100000);
+     myCache.stats().prometheus([&response](const std::string& text) { response+=text; });
+     \endcode
+     The default \link stlcache::stats_none stats_none \endlink doesn't count anything and costs nothing.
+     
+     Entries could expire after some time, either with the \link cache::set_default_ttl default time to live \endlink or per entry:
+     \code
+     myCache.insert(3,"Three",std::chrono::seconds(30));
+     \endcode
+     Expired entries are never returned and they are reclaimed before the policy is asked for a victim, so short-lived entries don't push
+     the useful ones out of the cache.
      
      Now, when you have some data in the cache, you may want to retrieve it back:
      
@@ -137,6 +200,22 @@ namespace stlcache {
      \endcode
      
      The \link cache::check check \endlink is exception-safe.
+
+     For the read-through access use \link cache::get_or_load get_or_load \endlink, that calls your loader on a miss and caches the result.
+     The \link stlcache::concurrent_cache concurrent_cache \endlink version also coalesces concurrent misses, so a popular key is loaded only once:
+     \code
+     string myOne = myCache.get_or_load(1,[](const int& k) { return loadFromDatabase(k); });
+     \endcode
+
+     The check and fetch pair looks the key up twice. When lookup cost matters, use \link cache::try_get try_get \endlink, that looks the key up once,
+     touches it once and returns a pointer to the value or nullptr for the missing key. If you need to look at the value without changing it's
+     usage count, use \link cache::peek peek \endlink:
+     \code
+     const string* myOne = myCache.try_get(1);
+     if (myOne) {
+       cout<<*myOne;
+     }
+     \endcode
      
      Both \link cache::check check \endlink and \link cache::fetch fetch \endlink calls are increasing internal reference count for the key, so, depending
      on the used policy, it will increase or decrease the entry's chance to become an expiration victim. Under some circumstances you may
@@ -168,8 +247,55 @@ namespace stlcache {
      \li \link stlcache::policy_lfuaging LFU-Aging \endlink - 'Least frequently used' policy with time-based decreasing of usage count
      \li \link stlcache::policy_lfuagingstar LFU*-Aging \endlink - Combination of \link stlcache::policy_lfustar LFU* \endlink and \link stlcache::policy_lfuagingstar LFU*-Aging \endlink policies
      \li \link stlcache::policy_adaptive Adaptive Replacement \endlink - 'Adaptive Replacement' policy
+     \li \link stlcache::policy_wtinylfu W-TinyLFU \endlink - 'Window TinyLFU' policy, a segmented LRU, that admits new entries by their recent usage frequency
+     \li \link stlcache::policy_clock CLOCK \endlink - 'CLOCK' policy, an approximation of LRU, that only sets a reference bit on a hit
+     \li \link stlcache::policy_gclock GCLOCK \endlink - 'Generalized CLOCK' policy, that keeps a saturating usage counter instead of the bit
+     \li \link stlcache::policy_sieve SIEVE \endlink - 'SIEVE' policy, a FIFO queue with a hand, that sifts out the entries, that weren't used
+     \li \link stlcache::policy_s3fifo S3-FIFO \endlink - 'S3-FIFO' policy, with a small FIFO queue, that filters out the one-hit wonders, in front of the main one
+     \li \link stlcache::policy_lirs LIRS \endlink - 'Low Inter-reference Recency Set' policy, that resists scans and loops over sets slightly larger than the cache
+     \li \link stlcache::policy_2q 2Q \endlink - '2Q' policy, that lets only the entries, used again after their first expiration, into the LRU part of the cache
+     \li \link stlcache::policy_slru SLRU \endlink - 'Segmented LRU' policy, that protects the entries, that were used more than once, from the new ones
+     \li \link stlcache::policy_sampled_lru Sampled LRU \endlink - an approximate LRU, that keeps a single word per entry and expires the least recently used of a few random entries
+     \li \link stlcache::policy_sampled_lfu Sampled LFU \endlink - an approximate LFU with a logarithmic usage counter per entry, that expires the least frequently used of a few random entries
      
      The cache expiration policy must be specified as a third parameter of \link stlcache::cache cache \endlink type and it is mandatory.
+
+     \link stlcache::policy_indexed_lru policy_indexed_lru \endlink, \link stlcache::policy_indexed_mru policy_indexed_mru \endlink and
+     \link stlcache::policy_indexed_adaptive policy_indexed_adaptive \endlink are the LRU, MRU and Adaptive Replacement policies, that keep the
+     recency lists in arrays linked by 32 bit indices and index the keys with a flat hash map. They are allocated for the cache size up front,
+     so touching entries and selecting victims never allocate.
+
+     \section Intrusive Intrusive entries
+
+     The \link stlcache::cache cache \endlink keeps every key twice: once in the storage and once in the policy structures. When memory and lookup
+     cost matter, the \link stlcache::intrusive_cache intrusive_cache \endlink could be used instead. It stores the key, the value and the policy
+     links in a single storage node, so a fetch is a single lookup:
+
+     \code
+     stlcache::intrusive_cache<int,string,stlcache::policy_lru> myCache(10);
+     \endcode
+
+     Intrusive mode is available for the \link stlcache::policy_lru LRU \endlink, \link stlcache::policy_mru MRU \endlink and
+     \link stlcache::policy_lfu LFU \endlink policies.
+     
+     \section Concurrency Concurrent access
+
+     The \link stlcache::cache cache \endlink is not thread-safe. For the multi-threaded servers there is a \link stlcache::concurrent_cache concurrent_cache \endlink,
+     that partitions keys over a number of independent shards, each with it's own lock:
+
+     \code
+     stlcache::concurrent_cache<int,string,stlcache::policy_lru> myCache(100000);
+     string value;
+     if (myCache.try_get(1,value)) {
+       cout<<value;
+     }
+     \endcode
+
+     Every shard gets an equal part of the capacity and expires it's own entries only. Values are returned by copy, as other threads may
+     remove them at any moment.
+
+     For read-heavy workloads pass \link stlcache::concurrency_buffered concurrency_buffered \endlink as the last template parameter. Hits
+     are served under a shared lock and their policy updates are buffered and applied in batches, so reads don't serialize on the policy.
      
      \section Writing your own policy
      
@@ -185,6 +311,7 @@ namespace stlcache {
         template <typename Key, template <typename T> class Allocator>
             struct bind : _policy_none_type<Key,Allocator> { 
                 bind(const bind& x) : _policy_none_type<Key,Allocator>(x)  { }
+                bind& operator= (const bind& x) = default;
                 bind(const size_t& size) : _policy_none_type<Key,Allocator>(size) { }
             };
         };
@@ -198,6 +325,7 @@ namespace stlcache {
             template <typename Key, template <typename T> class Allocator>
                 struct bind : _policy_none_type<R,Key,Allocator> { 
                     bind(const bind& x) : _policy_none_type<R,Key,Allocator>(x) { }
+                    bind& operator= (const bind& x) = default;
                     bind(const size_t& size) : _policy_none_type<R,Key,Allocator>(size) { }
                 };
         };     
@@ -0,0 +1,222 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_TIMING_WHEEL_HPP_INCLUDED
+#define STLCACHE_TIMING_WHEEL_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include <stlcache/bits.hpp>
+#include <stlcache/container.hpp>
+#include <stlcache/container_unordered_map.hpp>
+
+namespace stlcache {
+    /*
+     * Hierarchical timing wheel, that keeps the expiration deadlines of the cache entries.
+     *
+     * Time is counted in milliseconds ticks since the wheel creation. Every level has 64 slots and every slot of the level L covers
+     * 64^L ticks, so an entry is linked into the level of the highest base-64 digit, where it's deadline differs from the current tick.
+     * When the current tick reaches a slot of the upper level, that slot is cascaded to the lower levels, and the level 0 slots are
+     * expired. The occupancy bitmaps let the wheel jump straight to the next non-empty slot, so both the scheduling and the advance
+     * are O(1) per entry, independently of the number of entries and of the time passed since the last advance.
+     */
+    template <class Key, class Container>
+    class _timing_wheel {
+    public:
+        using clock_type = std::chrono::steady_clock ;
+        using tick_type = std::uint64_t ;
+
+        struct node_type {
+            node_type* prev;
+            node_type* next;
+            const Key* key;
+            tick_type deadline;
+
+            node_type() throw() : prev(nullptr), next(nullptr), key(nullptr), deadline(0) { }
+        };
+    private:
+        /*
+         * Nodes are linked by pointers, so a flat container, that relocates it's elements, is replaced with the node based one.
+         */
+        using index_container = typename std::conditional<_container_stable_references<typename Container::template bind<Key,node_type> >::value,Container,container_unordered_map>::type ;
+        using index_binder = typename index_container::template bind<Key,node_type> ;
+        using index_type = typename index_binder::map_type ;
+
+        static const unsigned _levelBits = 6;
+        static const unsigned _slots = 1u<<_levelBits;
+        static const unsigned _levels = 8;
+        static const tick_type _horizon = (tick_type(1)<<(_levelBits*_levels))-1;
+
+        index_type _index;
+        node_type* _wheel[_levels][_slots];
+        std::uint64_t _occupied[_levels];
+        clock_type::time_point _origin;
+        tick_type _now;
+
+        void link(node_type* _n) throw() {
+            tick_type diff=_n->deadline^_now;
+            unsigned level=diff ? _bit_high(diff)/_levelBits : 0;
+            unsigned slot=static_cast<unsigned>(_n->deadline>>(level*_levelBits))&(_slots-1);
+
+            _n->prev=nullptr;
+            _n->next=_wheel[level][slot];
+            if (_n->next) {
+                _n->next->prev=_n;
+            }
+            _wheel[level][slot]=_n;
+            _occupied[level]|=std::uint64_t(1)<<slot;
+        }
+        void unlink(node_type* _n) throw() {
+            if (_n->next) {
+                _n->next->prev=_n->prev;
+            }
+            if (_n->prev) {
+                _n->prev->next=_n->next;
+                return;
+            }
+            tick_type diff=_n->deadline^_now;
+            unsigned level=diff ? _bit_high(diff)/_levelBits : 0;
+            unsigned slot=static_cast<unsigned>(_n->deadline>>(level*_levelBits))&(_slots-1);
+            _wheel[level][slot]=_n->next;
+            if (!_n->next) {
+                _occupied[level]&=~(std::uint64_t(1)<<slot);
+            }
+        }
+        node_type* detach(unsigned _level, unsigned _slot) throw() {
+            node_type* head=_wheel[_level][_slot];
+            _wheel[_level][_slot]=nullptr;
+            _occupied[_level]&=~(std::uint64_t(1)<<_slot);
+            return head;
+        }
+
+        /*
+         * The closest tick, when some slot has to be cascaded or expired. Slots of the level L are always ahead of the current
+         * digit of that level, so the lowest non-empty level gives the answer.
+         */
+        tick_type next_event() const throw() {
+            for (unsigned level=0;level<_levels;level++) {
+                unsigned digit=static_cast<unsigned>(_now>>(level*_levelBits))&(_slots-1);
+                std::uint64_t ahead=digit==_slots-1 ? 0 : _occupied[level]&(~std::uint64_t(0)<<(digit+1));
+                if (ahead) {
+                    unsigned shift=(level+1)*_levelBits;
+                    return ((_now>>shift)<<shift)|(tick_type(_bit_low(ahead))<<(level*_levelBits));
+                }
+            }
+            return ~tick_type(0);
+        }
+
+        void reset() throw() {
+            for (unsigned level=0;level<_levels;level++) {
+                for (unsigned slot=0;slot<_slots;slot++) {
+                    _wheel[level][slot]=nullptr;
+                }
+                _occupied[level]=0;
+            }
+        }
+    public:
+        _timing_wheel() : _index(), _origin(clock_type::now()), _now(0) {
+            this->reset();
+        }
+        _timing_wheel(const _timing_wheel<Key,Container>& x) : _index(), _origin(x._origin), _now(x._now) {
+            this->reset();
+            for (typename index_type::const_iterator it=x._index.begin();it!=x._index.end();++it) {
+                this->schedule(it->first,it->second.deadline);
+            }
+        }
+        _timing_wheel<Key,Container>& operator=(const _timing_wheel<Key,Container>& x) = delete;
+
+        /*
+         * Current tick of the clock, which is not the same as the current tick of the wheel, until the wheel is advanced.
+         */
+        tick_type clock() const throw() {
+            return static_cast<tick_type>(std::chrono::duration_cast<std::chrono::milliseconds>(clock_type::now()-_origin).count());
+        }
+        template <class Duration>
+        tick_type deadline(const Duration& _ttl) const throw() {
+            tick_type ttl=static_cast<tick_type>(std::chrono::duration_cast<std::chrono::milliseconds>(_ttl).count());
+            tick_type now=this->clock();
+            return ttl>_horizon-now ? _horizon : now+ttl;
+        }
+
+        bool empty() const throw() {
+            return _index.empty();
+        }
+        void clear() throw() {
+            _index.clear();
+            this->reset();
+        }
+
+        /*
+         * Sets or moves the deadline of the key. Deadlines, that are already passed, are due on the next tick.
+         */
+        void schedule(const Key& _k, tick_type _deadline) {
+            std::pair<typename index_type::iterator,bool> result=index_binder::try_emplace(_index,_k);
+            node_type* n=&result.first->second;
+            if (!result.second) {
+                this->unlink(n);
+            }
+            n->key=&result.first->first;
+            n->deadline=_deadline>_now ? _deadline : _now+1;
+            this->link(n);
+        }
+        void remove(const Key& _k) throw() {
+            typename index_type::iterator it=_index.find(_k);
+            if (it==_index.end()) {
+                return;
+            }
+            this->unlink(&it->second);
+            _index.erase(it);
+        }
+        bool expired(const Key& _k, tick_type _tick) const throw() {
+            typename index_type::const_iterator it=_index.find(_k);
+            return it!=_index.end() && it->second.deadline<=_tick;
+        }
+
+        /*
+         * Moves the wheel to the _to tick, calling _expire for every key with the deadline at or before it. The key is still
+         * in the wheel during the call, but is removed right after it.
+         */
+        template <class F>
+        void advance(tick_type _to, F _expire) {
+            for (;;) {
+                tick_type tick=this->next_event();
+                if (tick>_to) {
+                    break;
+                }
+                _now=tick;
+                for (unsigned level=_levels-1;level>0;level--) {
+                    if (tick&((tick_type(1)<<(level*_levelBits))-1)) {
+                        continue;
+                    }
+                    unsigned slot=static_cast<unsigned>(tick>>(level*_levelBits))&(_slots-1);
+                    node_type* n=this->detach(level,slot);
+                    while (n) {
+                        node_type* next=n->next;
+                        this->link(n);
+                        n=next;
+                    }
+                }
+                node_type* n=this->detach(0,static_cast<unsigned>(tick)&(_slots-1));
+                while (n) {
+                    node_type* next=n->next;
+                    typename index_type::iterator it=_index.find(*n->key);
+                    _expire(it->first);
+                    _index.erase(it);
+                    n=next;
+                }
+            }
+            if (_now<_to) {
+                _now=_to;
+            }
+        }
+    };
+}
+
+#endif /* STLCACHE_TIMING_WHEEL_HPP_INCLUDED */
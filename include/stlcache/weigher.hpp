@@ -0,0 +1,89 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_WEIGHER_HPP_INCLUDED
+#define STLCACHE_WEIGHER_HPP_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace stlcache {
+    /*
+     * Approximate memory footprint of a value. Defined for trivially copyable types, std::basic_string and std::vector (recursively),
+     * other types need a specialization or a custom weigher.
+     */
+    template <class T, class Enable = void>
+    struct _weight_of;
+
+    template <class T>
+    struct _weight_of<T, typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+        static std::size_t get(const T&) throw() {
+            return sizeof(T);
+        }
+    };
+
+    template <class Char, class Traits, class Allocator>
+    struct _weight_of<std::basic_string<Char,Traits,Allocator> > {
+        static std::size_t get(const std::basic_string<Char,Traits,Allocator>& _v) throw() {
+            return sizeof(_v)+_v.size()*sizeof(Char);
+        }
+    };
+
+    template <class T, class Allocator>
+    struct _weight_of<std::vector<T,Allocator> > {
+        static std::size_t get(const std::vector<T,Allocator>& _v) throw() {
+            if (std::is_trivially_copyable<T>::value) {
+                return sizeof(_v)+_v.size()*sizeof(T);
+            }
+            std::size_t weight=sizeof(_v);
+            for (typename std::vector<T,Allocator>::const_iterator it=_v.begin();it!=_v.end();++it) {
+                weight+=_weight_of<T>::get(*it);
+            }
+            return weight;
+        }
+    };
+
+    /*!
+     * \brief Counts every entry as a unit weight
+     *
+     * The default weigher of the \link stlcache::cache cache \endlink. With it the weight of the cache is just the number of entries.
+     *
+     * \see weigher_bytes
+     */
+    struct weigher_unit {
+        template <class Key, class Data>
+        std::size_t operator()(const Key&, const Data&) const throw() {
+            return 1;
+        }
+    };
+
+    /*!
+     * \brief Weights entries by their approximate memory footprint
+     *
+     * Returns the number of bytes, used by the key and the value. Trivially copyable types are weighted by their sizeof, std::string
+     * and std::vector also count their contents. For other types you have to write your own weigher.
+     *
+     * A weigher is any copyable functor, that takes a key and a value and returns a std::size_t weight. The weight of an entry must not
+     * change while the entry is kept in the cache.
+     *
+     * \code
+     *     cache<int,std::vector<char>,policy_lru,container_unordered_map,weigher_bytes> c(100000,64*1024*1024);
+     * \endcode
+     *
+     * \see cache
+     */
+    struct weigher_bytes {
+        template <class Key, class Data>
+        std::size_t operator()(const Key& _k, const Data& _d) const throw() {
+            return _weight_of<Key>::get(_k)+_weight_of<Data>::get(_d);
+        }
+    };
+}
+
+#endif /* STLCACHE_WEIGHER_HPP_INCLUDED */
@@ -0,0 +1,716 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+/*
+ * Times the single cache operations for every policy and container at several cache sizes and reports the median and the 99th
+ * percentile of the time per operation as CSV or JSON.
+ *
+ *     cache_bench [options]
+ *
+ *     --sizes 1000,10000    cache sizes in entries, by default every power of ten from 1000 to 10000000
+ *     --ops insert,touch    runs only the listed operations, all of them by default
+ *     --policy lfu          runs only the policies, whose names contain the string
+ *     --container map       runs only the containers, whose names contain the string
+ *     --repetitions 100     timed samples of every operation
+ *     --warmup 10           untimed samples before the timed ones
+ *     --batch 1000          operations in every sample
+ *     --seed 42             seed of the key streams
+ *     --counters            also reads the cycles, last level cache misses and branch misses with perf_event_open, on Linux
+ *     --baseline old.csv    compares the medians with the CSV output of a previous run
+ *     --format csv|json     output format, csv by default
+ *
+ * The cache is filled with the keys from 0 to size-1 in a random order, then the operations run in the order of the list:
+ *
+ *     insert      inserts into the cache, that is not full yet, every chunk of the fill is a sample
+ *     fetch_hit   fetches the random present keys
+ *     fetch_miss  looks the random absent keys up with try_get, as the fetch reports them with an exception
+ *     touch       touches the random present keys
+ *     erase       erases the present keys, that are inserted back after every sample without the timing
+ *     evict       inserts the new keys into the full cache, so every insert evicts an entry, skipped, when the policy can't expire anything
+ *
+ * Every sample times a batch of operations with the steady clock, so the percentiles are over the batches. When the cache is smaller,
+ * than the batch, the batch is limited to the cache size for the insert and the erase and the cache is filled again, until there are
+ * enough samples. Every policy, container and size runs in it's own process, so the allocator state of one run doesn't affect the
+ * others. Counters are mean values per operation over the timed samples, counted in the user space only.
+ *
+ * To compare two commits, run the benchmark on both and pass the CSV output of the first one to the second with --baseline: the
+ * baseline_median_ns and change_pct columns are added for every operation, that is present in both runs.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif /* __linux__ */
+
+#include <stlcache/stlcache.hpp>
+
+#include "workload.hpp"
+
+using namespace stlcache;
+using namespace std;
+
+enum operation_type { op_insert, op_fetch_hit, op_fetch_miss, op_touch, op_erase, op_evict, op_count };
+
+static const char* const operationNames[op_count] = {"insert","fetch_hit","fetch_miss","touch","erase","evict"};
+
+static const unsigned int noCounters = 3;
+
+struct result_type {
+    bool valid;
+    bool counted;
+    uint64_t samples;
+    uint64_t batch;
+    double medianNs;
+    double p99Ns;
+    double minNs;
+    double meanNs;
+    double counters[noCounters];
+};
+
+struct options_type {
+    vector<size_t> sizes;
+    bool ops[op_count];
+    string policy;
+    string container;
+    size_t repetitions;
+    size_t warmup;
+    size_t batch;
+    uint64_t seed;
+    bool counters;
+    string baseline;
+    bool json;
+
+    options_type() : sizes(), policy(), container(), repetitions(100), warmup(10), batch(1000), seed(42), counters(false), baseline(), json(false) {
+        for (size_t indx=1000;indx<=10000000;indx*=10) {
+            sizes.push_back(indx);
+        }
+        for (unsigned int indx=0;indx<op_count;indx++) {
+            ops[indx]=true;
+        }
+    }
+};
+
+/*
+ * Keeps the fetched values alive, so the lookups are not optimized out.
+ */
+volatile unsigned long sink;
+
+/*
+ * Cycles, last level cache read misses and branch misses of the calling thread, read as one group, so they cover the same
+ * instructions. Not available, when the kernel or the hardware doesn't support them or perf_event_paranoid forbids them.
+ */
+class perf_counters {
+    int _fd[noCounters];
+    bool _available;
+
+#ifdef __linux__
+    static int open_event(uint32_t _type, uint64_t _config, int _group) {
+        struct perf_event_attr attr;
+        memset(&attr,0,sizeof(attr));
+        attr.size=sizeof(attr);
+        attr.type=_type;
+        attr.config=_config;
+        attr.disabled=_group<0 ? 1 : 0;
+        attr.exclude_kernel=1;
+        attr.exclude_hv=1;
+        attr.read_format=PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(__NR_perf_event_open,&attr,0,-1,_group,0));
+    }
+#endif /* __linux__ */
+
+    void close_all() {
+        for (unsigned int indx=0;indx<noCounters;indx++) {
+            if (_fd[indx]>=0) {
+                close(_fd[indx]);
+                _fd[indx]=-1;
+            }
+        }
+        _available=false;
+    }
+public:
+    explicit perf_counters(bool _enable) : _available(false) {
+        for (unsigned int indx=0;indx<noCounters;indx++) {
+            _fd[indx]=-1;
+        }
+#ifdef __linux__
+        if (!_enable) {
+            return;
+        }
+        _fd[0]=open_event(PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES,-1);
+        if (_fd[0]<0) {
+            return;
+        }
+        _fd[1]=open_event(PERF_TYPE_HW_CACHE,PERF_COUNT_HW_CACHE_LL|(PERF_COUNT_HW_CACHE_OP_READ<<8)|(PERF_COUNT_HW_CACHE_RESULT_MISS<<16),_fd[0]);
+        if (_fd[1]<0) {
+            _fd[1]=open_event(PERF_TYPE_HARDWARE,PERF_COUNT_HW_CACHE_MISSES,_fd[0]);
+        }
+        _fd[2]=open_event(PERF_TYPE_HARDWARE,PERF_COUNT_HW_BRANCH_MISSES,_fd[0]);
+        _available=_fd[1]>=0 && _fd[2]>=0;
+        if (!_available) {
+            close_all();
+        }
+#else
+        (void)_enable;
+#endif /* __linux__ */
+    }
+    ~perf_counters() {
+        close_all();
+    }
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    bool available() const {
+        return _available;
+    }
+    void start() {
+#ifdef __linux__
+        if (_available) {
+            ioctl(_fd[0],PERF_EVENT_IOC_RESET,PERF_IOC_FLAG_GROUP);
+            ioctl(_fd[0],PERF_EVENT_IOC_ENABLE,PERF_IOC_FLAG_GROUP);
+        }
+#endif /* __linux__ */
+    }
+    /*
+     * Adds the counts since the start to the _totals.
+     */
+    void stop(double* _totals) {
+#ifdef __linux__
+        if (_available) {
+            ioctl(_fd[0],PERF_EVENT_IOC_DISABLE,PERF_IOC_FLAG_GROUP);
+            uint64_t data[1+noCounters];
+            if (read(_fd[0],data,sizeof(data))==static_cast<ssize_t>(sizeof(data)) && data[0]==noCounters) {
+                for (unsigned int indx=0;indx<noCounters;indx++) {
+                    _totals[indx]+=static_cast<double>(data[1+indx]);
+                }
+            }
+        }
+#else
+        (void)_totals;
+#endif /* __linux__ */
+    }
+};
+
+/*
+ * Collects the samples of one operation.
+ */
+class sampler {
+    perf_counters& _counters;
+    vector<double> _samples;
+    uint64_t _ops;
+    size_t _batch;
+    double _totals[noCounters];
+public:
+    explicit sampler(perf_counters& _c) : _counters(_c), _samples(), _ops(0), _batch(0) {
+        for (unsigned int indx=0;indx<noCounters;indx++) {
+            _totals[indx]=0;
+        }
+    }
+
+    template <class Body>
+    void measure(size_t _n, Body _body) {
+        _counters.start();
+        chrono::steady_clock::time_point start=chrono::steady_clock::now();
+        _body();
+        chrono::steady_clock::time_point stop=chrono::steady_clock::now();
+        _counters.stop(_totals);
+
+        _samples.push_back(chrono::duration<double,nano>(stop-start).count()/_n);
+        _ops+=_n;
+        _batch=max(_batch,_n);
+    }
+
+    result_type result() {
+        result_type result;
+        memset(&result,0,sizeof(result));
+        if (_samples.empty()) {
+            return result;
+        }
+        sort(_samples.begin(),_samples.end());
+        size_t count=_samples.size();
+        result.valid=true;
+        result.counted=_counters.available();
+        result.samples=count;
+        result.batch=_batch;
+        result.medianNs=count%2 ? _samples[count/2] : (_samples[count/2-1]+_samples[count/2])/2;
+        result.p99Ns=_samples[min(count-1,static_cast<size_t>(ceil(count*0.99))-1)];
+        result.minNs=_samples.front();
+        for (size_t indx=0;indx<count;indx++) {
+            result.meanNs+=_samples[indx]/count;
+        }
+        for (unsigned int indx=0;indx<noCounters;indx++) {
+            result.counters[indx]=_totals[indx]/_ops;
+        }
+        return result;
+    }
+};
+
+/*
+ * Runs _warmup untimed and _repetitions timed samples of _body(sample), calling _restore(sample) after every sample without
+ * the timing.
+ */
+template <class Body, class Restore>
+result_type repeat(const options_type& _options, perf_counters& _counters, size_t _n, Body _body, Restore _restore) {
+    sampler s(_counters);
+    for (size_t indx=0;indx<_options.warmup;indx++) {
+        _body(indx);
+        _restore(indx);
+    }
+    for (size_t indx=_options.warmup;indx<_options.warmup+_options.repetitions;indx++) {
+        s.measure(_n,[&_body,indx]() { _body(indx); });
+        _restore(indx);
+    }
+    return s.result();
+}
+
+template <class Policy, class Container>
+void measure(const options_type& _options, size_t _size, result_type* _results) {
+    typedef cache<unsigned int,unsigned int,Policy,Container> cache_type;
+    perf_counters counters(_options.counters);
+    for (unsigned int indx=0;indx<op_count;indx++) {
+        memset(&_results[indx],0,sizeof(_results[indx]));
+    }
+
+    workload::random random(_options.seed);
+    vector<unsigned int> order(_size);
+    for (size_t indx=0;indx<_size;indx++) {
+        order[indx]=static_cast<unsigned int>(indx);
+    }
+    for (size_t indx=_size-1;indx>0;indx--) {
+        swap(order[indx],order[random.below(indx+1)]);
+    }
+    size_t requests=_options.batch*(_options.warmup+_options.repetitions);
+    vector<unsigned int> present=workload::trace(workload::uniform(static_cast<unsigned int>(_size),_options.seed+1),requests);
+    vector<unsigned int> absent=workload::trace(workload::uniform(static_cast<unsigned int>(_size),_options.seed+2),requests);
+    for (size_t indx=0;indx<requests;indx++) {
+        absent[indx]+=static_cast<unsigned int>(_size);
+    }
+
+    size_t chunk=min(_options.batch,_size);
+    unique_ptr<cache_type> c;
+    {
+        sampler s(counters);
+        if (_options.ops[op_insert] && _options.warmup>0) {
+            size_t warmSize=min(_size,_options.warmup*chunk);
+            cache_type warm(warmSize);
+            for (size_t indx=0;indx<warmSize;indx++) {
+                warm.insert(order[indx],order[indx]);
+            }
+        }
+        size_t chunks=(_size+chunk-1)/chunk;
+        size_t fills=_options.ops[op_insert] ? max<size_t>(1,(_options.repetitions+chunks-1)/chunks) : 1;
+        for (size_t fill=0;fill<fills;fill++) {
+            c.reset();
+            c.reset(new cache_type(_size));
+            cache_type& target=*c;
+            for (size_t from=0;from<_size;from+=chunk) {
+                size_t to=min(from+chunk,_size);
+                auto body=[&target,&order,from,to]() {
+                    for (size_t indx=from;indx<to;indx++) {
+                        target.insert(order[indx],order[indx]);
+                    }
+                };
+                if (_options.ops[op_insert]) {
+                    s.measure(to-from,body);
+                } else {
+                    body();
+                }
+            }
+        }
+        if (c->size()!=_size) {
+            throw runtime_error("Cache doesn't hold all the inserted keys");
+        }
+        _results[op_insert]=s.result();
+    }
+    cache_type& target=*c;
+    size_t batch=_options.batch;
+    auto nothing=[](size_t) { };
+
+    if (_options.ops[op_fetch_hit]) {
+        _results[op_fetch_hit]=repeat(_options,counters,batch,[&target,&present,batch](size_t _sample) {
+            unsigned long sum=0;
+            for (size_t indx=_sample*batch;indx<(_sample+1)*batch;indx++) {
+                sum+=target.fetch(present[indx]);
+            }
+            sink=sum;
+        },nothing);
+    }
+    if (_options.ops[op_fetch_miss]) {
+        _results[op_fetch_miss]=repeat(_options,counters,batch,[&target,&absent,batch](size_t _sample) {
+            unsigned long sum=0;
+            for (size_t indx=_sample*batch;indx<(_sample+1)*batch;indx++) {
+                sum+=target.try_get(absent[indx])!=nullptr;
+            }
+            sink=sum;
+        },nothing);
+    }
+    if (_options.ops[op_touch]) {
+        _results[op_touch]=repeat(_options,counters,batch,[&target,&present,batch](size_t _sample) {
+            for (size_t indx=_sample*batch;indx<(_sample+1)*batch;indx++) {
+                target.touch(present[indx]);
+            }
+        },nothing);
+    }
+    if (_options.ops[op_erase]) {
+        _results[op_erase]=repeat(_options,counters,chunk,[&target,&order,chunk,_size](size_t _sample) {
+            for (size_t indx=0;indx<chunk;indx++) {
+                target.erase(order[(_sample*chunk+indx)%_size]);
+            }
+        },[&target,&order,chunk,_size](size_t _sample) {
+            for (size_t indx=0;indx<chunk;indx++) {
+                unsigned int key=order[(_sample*chunk+indx)%_size];
+                target.insert(key,key);
+            }
+        });
+    }
+    if (_options.ops[op_evict]) {
+        unsigned int next=static_cast<unsigned int>(_size*2);
+        bool evicts=true;
+        try {
+            target.insert(next,next);
+            next++;
+        } catch (const exception_cache_full&) {
+            evicts=false;
+        }
+        if (evicts) {
+            _results[op_evict]=repeat(_options,counters,batch,[&target,&next,batch](size_t) {
+                for (size_t indx=0;indx<batch;indx++) {
+                    target.insert(next,next);
+                    next++;
+                }
+            },nothing);
+        }
+    }
+}
+
+/*
+ * Runs the benchmark in a child process, so every run starts with a fresh heap. Runs in place, when fork fails.
+ */
+template <class Policy, class Container>
+void isolated(const options_type& _options, size_t _size, result_type* _results) {
+    int channel[2];
+    if (pipe(channel)!=0) {
+        measure<Policy,Container>(_options,_size,_results);
+        return;
+    }
+    cout.flush();
+    pid_t child=fork();
+    if (child<0) {
+        close(channel[0]);
+        close(channel[1]);
+        measure<Policy,Container>(_options,_size,_results);
+        return;
+    }
+    if (child==0) {
+        close(channel[0]);
+        result_type results[op_count];
+        try {
+            measure<Policy,Container>(_options,_size,results);
+        } catch (const exception& e) {
+            cerr<<"cache_bench: "<<e.what()<<endl;
+            _exit(1);
+        }
+        ssize_t written=write(channel[1],results,sizeof(results));
+        _exit(written==sizeof(results) ? 0 : 1);
+    }
+
+    close(channel[1]);
+    size_t received=0;
+    size_t expected=sizeof(result_type)*op_count;
+    while (received<expected) {
+        ssize_t count=read(channel[0],reinterpret_cast<char*>(_results)+received,expected-received);
+        if (count<=0) {
+            break;
+        }
+        received+=static_cast<size_t>(count);
+    }
+    close(channel[0]);
+    int status=0;
+    waitpid(child,&status,0);
+    if (received!=expected || !WIFEXITED(status) || WEXITSTATUS(status)!=0) {
+        throw runtime_error("Benchmark process failed");
+    }
+}
+
+/*
+ * Medians of a previous CSV output, by the operation, policy, container and size.
+ */
+class baseline_type {
+    unordered_map<string,double> _medians;
+
+    static vector<string> split(const string& _line) {
+        vector<string> result;
+        istringstream in(_line);
+        string item;
+        while (getline(in,item,',')) {
+            result.push_back(item);
+        }
+        return result;
+    }
+    static size_t column(const vector<string>& _header, const char* _name) {
+        size_t pos=std::find(_header.begin(),_header.end(),_name)-_header.begin();
+        if (pos==_header.size()) {
+            throw runtime_error(string("Baseline has no ")+_name+" column");
+        }
+        return pos;
+    }
+public:
+    static string key(const string& _op, const string& _policy, const string& _container, size_t _size) {
+        ostringstream out;
+        out<<_op<<","<<_policy<<","<<_container<<","<<_size;
+        return out.str();
+    }
+
+    void load(const string& _path) {
+        ifstream in(_path.c_str());
+        string line;
+        if (!in || !getline(in,line)) {
+            throw runtime_error("Can't read baseline "+_path);
+        }
+        vector<string> header=split(line);
+        size_t op=column(header,"op"), policy=column(header,"policy"), container=column(header,"container"), size=column(header,"size"), median=column(header,"median_ns");
+        size_t fields=max(max(max(op,policy),max(container,size)),median)+1;
+        while (getline(in,line)) {
+            vector<string> row=split(line);
+            if (row.size()<fields) {
+                continue;
+            }
+            _medians[key(row[op],row[policy],row[container],strtoull(row[size].c_str(),nullptr,10))]=strtod(row[median].c_str(),nullptr);
+        }
+    }
+    bool empty() const {
+        return _medians.empty();
+    }
+    const double* find(const string& _key) const {
+        unordered_map<string,double>::const_iterator it=_medians.find(_key);
+        return it==_medians.end() ? nullptr : &it->second;
+    }
+};
+
+class runner {
+    const options_type& _options;
+    const baseline_type& _baseline;
+    bool _first;
+
+    static string number(double _value, int _precision) {
+        ostringstream out;
+        out<<fixed<<setprecision(_precision)<<_value;
+        return out.str();
+    }
+
+    void report(const char* _op, const char* _policy, const char* _container, size_t _size, const result_type& _result) {
+        static const char* const counterNames[noCounters]={"cycles_per_op","llc_misses_per_op","branch_misses_per_op"};
+        const char* none=_options.json ? "null" : "";
+        string counters[noCounters];
+        for (unsigned int indx=0;indx<noCounters;indx++) {
+            counters[indx]=_result.counted ? number(_result.counters[indx],2) : none;
+        }
+        const double* base=_baseline.find(baseline_type::key(_op,_policy,_container,_size));
+        string baseMedian=base ? number(*base,2) : none;
+        string change=base && *base>0 ? number((_result.medianNs-*base)/(*base)*100,1) : none;
+
+        if (_options.json) {
+            cout<<(_first ? "[\n  " : ",\n  ")<<"{\"op\":\""<<_op<<"\",\"policy\":\""<<_policy<<"\",\"container\":\""<<_container
+                <<"\",\"size\":"<<_size<<",\"samples\":"<<_result.samples<<",\"batch\":"<<_result.batch<<",\"median_ns\":"<<number(_result.medianNs,2)
+                <<",\"p99_ns\":"<<number(_result.p99Ns,2)<<",\"min_ns\":"<<number(_result.minNs,2)<<",\"mean_ns\":"<<number(_result.meanNs,2);
+            for (unsigned int indx=0;indx<noCounters;indx++) {
+                cout<<",\""<<counterNames[indx]<<"\":"<<counters[indx];
+            }
+            if (!_baseline.empty()) {
+                cout<<",\"baseline_median_ns\":"<<baseMedian<<",\"change_pct\":"<<change;
+            }
+            cout<<"}";
+        } else {
+            cout<<_op<<","<<_policy<<","<<_container<<","<<_size<<","<<_result.samples<<","<<_result.batch<<","<<number(_result.medianNs,2)
+                <<","<<number(_result.p99Ns,2)<<","<<number(_result.minNs,2)<<","<<number(_result.meanNs,2);
+            for (unsigned int indx=0;indx<noCounters;indx++) {
+                cout<<","<<counters[indx];
+            }
+            if (!_baseline.empty()) {
+                cout<<","<<baseMedian<<","<<change;
+            }
+            cout<<"\n";
+        }
+        cout.flush();
+        _first=false;
+    }
+public:
+    runner(const options_type& _o, const baseline_type& _b) : _options(_o), _baseline(_b), _first(true) { }
+
+    void header() {
+        if (!_options.json) {
+            cout<<"op,policy,container,size,samples,batch,median_ns,p99_ns,min_ns,mean_ns,cycles_per_op,llc_misses_per_op,branch_misses_per_op";
+            cout<<(_baseline.empty() ? "\n" : ",baseline_median_ns,change_pct\n");
+        }
+    }
+    void footer() {
+        if (_options.json) {
+            cout<<(_first ? "[]\n" : "\n]\n");
+        }
+    }
+
+    template <class Policy, class Container>
+    void run(const char* _policy, const char* _container) {
+        if (string(_policy).find(_options.policy)==string::npos || string(_container).find(_options.container)==string::npos) {
+            return;
+        }
+        for (size_t indx=0;indx<_options.sizes.size();indx++) {
+            result_type results[op_count];
+            isolated<Policy,Container>(_options,_options.sizes[indx],results);
+            for (unsigned int op=0;op<op_count;op++) {
+                if (results[op].valid) {
+                    report(operationNames[op],_policy,_container,_options.sizes[indx],results[op]);
+                }
+            }
+        }
+    }
+};
+
+template <class Container>
+void policies(runner& _r, const char* _container) {
+    _r.run<policy_none,Container>("policy_none",_container);
+    _r.run<policy_lru,Container>("policy_lru",_container);
+    _r.run<policy_indexed_lru,Container>("policy_indexed_lru",_container);
+    _r.run<policy_mru,Container>("policy_mru",_container);
+    _r.run<policy_lfu,Container>("policy_lfu",_container);
+    _r.run<policy_lfustar,Container>("policy_lfustar",_container);
+    _r.run<policy_lfuaging<1>,Container>("policy_lfuaging<1>",_container);
+    _r.run<policy_lfuagingstar<1>,Container>("policy_lfuagingstar<1>",_container);
+    _r.run<policy_adaptive,Container>("policy_adaptive",_container);
+    _r.run<policy_indexed_adaptive,Container>("policy_indexed_adaptive",_container);
+    _r.run<policy_wtinylfu,Container>("policy_wtinylfu",_container);
+    _r.run<policy_clock,Container>("policy_clock",_container);
+    _r.run<policy_gclock<3>,Container>("policy_gclock<3>",_container);
+    _r.run<policy_sieve,Container>("policy_sieve",_container);
+    _r.run<policy_s3fifo,Container>("policy_s3fifo",_container);
+    _r.run<policy_lirs,Container>("policy_lirs",_container);
+    _r.run<policy_2q,Container>("policy_2q",_container);
+    _r.run<policy_slru<>,Container>("policy_slru<20>",_container);
+    _r.run<policy_sampled_lru<>,Container>("policy_sampled_lru<5>",_container);
+    _r.run<policy_sampled_lfu<>,Container>("policy_sampled_lfu<5>",_container);
+}
+
+void usage() {
+    cerr<<"Usage: cache_bench [--sizes N,N...] [--ops OP,OP...] [--policy NAME] [--container NAME] [--repetitions N] [--warmup N]"
+        <<" [--batch N] [--seed N] [--counters] [--baseline CSV] [--format csv|json]"<<endl;
+}
+
+uint64_t parse_number(const string& _item, bool _zero = false) {
+    char* end=nullptr;
+    unsigned long long number=strtoull(_item.c_str(),&end,10);
+    if (_item.empty() || *end!='\0' || (number==0 && !_zero)) {
+        throw runtime_error("Invalid number "+_item);
+    }
+    return number;
+}
+
+vector<size_t> parse_sizes(const string& _list) {
+    vector<size_t> result;
+    istringstream in(_list);
+    string item;
+    while (getline(in,item,',')) {
+        uint64_t size=parse_number(item);
+        if (size>0x3FFFFFFF) {
+            throw runtime_error("Size "+item+" is too large");
+        }
+        result.push_back(static_cast<size_t>(size));
+    }
+    return result;
+}
+
+void parse_ops(const string& _list, bool* _ops) {
+    for (unsigned int indx=0;indx<op_count;indx++) {
+        _ops[indx]=false;
+    }
+    istringstream in(_list);
+    string item;
+    while (getline(in,item,',')) {
+        unsigned int op=static_cast<unsigned int>(find(operationNames,operationNames+op_count,item)-operationNames);
+        if (op==op_count) {
+            throw runtime_error("Unknown operation "+item);
+        }
+        _ops[op]=true;
+    }
+}
+
+int main(int argc, char** argv) {
+    options_type options;
+    try {
+        for (int indx=1;indx<argc;indx++) {
+            string arg(argv[indx]);
+            bool hasValue=indx+1<argc;
+            if (arg=="--sizes" && hasValue) {
+                options.sizes=parse_sizes(argv[++indx]);
+            } else if (arg=="--ops" && hasValue) {
+                parse_ops(argv[++indx],options.ops);
+            } else if (arg=="--policy" && hasValue) {
+                options.policy=argv[++indx];
+            } else if (arg=="--container" && hasValue) {
+                options.container=argv[++indx];
+            } else if (arg=="--repetitions" && hasValue) {
+                options.repetitions=static_cast<size_t>(parse_number(argv[++indx]));
+            } else if (arg=="--warmup" && hasValue) {
+                options.warmup=static_cast<size_t>(parse_number(argv[++indx],true));
+            } else if (arg=="--batch" && hasValue) {
+                options.batch=static_cast<size_t>(parse_number(argv[++indx]));
+            } else if (arg=="--seed" && hasValue) {
+                options.seed=parse_number(argv[++indx],true);
+            } else if (arg=="--counters") {
+                options.counters=true;
+            } else if (arg=="--baseline" && hasValue) {
+                options.baseline=argv[++indx];
+            } else if (arg=="--format" && hasValue) {
+                string format(argv[++indx]);
+                if (format!="csv" && format!="json") {
+                    throw runtime_error("Unknown format "+format);
+                }
+                options.json=format=="json";
+            } else {
+                usage();
+                return 2;
+            }
+        }
+
+        if (options.counters && !perf_counters(true).available()) {
+            cerr<<"cache_bench: hardware counters are not available, check the kernel.perf_event_paranoid setting"<<endl;
+            options.counters=false;
+        }
+        baseline_type baseline;
+        if (!options.baseline.empty()) {
+            baseline.load(options.baseline);
+        }
+
+        runner r(options,baseline);
+        r.header();
+        policies<container_unordered_map>(r,"container_unordered_map");
+        policies<container_map>(r,"container_map");
+        policies<container_flat_hash_map>(r,"container_flat_hash_map");
+        r.footer();
+    } catch (const exception& e) {
+        cerr<<"cache_bench: "<<e.what()<<endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,507 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+/*
+ * Replays key access traces through every policy and container at several capacities and reports the hit ratio, the time per
+ * request and the resident memory of every run as CSV or JSON.
+ *
+ *     cache_replay [options] trace...
+ *
+ *     --sizes 1000,10000    capacities in entries, by default 1%, 5%, 10% and 25% of the distinct keys of every trace
+ *     --policy lfu          runs only the policies, whose names contain the string
+ *     --container map       runs only the containers, whose names contain the string
+ *     --format csv|json     output format, csv by default
+ *     --convert out.trace   writes the first trace in the binary format and exits
+ *     --synthetic zipf      adds a generated trace: zipf, uniform, scan, loop, mixed (zipf with periodic scans) or shifting
+ *                           (zipf with the hot keys moving every tenth of the trace), may be repeated
+ *     --keys 100000         distinct keys of the generated traces
+ *     --requests 1000000    length of the generated traces
+ *     --skew 0.9            zipf skew of the generated traces
+ *     --seed 42             seed of the generated traces
+ *
+ * Text traces have a key per line: the first whitespace separated token of the line, empty lines and lines, starting with #, are skipped.
+ * Binary traces start with the "STLCTRC1" magic, followed by the keys as unsigned LEB128 varints. Keys are mapped to dense integers,
+ * when the trace is loaded, so every run replays the same integer keys and the timings don't depend on the key format.
+ *
+ * Every request is looked up with try_get and inserted on a miss, so ns/op covers the hits, the misses, the inserts and the evictions.
+ * Every run is forked into it's own process, so peak_rss_kb is the peak of that run alone and replay_rss_kb is it's growth over the
+ * loaded trace. The aging policies age every second of the run, as they are driven by the wall clock.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <stlcache/stlcache.hpp>
+
+#include "workload.hpp"
+
+using namespace stlcache;
+using namespace std;
+
+static const char traceMagic[8] = {'S','T','L','C','T','R','C','1'};
+
+struct trace_type {
+    string name;
+    vector<unsigned int> keys;
+    size_t distinct;
+};
+
+struct result_type {
+    uint64_t hits;
+    double nsPerOp;
+    long peakKb;
+    long replayKb;
+};
+
+struct options_type {
+    vector<size_t> sizes;
+    string policy;
+    string container;
+    bool json;
+    string convert;
+    vector<string> files;
+    vector<string> synthetic;
+    unsigned int keys;
+    size_t requests;
+    double skew;
+    uint64_t seed;
+
+    options_type() : sizes(), policy(), container(), json(false), convert(), files(), synthetic(), keys(100000), requests(1000000), skew(0.9), seed(42) { }
+};
+
+/*
+ * Maps the keys of a trace to dense integers, in the order of their first appearance.
+ */
+template <class Key>
+class interner {
+    unordered_map<Key,unsigned int> _ids;
+public:
+    unsigned int operator()(const Key& _k) {
+        typename unordered_map<Key,unsigned int>::iterator it=_ids.find(_k);
+        if (it!=_ids.end()) {
+            return it->second;
+        }
+        unsigned int id=static_cast<unsigned int>(_ids.size());
+        _ids.insert(make_pair(_k,id));
+        return id;
+    }
+    size_t size() const {
+        return _ids.size();
+    }
+};
+
+string basename(const string& _path) {
+    size_t pos=_path.find_last_of('/');
+    return pos==string::npos ? _path : _path.substr(pos+1);
+}
+
+trace_type load(const string& _path) {
+    ifstream in(_path.c_str(),ios::in|ios::binary);
+    if (!in) {
+        throw runtime_error("Can't open trace "+_path);
+    }
+    trace_type trace;
+    trace.name=basename(_path);
+
+    char magic[sizeof(traceMagic)];
+    in.read(magic,sizeof(magic));
+    if (in.gcount()==sizeof(magic) && memcmp(magic,traceMagic,sizeof(magic))==0) {
+        interner<uint64_t> ids;
+        uint64_t key=0;
+        unsigned int shift=0;
+        int c;
+        while ((c=in.get())!=EOF) {
+            key|=static_cast<uint64_t>(c&0x7F)<<shift;
+            if (c&0x80) {
+                shift+=7;
+                if (shift>=64) {
+                    throw runtime_error("Malformed varint in trace "+_path);
+                }
+                continue;
+            }
+            trace.keys.push_back(ids(key));
+            key=0;
+            shift=0;
+        }
+        if (shift!=0) {
+            throw runtime_error("Truncated varint in trace "+_path);
+        }
+        trace.distinct=ids.size();
+        return trace;
+    }
+
+    in.clear();
+    in.seekg(0);
+    interner<string> ids;
+    string line;
+    while (getline(in,line)) {
+        istringstream fields(line);
+        string key;
+        if (!(fields>>key) || key[0]=='#') {
+            continue;
+        }
+        trace.keys.push_back(ids(key));
+    }
+    trace.distinct=ids.size();
+    return trace;
+}
+
+/*
+ * Generates a trace with the tests/workload.hpp generators.
+ */
+trace_type synthetic(const string& _name, const options_type& _options) {
+    trace_type trace;
+    trace.name=_name;
+    if (_name=="zipf") {
+        trace.keys=workload::trace(workload::zipf(_options.keys,_options.skew,_options.seed),_options.requests);
+    } else if (_name=="uniform") {
+        trace.keys=workload::trace(workload::uniform(_options.keys,_options.seed),_options.requests);
+    } else if (_name=="scan") {
+        trace.keys=workload::trace(workload::scan(0),_options.requests);
+    } else if (_name=="loop") {
+        trace.keys=workload::trace(workload::loop(_options.keys),_options.requests);
+    } else if (_name=="mixed") {
+        trace.keys=workload::trace(workload::mixed(_options.keys,_options.skew,20000,5000,_options.seed),_options.requests);
+    } else if (_name=="shifting") {
+        unsigned int period=static_cast<unsigned int>(max<size_t>(_options.requests/10,1));
+        trace.keys=workload::trace(workload::shifting(_options.keys,_options.skew,period,_options.keys/10,_options.seed),_options.requests);
+    } else {
+        throw runtime_error("Unknown synthetic trace "+_name);
+    }
+    vector<unsigned int> distinct(trace.keys);
+    sort(distinct.begin(),distinct.end());
+    trace.distinct=static_cast<size_t>(unique(distinct.begin(),distinct.end())-distinct.begin());
+    return trace;
+}
+
+void convert(const trace_type& _trace, const string& _path) {
+    ofstream out(_path.c_str(),ios::out|ios::binary|ios::trunc);
+    out.write(traceMagic,sizeof(traceMagic));
+    for (size_t indx=0;indx<_trace.keys.size();indx++) {
+        uint64_t key=_trace.keys[indx];
+        while (key>=0x80) {
+            out.put(static_cast<char>((key&0x7F)|0x80));
+            key>>=7;
+        }
+        out.put(static_cast<char>(key));
+    }
+    if (!out) {
+        throw runtime_error("Can't write trace "+_path);
+    }
+}
+
+/*
+ * Current and peak resident set sizes of the process, from the /proc/self/status on Linux and from the getrusage otherwise.
+ */
+long status_kb(const char* _field) {
+    ifstream in("/proc/self/status");
+    string line;
+    size_t length=strlen(_field);
+    while (getline(in,line)) {
+        if (line.compare(0,length,_field)==0) {
+            return atol(line.c_str()+length);
+        }
+    }
+    return -1;
+}
+long resident_kb() {
+    return status_kb("VmRSS:");
+}
+long peak_resident_kb() {
+    long peak=status_kb("VmHWM:");
+    if (peak<0) {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF,&usage);
+        peak=usage.ru_maxrss;
+    }
+    return peak;
+}
+
+template <class Policy, class Container>
+result_type replay(const trace_type& _trace, size_t _capacity) {
+    result_type result;
+    long before=resident_kb();
+    cache<unsigned int,unsigned int,Policy,Container> c(_capacity);
+    uint64_t hits=0;
+
+    chrono::steady_clock::time_point start=chrono::steady_clock::now();
+    for (size_t indx=0;indx<_trace.keys.size();indx++) {
+        unsigned int key=_trace.keys[indx];
+        if (c.try_get(key)) {
+            hits++;
+            continue;
+        }
+        try {
+            c.insert(key,key);
+        } catch (const exception_cache_full&) {
+        }
+    }
+    chrono::steady_clock::time_point stop=chrono::steady_clock::now();
+
+    result.hits=hits;
+    result.nsPerOp=_trace.keys.empty() ? 0.0 : chrono::duration<double,nano>(stop-start).count()/_trace.keys.size();
+    result.peakKb=peak_resident_kb();
+    result.replayKb=before<0 ? -1 : result.peakKb-before;
+    return result;
+}
+
+/*
+ * Runs the replay in a child process, so the peak memory of one run doesn't hide the others. Runs in place, when fork fails.
+ */
+template <class Policy, class Container>
+result_type isolated(const trace_type& _trace, size_t _capacity) {
+    int channel[2];
+    if (pipe(channel)!=0) {
+        return replay<Policy,Container>(_trace,_capacity);
+    }
+    cout.flush();
+    pid_t child=fork();
+    if (child<0) {
+        close(channel[0]);
+        close(channel[1]);
+        return replay<Policy,Container>(_trace,_capacity);
+    }
+    if (child==0) {
+        close(channel[0]);
+        result_type result=replay<Policy,Container>(_trace,_capacity);
+        ssize_t written=write(channel[1],&result,sizeof(result));
+        _exit(written==sizeof(result) ? 0 : 1);
+    }
+
+    close(channel[1]);
+    result_type result;
+    size_t received=0;
+    while (received<sizeof(result)) {
+        ssize_t count=read(channel[0],reinterpret_cast<char*>(&result)+received,sizeof(result)-received);
+        if (count<=0) {
+            break;
+        }
+        received+=static_cast<size_t>(count);
+    }
+    close(channel[0]);
+    int status=0;
+    waitpid(child,&status,0);
+    if (received!=sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status)!=0) {
+        throw runtime_error("Replay process failed");
+    }
+    return result;
+}
+
+class runner {
+    const options_type& _options;
+    const vector<trace_type>& _traces;
+    bool _first;
+
+    string escape(const string& _s) const {
+        string result;
+        for (size_t indx=0;indx<_s.size();indx++) {
+            if (_s[indx]=='"' || _s[indx]=='\\') {
+                result+='\\';
+            }
+            result+=_s[indx];
+        }
+        return result;
+    }
+
+    static string number(double _value, int _precision) {
+        ostringstream out;
+        out<<fixed<<setprecision(_precision)<<_value;
+        return out.str();
+    }
+
+    vector<size_t> sizes(const trace_type& _trace) const {
+        if (!_options.sizes.empty()) {
+            return _options.sizes;
+        }
+        static const size_t percents[]={1,5,10,25};
+        vector<size_t> result;
+        for (size_t indx=0;indx<sizeof(percents)/sizeof(percents[0]);indx++) {
+            size_t size=max<size_t>(1,_trace.distinct*percents[indx]/100);
+            if (result.empty() || result.back()!=size) {
+                result.push_back(size);
+            }
+        }
+        return result;
+    }
+
+    void report(const trace_type& _trace, const char* _policy, const char* _container, size_t _capacity, const result_type& _result) {
+        string hitRatio=number(_trace.keys.empty() ? 0.0 : double(_result.hits)/_trace.keys.size(),6);
+        string nsPerOp=number(_result.nsPerOp,2);
+
+        if (_options.json) {
+            cout<<(_first ? "[\n  " : ",\n  ")<<"{\"trace\":\""<<escape(_trace.name)<<"\",\"policy\":\""<<_policy<<"\",\"container\":\""<<_container
+                <<"\",\"capacity\":"<<_capacity<<",\"requests\":"<<_trace.keys.size()<<",\"hits\":"<<_result.hits<<",\"hit_ratio\":"<<hitRatio
+                <<",\"ns_per_op\":"<<nsPerOp<<",\"peak_rss_kb\":"<<_result.peakKb<<",\"replay_rss_kb\":"<<_result.replayKb<<"}";
+        } else {
+            cout<<_trace.name<<","<<_policy<<","<<_container<<","<<_capacity<<","<<_trace.keys.size()<<","<<_result.hits<<","<<hitRatio
+                <<","<<nsPerOp<<","<<_result.peakKb<<","<<_result.replayKb<<"\n";
+        }
+        cout.flush();
+        _first=false;
+    }
+public:
+    runner(const options_type& _o, const vector<trace_type>& _t) : _options(_o), _traces(_t), _first(true) { }
+
+    void header() {
+        if (!_options.json) {
+            cout<<"trace,policy,container,capacity,requests,hits,hit_ratio,ns_per_op,peak_rss_kb,replay_rss_kb\n";
+        }
+    }
+    void footer() {
+        if (_options.json) {
+            cout<<(_first ? "[]\n" : "\n]\n");
+        }
+    }
+
+    template <class Policy, class Container>
+    void run(const char* _policy, const char* _container) {
+        if (string(_policy).find(_options.policy)==string::npos || string(_container).find(_options.container)==string::npos) {
+            return;
+        }
+        for (size_t trace=0;trace<_traces.size();trace++) {
+            vector<size_t> capacities=sizes(_traces[trace]);
+            for (size_t indx=0;indx<capacities.size();indx++) {
+                result_type result=isolated<Policy,Container>(_traces[trace],capacities[indx]);
+                report(_traces[trace],_policy,_container,capacities[indx],result);
+            }
+        }
+    }
+};
+
+template <class Container>
+void policies(runner& _r, const char* _container) {
+    _r.run<policy_none,Container>("policy_none",_container);
+    _r.run<policy_lru,Container>("policy_lru",_container);
+    _r.run<policy_indexed_lru,Container>("policy_indexed_lru",_container);
+    _r.run<policy_mru,Container>("policy_mru",_container);
+    _r.run<policy_lfu,Container>("policy_lfu",_container);
+    _r.run<policy_lfustar,Container>("policy_lfustar",_container);
+    _r.run<policy_lfuaging<1>,Container>("policy_lfuaging<1>",_container);
+    _r.run<policy_lfuagingstar<1>,Container>("policy_lfuagingstar<1>",_container);
+    _r.run<policy_adaptive,Container>("policy_adaptive",_container);
+    _r.run<policy_indexed_adaptive,Container>("policy_indexed_adaptive",_container);
+    _r.run<policy_wtinylfu,Container>("policy_wtinylfu",_container);
+    _r.run<policy_clock,Container>("policy_clock",_container);
+    _r.run<policy_gclock<3>,Container>("policy_gclock<3>",_container);
+    _r.run<policy_sieve,Container>("policy_sieve",_container);
+    _r.run<policy_s3fifo,Container>("policy_s3fifo",_container);
+    _r.run<policy_lirs,Container>("policy_lirs",_container);
+    _r.run<policy_2q,Container>("policy_2q",_container);
+    _r.run<policy_slru<>,Container>("policy_slru<20>",_container);
+    _r.run<policy_sampled_lru<>,Container>("policy_sampled_lru<5>",_container);
+    _r.run<policy_sampled_lfu<>,Container>("policy_sampled_lfu<5>",_container);
+}
+
+void usage() {
+    cerr<<"Usage: cache_replay [--sizes N,N...] [--policy NAME] [--container NAME] [--format csv|json] [--convert OUT]"
+        <<" [--synthetic NAME] [--keys N] [--requests N] [--skew S] [--seed N] trace..."<<endl;
+}
+
+uint64_t parse_number(const string& _item) {
+    char* end=nullptr;
+    unsigned long long number=strtoull(_item.c_str(),&end,10);
+    if (_item.empty() || *end!='\0' || number==0) {
+        throw runtime_error("Invalid number "+_item);
+    }
+    return number;
+}
+
+vector<size_t> parse_sizes(const string& _list) {
+    vector<size_t> result;
+    istringstream in(_list);
+    string item;
+    while (getline(in,item,',')) {
+        result.push_back(static_cast<size_t>(parse_number(item)));
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    options_type options;
+    try {
+        for (int indx=1;indx<argc;indx++) {
+            string arg(argv[indx]);
+            bool hasValue=indx+1<argc;
+            if (arg=="--sizes" && hasValue) {
+                options.sizes=parse_sizes(argv[++indx]);
+            } else if (arg=="--policy" && hasValue) {
+                options.policy=argv[++indx];
+            } else if (arg=="--container" && hasValue) {
+                options.container=argv[++indx];
+            } else if (arg=="--format" && hasValue) {
+                string format(argv[++indx]);
+                if (format!="csv" && format!="json") {
+                    throw runtime_error("Unknown format "+format);
+                }
+                options.json=format=="json";
+            } else if (arg=="--convert" && hasValue) {
+                options.convert=argv[++indx];
+            } else if (arg=="--synthetic" && hasValue) {
+                options.synthetic.push_back(argv[++indx]);
+            } else if (arg=="--keys" && hasValue) {
+                options.keys=static_cast<unsigned int>(parse_number(argv[++indx]));
+            } else if (arg=="--requests" && hasValue) {
+                options.requests=static_cast<size_t>(parse_number(argv[++indx]));
+            } else if (arg=="--skew" && hasValue) {
+                char* end=nullptr;
+                options.skew=strtod(argv[++indx],&end);
+                if (*end!='\0' || !(options.skew>0)) {
+                    throw runtime_error(string("Invalid skew ")+argv[indx]);
+                }
+            } else if (arg=="--seed" && hasValue) {
+                options.seed=parse_number(argv[++indx]);
+            } else if (arg.compare(0,2,"--")==0) {
+                usage();
+                return 2;
+            } else {
+                options.files.push_back(arg);
+            }
+        }
+        if (options.files.empty() && options.synthetic.empty()) {
+            usage();
+            return 2;
+        }
+
+        vector<trace_type> traces;
+        for (size_t indx=0;indx<options.files.size();indx++) {
+            traces.push_back(load(options.files[indx]));
+        }
+        for (size_t indx=0;indx<options.synthetic.size();indx++) {
+            traces.push_back(synthetic(options.synthetic[indx],options));
+        }
+        if (!options.convert.empty()) {
+            convert(traces.front(),options.convert);
+            return 0;
+        }
+
+        runner r(options,traces);
+        r.header();
+        policies<container_unordered_map>(r,"container_unordered_map");
+        policies<container_map>(r,"container_map");
+        policies<container_flat_hash_map>(r,"container_flat_hash_map");
+        r.footer();
+    } catch (const exception& e) {
+        cerr<<"cache_replay: "<<e.what()<<endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_TESTS_COPY_AND_SWAP_HPP_INCLUDED
+#define STLCACHE_TESTS_COPY_AND_SWAP_HPP_INCLUDED
+
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+/*
+ * Fills a cache with the policy, then copies, assigns and swaps it. The copy, the assigned cache and the one, that got the contents by
+ * the swap, must make the same decisions on a common key stream, and the swapped out cache must be empty.
+ */
+template <class Policy>
+void checkCopyAndSwap() {
+    typedef stlcache::cache<int,int,Policy> cacheType;
+
+    cacheType c1(10);
+    for (int k=0;k<30;k++) {
+        c1.insert(k%15,k); //Every key comes back once
+        c1.touch(k%5);
+    }
+
+    cacheType c2(c1);
+    cacheType c3(10);
+    c3=c1;
+    cacheType c4(10);
+    c4.swap(c1);
+    BOOST_CHECK(c1.empty());
+
+    bool same=true;
+    for (int k=0;k<200;k++) {
+        int key=(k*7)%40;
+        bool hit2=c2.check(key);
+        same=same && hit2==c3.check(key) && hit2==c4.check(key);
+        if (!hit2) {
+            c2.insert(key,k);
+            c3.insert(key,k);
+            c4.insert(key,k);
+        } else if (k%3==0) {
+            c2.touch(key);
+            c3.touch(key);
+            c4.touch(key);
+        }
+    }
+    BOOST_CHECK(same);
+    BOOST_CHECK(c2.size()==10 && c3.size()==10 && c4.size()==10);
+}
+
+#endif /* STLCACHE_TESTS_COPY_AND_SWAP_HPP_INCLUDED */
@@ -0,0 +1,112 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCachePolicy2Q"
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+#include "copy_and_swap.hpp"
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(checkVictim) {
+    cache<int,string,policy_2q> c1(4); //A1in takes one entry, A1out remembers two keys
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.insert(4,"data4");
+    c1.touch(1); //Does nothing in A1in
+
+    c1.insert(5,"data5"); //A1in is over it's share, key1 is expired into A1out
+    BOOST_REQUIRE_THROW(c1.fetch(1),exception_invalid_key);
+
+    c1.insert(1,"data1"); //Key2 is expired and key1 comes back into Am
+    BOOST_CHECK(c1.count(2)==0);
+
+    for (int k=10;k<100;k++) { //The scan only passes through A1in
+        c1.insert(k,"data");
+    }
+    BOOST_CHECK(c1.count(1)==1);
+    BOOST_CHECK(c1.size()==4);
+}
+
+BOOST_AUTO_TEST_CASE(ghostQueue) {
+    cache<int,string,policy_2q> c1(4);
+
+    for (int k=1;k<8;k++) {
+        c1.insert(k,"data"); //Keys 1,2 and 3 are expired, A1out forgets key1
+    }
+
+    c1.insert(3,"data3"); //Remembered in A1out, goes to Am
+    c1.insert(1,"data1"); //Forgotten, goes to A1in again
+    for (int k=10;k<30;k++) {
+        c1.insert(k,"data");
+    }
+    BOOST_CHECK(c1.count(3)==1);
+    BOOST_CHECK(c1.count(1)==0);
+}
+
+BOOST_AUTO_TEST_CASE(eraseAndChurn) {
+    cache<int,int,policy_2q> c1(100);
+
+    unsigned int seed=42;
+    for (int indx=0;indx<50000;indx++) {
+        seed=seed*1103515245+12345;
+        int k=(seed>>16)%(indx%5000<2500 ? 150 : 1000);
+        if (k%11==0) {
+            c1.erase(k);
+        } else if (!c1.check(k)) {
+            c1.insert(k,k);
+        }
+    }
+    BOOST_CHECK(c1.size()<=100);
+    for (int k=2000;k<2200;k++) {
+        c1.insert(k,k);
+    }
+    BOOST_CHECK(c1.size()==100);
+    BOOST_CHECK(c1.count(2199)==1);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    checkCopyAndSwap<policy_2q>();
+}
+
+BOOST_AUTO_TEST_CASE(copyGhostQueue) {
+    cache<int,string,policy_2q> c1(4);
+
+    for (int k=1;k<8;k++) {
+        c1.insert(k,"data"); //A1out remembers key2 and key3, key2 is forgotten by the next expiration
+    }
+
+    cache<int,string,policy_2q> c2(c1);
+    c2.insert(3,"data3"); //Remembered by the copied A1out, goes to Am
+    for (int k=10;k<30;k++) {
+        c2.insert(k,"data");
+    }
+    BOOST_CHECK(c2.count(3)==1);
+
+    cache<int,string,policy_2q> c3(4);
+    c3=c1;
+    c3.insert(3,"data3");
+    for (int k=10;k<30;k++) {
+        c3.insert(k,"data");
+    }
+    BOOST_CHECK(c3.count(3)==1);
+
+    c1.insert(3,"data3"); //The original A1out still has key3
+    for (int k=10;k<30;k++) {
+        c1.insert(k,"data");
+    }
+    BOOST_CHECK(c1.count(3)==1);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,101 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheAccessPerformance"
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <stlcache/stlcache.hpp>
+
+#include "workload.hpp"
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+const unsigned int noItems = 65536;
+const unsigned int noRequests = 1000000;
+
+enum access_type { access_fetch, access_touch, access_try_get };
+
+/*
+ * Keeps the fetched values alive, so the lookups are not optimized out.
+ */
+volatile unsigned long sink;
+
+/*
+ * Cost of the policy bookkeeping on a hit: the cache holds all the keys, so every request is served from it and nothing is evicted.
+ */
+template <class Policy>
+void access(const char* name, access_type type, const vector<unsigned int>& trace) {
+    cache<unsigned int,unsigned int,Policy> c(noItems);
+    for (unsigned int indx=0;indx<noItems;indx++) {
+        c.insert(indx,indx);
+    }
+    unsigned long sum=0;
+
+    chrono::steady_clock::time_point start=chrono::steady_clock::now();
+    for (unsigned int indx=0;indx<trace.size();indx++) {
+        switch (type) {
+            case access_fetch:
+                sum+=c.fetch(trace[indx]);
+                break;
+            case access_touch:
+                c.touch(trace[indx]);
+                break;
+            case access_try_get:
+                sum+=*c.try_get(trace[indx]);
+                break;
+        }
+    }
+    chrono::steady_clock::time_point stop=chrono::steady_clock::now();
+    sink=sum;
+
+    double ns=chrono::duration<double,nano>(stop-start).count()/trace.size();
+    cout<<setw(24)<<name<<": "<<fixed<<setprecision(1)<<ns<<" ns/op"<<endl;
+}
+
+void compare(const char* title, access_type type) {
+    vector<unsigned int> trace=workload::trace(workload::zipf(noItems,0.9,42),noRequests);
+    cout<<title<<" on the zipf trace:"<<endl;
+    access<policy_none>("policy_none",type,trace);
+    access<policy_lru>("policy_lru",type,trace);
+    access<policy_mru>("policy_mru",type,trace);
+    access<policy_lfu>("policy_lfu",type,trace);
+    access<policy_lfustar>("policy_lfustar",type,trace);
+    access<policy_lfuaging<3600> >("policy_lfuaging<3600>",type,trace);
+    access<policy_adaptive>("policy_adaptive",type,trace);
+    access<policy_indexed_adaptive>("policy_indexed_adaptive",type,trace);
+    access<policy_wtinylfu>("policy_wtinylfu",type,trace);
+    access<policy_clock>("policy_clock",type,trace);
+    access<policy_gclock<3> >("policy_gclock<3>",type,trace);
+    access<policy_sieve>("policy_sieve",type,trace);
+    access<policy_s3fifo>("policy_s3fifo",type,trace);
+    access<policy_lirs>("policy_lirs",type,trace);
+    access<policy_2q>("policy_2q",type,trace);
+    access<policy_slru<> >("policy_slru<20>",type,trace);
+    access<policy_sampled_lru<> >("policy_sampled_lru<5>",type,trace);
+    access<policy_sampled_lfu<> >("policy_sampled_lfu<5>",type,trace);
+}
+
+BOOST_AUTO_TEST_CASE(fetch) {
+    compare("fetch",access_fetch);
+}
+
+BOOST_AUTO_TEST_CASE(touch) {
+    compare("touch",access_touch);
+}
+
+BOOST_AUTO_TEST_CASE(tryGet) {
+    compare("try_get",access_try_get);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -10,6 +10,8 @@
 
 #include <stlcache/stlcache.hpp>
 
+#include "copy_and_swap.hpp"
+
 using namespace stlcache;
 using namespace std;
 
@@ -49,11 +51,12 @@ BOOST_AUTO_TEST_CASE(checkPointerMoveT2) {
 
     c1.touch(3);
 	c1.touch(3);
-	c1.touch(1);// T2 list is bigger now and key1 have lower reference count
+	c1.touch(1);// T2 list is bigger now, but T1 is still above it's target size
 
     c1.insert(4,"data4");
 
-    BOOST_REQUIRE_THROW(c1.fetch(1),exception_invalid_key);
+    BOOST_REQUIRE_THROW(c1.fetch(2),exception_invalid_key);
+    BOOST_CHECK(c1.check(1));
 }
 
 BOOST_AUTO_TEST_CASE(checkPointerSaveB1) {
@@ -85,10 +88,81 @@ BOOST_AUTO_TEST_CASE(checkPointerSaveB2) {
 	c1.touch(4);
 	c1.touch(4);
 
-	c1.insert(5,"data5");
-	c1.insert(1,"data3");
+	c1.insert(5,"data5"); //key1 is moved to B2
+	c1.insert(1,"data3"); //key1 is restored from B2 and key5 moved to B1 (out of cache)
 
-    BOOST_REQUIRE_THROW(c1.fetch(2),exception_invalid_key); //key1 is restored from B1 and key2 moved to B1 (out of cache)
+    BOOST_REQUIRE_THROW(c1.fetch(5),exception_invalid_key);
+    BOOST_CHECK(c1.check(1) && c1.check(2));
+}
+
+BOOST_AUTO_TEST_CASE(ghostHitOnCheck) {
+    cache<int,string,policy_adaptive> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.touch(1);
+    c1.touch(2); //T2 holds key2 and key1
+    c1.insert(3,"data3");
+    c1.insert(4,"data4"); //key3 is moved to B1
+
+    BOOST_CHECK(!c1.check(3)); //The ghost hit grows the T1 target before the insertion
+    c1.insert(3,"data3");
+
+    BOOST_REQUIRE_THROW(c1.fetch(1),exception_invalid_key);
+    BOOST_CHECK(c1.check(4) && c1.check(3));
+}
+
+BOOST_AUTO_TEST_CASE(indexedMatchesDefault) {
+    cache<unsigned int,unsigned int,policy_adaptive> c1(100);
+    cache<unsigned int,unsigned int,policy_indexed_adaptive> c2(100);
+
+    unsigned int seed=42;
+    bool same=true;
+    for (unsigned int indx=0;indx<20000;indx++) {
+        seed=seed*1103515245+12345;
+        unsigned int k=(seed>>16)%(indx%2000<1000 ? 150 : 400);
+        if (k%13==0) {
+            c1.erase(k);
+            c2.erase(k);
+        } else if (!c1.check(k)) {
+            c1.insert(k,indx);
+            same=same && !c2.check(k);
+            c2.insert(k,indx);
+        } else {
+            same=same && c2.check(k);
+        }
+    }
+    BOOST_CHECK(same);
+    BOOST_CHECK(c1.size()==c2.size());
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    checkCopyAndSwap<policy_adaptive>();
+    checkCopyAndSwap<policy_indexed_adaptive>();
+}
+
+BOOST_AUTO_TEST_CASE(copyTarget) {
+    cache<int,string,policy_indexed_adaptive> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.touch(1);
+    c1.touch(2); //T2 holds key2 and key1
+    c1.insert(3,"data3");
+    c1.insert(4,"data4"); //key3 is moved to B1
+    BOOST_CHECK(!c1.check(3)); //The ghost hit grows the T1 target
+
+    cache<int,string,policy_indexed_adaptive> c2(c1);
+    cache<int,string,policy_indexed_adaptive> c3(3);
+    c3=c1;
+
+    c2.insert(3,"data3"); //With the copied target T1 keeps key4 and T2 expires key1
+    c3.insert(3,"data3");
+    BOOST_CHECK(c2.count(1)==0 && c2.count(4)==1);
+    BOOST_CHECK(c3.count(1)==0 && c3.count(4)==1);
+
+    c1.clear(); //The copies don't share the lists
+    BOOST_CHECK(c2.check(2) && c2.check(3));
 }
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,158 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheAllocator"
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+/*
+ * Runs the same trace through the caches and checks, that they hold the same keys after every step.
+ */
+template <class Cache1, class Cache2>
+void compare(Cache1& c1, Cache2& c2) {
+    unsigned int seed=42;
+    for (int indx=0;indx<20000;indx++) {
+        seed=seed*1103515245+12345;
+        int k=(seed>>16)%300;
+        if (c1.check(k)) {
+            BOOST_REQUIRE(c2.check(k));
+        } else {
+            BOOST_REQUIRE(!c2.check(k));
+            if ((seed>>8)%7==0) {
+                c1.erase(k/2);
+                c2.erase(k/2);
+            } else {
+                c1.insert(k,k);
+                c2.insert(k,k);
+            }
+        }
+        BOOST_REQUIRE_EQUAL(c1.size(),c2.size());
+    }
+    for (int k=0;k<300;k++) {
+        BOOST_REQUIRE_EQUAL(c1.count(k),c2.count(k));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(poolReuse) {
+    _pool_allocator<int> a1;
+    _pool_allocator<long> a2(a1);
+    _pool_allocator<int> a3;
+    BOOST_CHECK(a1==a2);
+    BOOST_CHECK(a1!=a3);
+
+    int* p1=a1.allocate(1);
+    a1.deallocate(p1,1);
+    int* p2=a1.allocate(1);
+    BOOST_CHECK(p1==p2); //Freed node is reused
+    a1.deallocate(p2,1);
+
+    int* p3=a1.allocate(100); //Arrays go to the operator new
+    p3[99]=1;
+    a1.deallocate(p3,100);
+}
+
+BOOST_AUTO_TEST_CASE(sameEvictions) {
+    cache<int,int,policy_lru> c1(100);
+    cache<int,int,policy_lru,container_unordered_map,weigher_unit,allocator_pool> c2(100);
+    compare(c1,c2);
+
+    cache<int,int,policy_lfu,container_map> c3(100);
+    cache<int,int,policy_lfu,container_map,weigher_unit,allocator_pool> c4(100);
+    compare(c3,c4);
+
+    cache<int,int,policy_lfuaging<50> > c5(100);
+    cache<int,int,policy_lfuaging<50>,container_unordered_map,weigher_unit,allocator_pool> c6(100);
+    compare(c5,c6);
+
+    cache<int,int,policy_adaptive> c7(100);
+    cache<int,int,policy_adaptive,container_unordered_map,weigher_unit,allocator_pool> c8(100);
+    compare(c7,c8);
+}
+
+BOOST_AUTO_TEST_CASE(unsupportedPolicy) {
+    cache<int,int,policy_sieve> c1(100);
+    cache<int,int,policy_sieve,container_map,weigher_unit,allocator_pool> c2(100); //The policy keeps it's own allocation
+    compare(c1,c2);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    cache<int,string,policy_lfu,container_unordered_map,weigher_unit,allocator_pool> c1(3);
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.touch(1);
+
+    cache<int,string,policy_lfu,container_unordered_map,weigher_unit,allocator_pool> c2(c1);
+    c1.insert(3,"data3");
+    c1.insert(4,"data4");
+    BOOST_CHECK(c1.count(1)==1 && c1.count(4)==1 && c1.size()==3);
+    BOOST_CHECK(c2.count(2)==1 && c2.size()==2);
+
+    cache<int,string,policy_lfu,container_unordered_map,weigher_unit,allocator_pool> c3(5);
+    c3=c1;
+    c1.clear();
+    BOOST_CHECK(c3.count(1)==1 && c3.count(4)==1 && c3.size()==3);
+
+    c2.swap(c3);
+    BOOST_CHECK(c2.size()==3 && c3.size()==2);
+    c2.insert(5,"data5");
+    c2.insert(6,"data6");
+    BOOST_CHECK(c2.count(1)==1 && c2.size()==3);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent) {
+    concurrent_cache<int,int,policy_lru,container_unordered_map,weigher_unit,std::hash<int>,concurrency_locked,allocator_pool> c1(1000);
+    for (int indx=0;indx<5000;indx++) {
+        c1.insert(indx,indx);
+    }
+    BOOST_CHECK(c1.size()<=1000);
+    BOOST_CHECK(c1.check(4999));
+}
+
+#ifdef STLCACHE_HAS_MEMORY_RESOURCE
+/*
+ * Passes everything to the default resource and counts the live allocations.
+ */
+class counting_resource : public _pmr::memory_resource {
+    void* do_allocate(size_t _size, size_t _alignment) {
+        live++;
+        return _pmr::new_delete_resource()->allocate(_size,_alignment);
+    }
+    void do_deallocate(void* _p, size_t _size, size_t _alignment) {
+        live--;
+        _pmr::new_delete_resource()->deallocate(_p,_size,_alignment);
+    }
+    bool do_is_equal(const _pmr::memory_resource& x) const noexcept {
+        return this==&x;
+    }
+public:
+    long live=0;
+};
+
+_pmr::memory_resource* testResource() {
+    static counting_resource resource;
+    return &resource;
+}
+
+BOOST_AUTO_TEST_CASE(memoryResource) {
+    counting_resource* resource=static_cast<counting_resource*>(testResource());
+    {
+        cache<int,int,policy_lru> c1(100);
+        cache<int,int,policy_lru,container_unordered_map,weigher_unit,allocator_resource<testResource> > c2(100);
+        compare(c1,c2);
+        BOOST_CHECK(resource->live>200); //Storage and policy nodes
+    }
+    BOOST_CHECK_EQUAL(resource->live,0);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,116 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCachePolicyClock"
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(checkVictim) {
+    cache<int,string,policy_clock> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(1);
+
+    c1.insert(4,"data4"); //The hand clears the bit of key1 and stops at key2
+
+    BOOST_CHECK(c1.size()==3);
+    BOOST_REQUIRE_THROW(c1.fetch(2),exception_invalid_key);
+    BOOST_CHECK(c1.count(1)==1);
+}
+
+BOOST_AUTO_TEST_CASE(secondChance) {
+    cache<int,string,policy_clock> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(1);
+    c1.touch(2);
+    c1.touch(3);
+
+    c1.insert(4,"data4"); //Everything was touched, so the hand makes a full circle
+
+    BOOST_REQUIRE_THROW(c1.fetch(1),exception_invalid_key);
+    BOOST_CHECK(c1.count(2)==1 && c1.count(3)==1);
+
+    c1.insert(5,"data5"); //Bits of key2 and key3 are cleared already
+    BOOST_CHECK(c1.count(2)==0 && c1.count(3)==1);
+}
+
+BOOST_AUTO_TEST_CASE(gclock) {
+    cache<int,string,policy_gclock<3> > c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    for (int indx=0;indx<10;indx++) {
+        c1.touch(1); //Saturates at 3
+    }
+    c1.touch(2);
+
+    c1.insert(4,"data4");
+    BOOST_CHECK(c1.count(3)==0);
+    c1.insert(5,"data5");
+    BOOST_CHECK(c1.count(2)==0);
+    c1.insert(6,"data6");
+    BOOST_CHECK(c1.count(4)==0);
+    BOOST_CHECK(c1.count(1)==1);
+}
+
+BOOST_AUTO_TEST_CASE(eraseAndReuse) {
+    cache<int,int,policy_clock> c1(100);
+
+    unsigned int seed=42;
+    for (int indx=0;indx<20000;indx++) {
+        seed=seed*1103515245+12345;
+        int k=(seed>>16)%300;
+        if (k%5==0) {
+            c1.erase(k);
+        } else if (!c1.check(k)) {
+            c1.insert(k,k);
+        }
+    }
+    BOOST_CHECK(c1.size()<=100);
+    for (int k=1000;k<1200;k++) {
+        c1.insert(k,k);
+    }
+    BOOST_CHECK(c1.size()==100);
+    BOOST_CHECK(c1.count(1199)==1);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    cache<int,string,policy_clock> c1(3);
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(1);
+
+    cache<int,string,policy_clock> c2(c1);
+    cache<int,string,policy_clock> c3(3);
+    c3.swap(c1);
+    BOOST_CHECK(c1.empty());
+
+    c2.insert(4,"data4");
+    c3.insert(4,"data4");
+    BOOST_CHECK(c2.count(2)==0 && c3.count(2)==0);
+    BOOST_CHECK(c2.count(1)==1 && c3.count(1)==1);
+
+    c2.clear();
+    BOOST_CHECK(c2.empty());
+    c2.insert(5,"data5");
+    BOOST_CHECK(c2.size()==1);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,190 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheConcurrent"
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(data) {
+    concurrent_cache<int,string,policy_lru> c1(100,8);
+
+    BOOST_CHECK(c1.shards()==8);
+    BOOST_CHECK(c1.max_size()==100);
+    BOOST_CHECK(c1.empty());
+
+    BOOST_CHECK(c1.insert(1,"data1"));
+    BOOST_CHECK(!c1.insert(1,"data2"));
+    BOOST_CHECK(c1.try_emplace(2,"data2"));
+    BOOST_CHECK(!c1.insert_or_assign(2,string("data3")));
+
+    BOOST_CHECK(c1.fetch(1)=="data1");
+    string value;
+    BOOST_CHECK(c1.try_get(2,value) && value=="data3");
+    BOOST_CHECK(c1.peek(1,value) && value=="data1");
+    BOOST_CHECK(!c1.try_get(3,value));
+    BOOST_REQUIRE_THROW(c1.fetch(3),exception_invalid_key);
+
+    BOOST_CHECK(c1.size()==2);
+    BOOST_CHECK(c1.count(1)==1);
+    BOOST_CHECK(c1.erase(1)==1);
+    BOOST_CHECK(c1.erase(1)==0);
+    c1.clear();
+    BOOST_CHECK(c1.size()==0);
+}
+
+BOOST_AUTO_TEST_CASE(capacity) {
+    concurrent_cache<int,int,policy_lru> c1(10,64);
+
+    BOOST_CHECK(c1.shards()==8); //Never more shards, than entries
+
+    for (int indx=0;indx<1000;indx++) {
+        c1.insert(indx,indx);
+    }
+    BOOST_CHECK(c1.size()<=10);
+    BOOST_CHECK(c1.size()>0);
+
+    concurrent_cache<int,int,policy_lru> c2(3,1);
+    BOOST_CHECK(c2.shards()==1);
+    c2.insert(1,1);
+    c2.insert(2,2);
+    c2.insert(3,3);
+    c2.touch(1);
+    c2.insert(4,4);
+    BOOST_CHECK(c2.count(2)==0); //Single shard behaves exactly like a cache
+    BOOST_CHECK(c2.count(1)==1);
+}
+
+BOOST_AUTO_TEST_CASE(threads) {
+    const int noThreads=8;
+    const int noItems=10000;
+    concurrent_cache<int,int,policy_lru> c1(1024,16);
+    atomic<int> errors(0);
+
+    vector<thread> workers;
+    for (int t=0;t<noThreads;t++) {
+        workers.push_back(thread([&c1,&errors,t]() {
+            int value;
+            for (int indx=0;indx<noItems;indx++) {
+                int key=(indx*7+t)%2048;
+                if (!c1.try_get(key,value)) {
+                    c1.insert(key,key);
+                } else if (value!=key) {
+                    errors++;
+                }
+            }
+        }));
+    }
+    for (size_t indx=0;indx<workers.size();indx++) {
+        workers[indx].join();
+    }
+
+    BOOST_CHECK(errors==0);
+    BOOST_CHECK(c1.size()<=1024);
+    int value;
+    for (int key=0;key<2048;key++) {
+        if (c1.peek(key,value)) {
+            BOOST_CHECK(value==key);
+        }
+    }
+}
+
+typedef concurrent_cache<int,int,policy_lru,container_unordered_map,weigher_unit,std::hash<int>,concurrency_buffered> buffered_cache;
+
+BOOST_AUTO_TEST_CASE(buffered) {
+    buffered_cache c1(3,1);
+
+    c1.insert(1,1);
+    c1.insert(2,2);
+    c1.insert(3,3);
+
+    int value;
+    BOOST_CHECK(c1.try_get(1,value) && value==1); //Touch is buffered
+    BOOST_CHECK(c1.peek(3,value) && value==3);
+    BOOST_CHECK(!c1.try_get(4,value));
+    BOOST_CHECK(c1.check(1));
+
+    c1.insert(4,4); //Buffered touches are applied before the expiration
+    BOOST_CHECK(c1.count(2)==0);
+    BOOST_CHECK(c1.count(1)==1);
+    BOOST_CHECK(c1.fetch(4)==4);
+    BOOST_CHECK(c1.size()==3);
+
+    for (int indx=0;indx<100;indx++) {
+        c1.touch(3); //Overflowing buffers are drained or dropped
+    }
+    c1.insert(5,5);
+    BOOST_CHECK(c1.count(3)==1);
+}
+
+BOOST_AUTO_TEST_CASE(bufferedThreads) {
+    const int noThreads=8;
+    const int noItems=10000;
+    concurrent_cache<int,string,policy_lru,container_unordered_map,weigher_unit,std::hash<int>,concurrency_buffered> c1(1024,16);
+    atomic<int> errors(0);
+
+    vector<thread> workers;
+    for (int t=0;t<noThreads;t++) {
+        workers.push_back(thread([&c1,&errors,t]() {
+            string value;
+            for (int indx=0;indx<noItems;indx++) {
+                int key=(indx*7+t)%2048;
+                if (!c1.try_get(key,value)) {
+                    c1.insert(key,to_string(key));
+                } else if (value!=to_string(key)) {
+                    errors++;
+                }
+            }
+        }));
+    }
+    for (size_t indx=0;indx<workers.size();indx++) {
+        workers[indx].join();
+    }
+
+    BOOST_CHECK(errors==0);
+    BOOST_CHECK(c1.size()<=1024);
+    c1.clear();
+    BOOST_CHECK(c1.empty());
+}
+
+BOOST_AUTO_TEST_CASE(bufferedClock) {
+    const int noThreads=8;
+    const int noItems=10000;
+    concurrent_cache<int,string,policy_clock,container_unordered_map,weigher_unit,std::hash<int>,concurrency_buffered> c1(1024,16);
+    atomic<int> errors(0);
+
+    vector<thread> workers;
+    for (int t=0;t<noThreads;t++) {
+        workers.push_back(thread([&c1,&errors,t]() {
+            string value;
+            for (int indx=0;indx<noItems;indx++) {
+                int key=(indx*7+t)%2048;
+                if (!c1.try_get(key,value)) { //Hits set the reference bit under the shared lock
+                    c1.insert(key,to_string(key));
+                } else if (value!=to_string(key)) {
+                    errors++;
+                }
+            }
+        }));
+    }
+    for (size_t indx=0;indx<workers.size();indx++) {
+        workers[indx].join();
+    }
+
+    BOOST_CHECK(errors==0);
+    BOOST_CHECK(c1.size()<=1024);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,148 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheConcurrentPerformance"
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stlcache/stlcache.hpp>
+
+#include "workload.hpp"
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+const unsigned int noKeys = 1<<20;
+const unsigned int noItems = noKeys/8;
+const unsigned int noOps = 1<<19;
+const unsigned int threadCounts[] = {1, 2, 4, 8, 16, 32};
+
+/*
+ * Read-heavy workloads: every thread looks up the keys of it's own trace and inserts the missing ones. The traces are a skewed
+ * popularity and the same popularity, interrupted by scans of never repeated keys, that every thread starts from the same key.
+ */
+vector<unsigned int> zipfTrace(uint64_t seed) {
+    return workload::trace(workload::zipf(noKeys,0.99,seed),noOps);
+}
+vector<unsigned int> scanTrace(uint64_t seed) {
+    return workload::trace(workload::mixed(noKeys,0.99,noOps/4,noOps/16,seed),noOps);
+}
+
+typedef vector<unsigned int> (*traceType)(uint64_t);
+const traceType traces[] = {zipfTrace, scanTrace};
+const char* const traceNames[] = {"zipf", "scan"};
+
+template <class Worker>
+void run(const char* name, unsigned int trace, unsigned int noThreads, Worker worker) {
+    vector<vector<unsigned int> > keys;
+    for (unsigned int t=0;t<noThreads;t++) {
+        keys.push_back(traces[trace](t+1));
+    }
+
+    vector<thread> workers;
+    chrono::steady_clock::time_point start=chrono::steady_clock::now();
+    for (unsigned int t=0;t<noThreads;t++) {
+        workers.push_back(thread(worker,cref(keys[t])));
+    }
+    for (unsigned int t=0;t<noThreads;t++) {
+        workers[t].join();
+    }
+    chrono::steady_clock::time_point stop=chrono::steady_clock::now();
+
+    double seconds=chrono::duration<double>(stop-start).count();
+    cout<<name<<" on the "<<traceNames[trace]<<" trace with "<<noThreads<<" threads: "<<(noOps*noThreads/seconds/1e6)<<" Mops/s"<<endl;
+}
+
+BOOST_AUTO_TEST_CASE(globalMutexLRU) {
+    for (unsigned int trace=0;trace<sizeof(traces)/sizeof(traces[0]);trace++) {
+        for (unsigned int t=0;t<sizeof(threadCounts)/sizeof(threadCounts[0]);t++) {
+            cache<unsigned int,unsigned int,policy_lru> c(noItems);
+            mutex lock;
+            run("Global mutex policy_lru cache",trace,threadCounts[t],[&c,&lock](const vector<unsigned int>& keys) {
+                for (unsigned int indx=0;indx<keys.size();indx++) {
+                    lock_guard<mutex> guard(lock);
+                    if (!c.try_get(keys[indx])) {
+                        c.insert(keys[indx],indx);
+                    }
+                }
+            });
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(concurrentLRU) {
+    for (unsigned int trace=0;trace<sizeof(traces)/sizeof(traces[0]);trace++) {
+        for (unsigned int t=0;t<sizeof(threadCounts)/sizeof(threadCounts[0]);t++) {
+            concurrent_cache<unsigned int,unsigned int,policy_lru> c(noItems,128);
+            run("Sharded policy_lru concurrent_cache",trace,threadCounts[t],[&c](const vector<unsigned int>& keys) {
+                unsigned int value;
+                for (unsigned int indx=0;indx<keys.size();indx++) {
+                    if (!c.try_get(keys[indx],value)) {
+                        c.insert(keys[indx],indx);
+                    }
+                }
+            });
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bufferedLRU) {
+    for (unsigned int trace=0;trace<sizeof(traces)/sizeof(traces[0]);trace++) {
+        for (unsigned int t=0;t<sizeof(threadCounts)/sizeof(threadCounts[0]);t++) {
+            concurrent_cache<unsigned int,unsigned int,policy_lru,container_unordered_map,weigher_unit,std::hash<unsigned int>,concurrency_buffered> c(noItems,128);
+            run("Buffered policy_lru concurrent_cache",trace,threadCounts[t],[&c](const vector<unsigned int>& keys) {
+                unsigned int value;
+                for (unsigned int indx=0;indx<keys.size();indx++) {
+                    if (!c.try_get(keys[indx],value)) {
+                        c.insert(keys[indx],indx);
+                    }
+                }
+            });
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(concurrentLFU) {
+    for (unsigned int trace=0;trace<sizeof(traces)/sizeof(traces[0]);trace++) {
+        for (unsigned int t=0;t<sizeof(threadCounts)/sizeof(threadCounts[0]);t++) {
+            concurrent_cache<unsigned int,unsigned int,policy_lfu> c(noItems,128);
+            run("Sharded policy_lfu concurrent_cache",trace,threadCounts[t],[&c](const vector<unsigned int>& keys) {
+                unsigned int value;
+                for (unsigned int indx=0;indx<keys.size();indx++) {
+                    if (!c.try_get(keys[indx],value)) {
+                        c.insert(keys[indx],indx);
+                    }
+                }
+            });
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bufferedLFU) {
+    for (unsigned int trace=0;trace<sizeof(traces)/sizeof(traces[0]);trace++) {
+        for (unsigned int t=0;t<sizeof(threadCounts)/sizeof(threadCounts[0]);t++) {
+            concurrent_cache<unsigned int,unsigned int,policy_lfu,container_unordered_map,weigher_unit,std::hash<unsigned int>,concurrency_buffered> c(noItems,128);
+            run("Buffered policy_lfu concurrent_cache",trace,threadCounts[t],[&c](const vector<unsigned int>& keys) {
+                unsigned int value;
+                for (unsigned int indx=0;indx<keys.size();indx++) {
+                    if (!c.try_get(keys[indx],value)) {
+                        c.insert(keys[indx],indx);
+                    }
+                }
+            });
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,180 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheFlatHashMap"
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(randomized) {
+    typedef container_flat_hash_map::bind<int,string>::map_type map_type;
+    map_type m;
+    unordered_map<int,string> reference;
+
+    mt19937 rng(42);
+    bool ok=true;
+    for (int indx=0;indx<200000;indx++) {
+        int k=static_cast<int>(rng()%4096);
+        switch (rng()%3) {
+        case 0: {
+            pair<map_type::iterator,bool> result=m.try_emplace(k,to_string(indx));
+            bool inserted=reference.emplace(k,to_string(indx)).second;
+            ok=ok && result.second==inserted && result.first->second==reference[k];
+            break;
+        }
+        case 1:
+            ok=ok && m.erase(k)==reference.erase(k);
+            break;
+        default: {
+            map_type::const_iterator it=m.find(k);
+            ok=ok && (it==m.end() ? reference.count(k)==0 : reference.count(k)==1 && it->second==reference[k]);
+            break;
+        }
+        }
+    }
+    BOOST_CHECK(ok);
+    BOOST_CHECK(m.size()==reference.size());
+
+    size_t visited=0;
+    for (map_type::const_iterator it=m.begin();it!=m.end();++it) {
+        BOOST_CHECK(reference[it->first]==it->second);
+        visited++;
+    }
+    BOOST_CHECK(visited==reference.size());
+}
+
+BOOST_AUTO_TEST_CASE(reserveAndChurn) {
+    typedef container_flat_hash_map::bind<unsigned int,unsigned int>::map_type map_type;
+    map_type m;
+    m.reserve(1000);
+    size_t capacity=m.capacity();
+    BOOST_CHECK(capacity>=1000);
+
+    //Constant churn at the reserved size leaves tombstones, but never grows the table
+    for (unsigned int indx=0;indx<100000;indx++) {
+        m.emplace(indx,indx);
+        if (indx>=1000) {
+            m.erase(m.find(indx-1000));
+        }
+    }
+    BOOST_CHECK(m.size()==1000);
+    BOOST_CHECK(m.capacity()==capacity);
+    for (unsigned int indx=99000;indx<100000;indx++) {
+        BOOST_CHECK(m.count(indx)==1);
+    }
+    BOOST_CHECK(m.count(98999)==0);
+
+    m.clear();
+    BOOST_CHECK(m.empty());
+    BOOST_CHECK(m.capacity()==capacity);
+}
+
+/*
+ * Counts the allocations of all it's copies.
+ */
+template <class T>
+struct counting_allocator : std::allocator<T> {
+    template <class U>
+    struct rebind {
+        typedef counting_allocator<U> other;
+    };
+    static size_t allocations;
+
+    counting_allocator() { }
+    template <class U>
+    counting_allocator(const counting_allocator<U>&) { }
+
+    T* allocate(size_t _n) {
+        allocations++;
+        return std::allocator<T>::allocate(_n);
+    }
+};
+template <class T>
+size_t counting_allocator<T>::allocations = 0;
+
+BOOST_AUTO_TEST_CASE(churnWithoutAllocations) {
+    typedef _flat_hash_map<unsigned int,unsigned int,std::hash<unsigned int>,std::equal_to<unsigned int>,counting_allocator<pair<const unsigned int,unsigned int> > > map_type;
+    map_type m;
+    m.reserve(1701);
+    size_t before=counting_allocator<char>::allocations+counting_allocator<signed char>::allocations+counting_allocator<pair<const unsigned int,unsigned int> >::allocations;
+
+    //The cache inserts the new entry before removing the victim, so the size goes up to the reserved one and back
+    for (unsigned int indx=0;indx<500000;indx++) {
+        m.emplace(indx,indx);
+        if (indx>=1700) {
+            m.erase(indx-1700);
+        }
+    }
+    size_t after=counting_allocator<char>::allocations+counting_allocator<signed char>::allocations+counting_allocator<pair<const unsigned int,unsigned int> >::allocations;
+    BOOST_CHECK_EQUAL(after,before);
+
+    bool found=true;
+    for (unsigned int k=500000-1700;k<500000;k++) {
+        found=found && m.count(k)==1 && m.find(k)->second==k;
+    }
+    BOOST_CHECK(found);
+    BOOST_CHECK_EQUAL(m.size(),1700);
+    BOOST_CHECK(m.count(500000-1701)==0);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    typedef container_flat_hash_map::bind<string,string>::map_type map_type;
+    map_type m1;
+    for (int indx=0;indx<100;indx++) {
+        m1.emplace(to_string(indx),string(100,'x'));
+    }
+    map_type m2(m1);
+    map_type m3;
+    m3.swap(m1);
+    BOOST_CHECK(m1.empty());
+    BOOST_CHECK(m2.size()==100 && m3.size()==100);
+    BOOST_CHECK(m2.find("42")->second==string(100,'x'));
+    m1=m2;
+    BOOST_CHECK(m1.count("99")==1);
+}
+
+BOOST_AUTO_TEST_CASE(cache) {
+    stlcache::cache<int,string,policy_lru,container_flat_hash_map> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(1);
+    c1.insert(4,"data4");
+    BOOST_CHECK(c1.size()==3);
+    BOOST_CHECK(c1.check(1) && !c1.check(2));
+    BOOST_CHECK(c1.fetch(4)=="data4");
+
+    stlcache::cache<int,string,policy_lru,container_flat_hash_map> c2(c1);
+    c2.erase(1);
+    BOOST_CHECK(c1.check(1) && !c2.check(1));
+}
+
+BOOST_AUTO_TEST_CASE(ttl) {
+    stlcache::cache<int,string,policy_lru,container_flat_hash_map> c1(100);
+    for (int indx=0;indx<100;indx++) {
+        c1.insert(indx,"data",chrono::milliseconds(indx%2 ? 50 : 3600000));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(120));
+
+    c1.insert(100,"data");
+    BOOST_CHECK(c1.size()==51);
+    BOOST_CHECK(c1.check(0) && !c1.check(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,111 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheHitRatio"
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <stlcache/stlcache.hpp>
+
+#include "workload.hpp"
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+const unsigned int noKeys = 100000;
+const unsigned int noRequests = 1000000;
+const unsigned int cacheSize = 2000;
+
+/*
+ * Synthetic traces: a skewed popularity, uniform keys, the skewed popularity with periodic scans of never repeated keys, popularity,
+ * that moves every period, and a loop slightly larger than the cache.
+ */
+vector<unsigned int> zipfTrace(uint64_t seed) {
+    return workload::trace(workload::zipf(noKeys,0.9,seed),noRequests);
+}
+vector<unsigned int> uniformTrace(uint64_t seed) {
+    return workload::trace(workload::uniform(noKeys,seed),noRequests);
+}
+vector<unsigned int> scanTrace(uint64_t seed) {
+    return workload::trace(workload::mixed(noKeys,0.9,20000,5000,seed),noRequests);
+}
+vector<unsigned int> shiftingTrace(uint64_t seed) {
+    return workload::trace(workload::shifting(noKeys,0.9,100000,noKeys/10,seed),noRequests);
+}
+vector<unsigned int> loopTrace(uint64_t) {
+    return workload::trace(workload::loop(cacheSize+cacheSize/4),noRequests);
+}
+
+template <class Policy>
+void replay(const char* name, const char* traceName, const vector<unsigned int>& trace) {
+    cache<unsigned int,unsigned int,Policy> c(cacheSize);
+    unsigned int hits=0;
+
+    chrono::steady_clock::time_point start=chrono::steady_clock::now();
+    for (unsigned int indx=0;indx<trace.size();indx++) {
+        if (c.try_get(trace[indx])) {
+            hits++;
+            continue;
+        }
+        try {
+            c.insert(trace[indx],indx);
+        } catch (const exception_cache_full&) {
+        }
+    }
+    chrono::steady_clock::time_point stop=chrono::steady_clock::now();
+
+    double ns=chrono::duration<double,nano>(stop-start).count()/trace.size();
+    cout<<setw(24)<<name<<" on "<<setw(8)<<traceName<<" trace: hit ratio "<<fixed<<setprecision(4)<<(double(hits)/trace.size())<<", "<<setprecision(1)<<ns<<" ns/op"<<endl;
+}
+
+template <class Trace>
+void compare(const char* traceName, Trace trace) {
+    vector<unsigned int> keys=trace(42);
+    replay<policy_lru>("policy_lru",traceName,keys);
+    replay<policy_lfu>("policy_lfu",traceName,keys);
+    replay<policy_adaptive>("policy_adaptive",traceName,keys);
+    replay<policy_indexed_adaptive>("policy_indexed_adaptive",traceName,keys);
+    replay<policy_wtinylfu>("policy_wtinylfu",traceName,keys);
+    replay<policy_clock>("policy_clock",traceName,keys);
+    replay<policy_gclock<3> >("policy_gclock<3>",traceName,keys);
+    replay<policy_sieve>("policy_sieve",traceName,keys);
+    replay<policy_s3fifo>("policy_s3fifo",traceName,keys);
+    replay<policy_lirs>("policy_lirs",traceName,keys);
+    replay<policy_2q>("policy_2q",traceName,keys);
+    replay<policy_slru<> >("policy_slru<20>",traceName,keys);
+    replay<policy_sampled_lru<> >("policy_sampled_lru<5>",traceName,keys);
+    replay<policy_sampled_lru<16> >("policy_sampled_lru<16>",traceName,keys);
+    replay<policy_sampled_lfu<> >("policy_sampled_lfu<5>",traceName,keys);
+}
+
+BOOST_AUTO_TEST_CASE(zipf) {
+    compare("zipf",zipfTrace);
+}
+
+BOOST_AUTO_TEST_CASE(uniform) {
+    compare("uniform",uniformTrace);
+}
+
+BOOST_AUTO_TEST_CASE(scan) {
+    compare("scan",scanTrace);
+}
+
+BOOST_AUTO_TEST_CASE(shifting) {
+    compare("shifting",shiftingTrace);
+}
+
+BOOST_AUTO_TEST_CASE(loop) {
+    compare("loop",loopTrace);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
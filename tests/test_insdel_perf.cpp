@@ -8,14 +8,13 @@
 #define BOOST_TEST_MODULE "STLCacheInsertDeletePerformance"
 #include <boost/test/unit_test.hpp>
 
-#ifdef _WIN32
-#include "timeval.h"
-#else 
-#include <sys/time.h>
-#endif /* _WIN32 */
+#include <chrono>
 #include <iostream>
+#include <vector>
 #include <stlcache/stlcache.hpp>
 
+#include "workload.hpp"
+
 using namespace stlcache;
 using namespace std;
 
@@ -23,204 +22,74 @@ BOOST_AUTO_TEST_SUITE(STLCacheSuite)
 
 const unsigned int noItems = 65536;
 
-BOOST_AUTO_TEST_CASE(insdelNone) {
-    struct timeval start,stop;
+/*
+ * A skewed popularity over four times more keys, than the cache holds, and the same popularity, interrupted by scans of never repeated
+ * keys every quarter of the trace.
+ */
+const vector<unsigned int> zipfTrace=workload::trace(workload::zipf(noItems*4,0.9,42),noItems);
+const vector<unsigned int> scanTrace=workload::trace(workload::mixed(noItems*4,0.9,noItems/4,noItems/16,42),noItems);
 
-    gettimeofday(&start, NULL); 
+/*
+ * Inserts every request of the trace into an empty cache and erases them in the same order, so the repeated keys are already gone
+ * on the erase.
+ */
+template <class Cache>
+void insdel(const char* name, const char* traceName, const vector<unsigned int>& trace) {
+    Cache c(noItems);
 
-    cache<unsigned int,unsigned int,policy_none> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
+    chrono::steady_clock::time_point start=chrono::steady_clock::now();
+    for(unsigned int indx = 0; indx<trace.size(); indx++) {
+        c.insert(trace[indx],indx);
     }
+    chrono::steady_clock::time_point stop=chrono::steady_clock::now();
 
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_none cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    cout<<"Insertion of "<<trace.size()<<" "<<traceName<<" requests into "<<name<<" took "<<chrono::duration_cast<chrono::milliseconds>(stop-start).count()<<" milliseconds"<<endl;
 
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.erase(indx);
+    start=chrono::steady_clock::now();
+    for(unsigned int indx = 0; indx<trace.size(); indx++) {
+        c.erase(trace[indx]);
     }
+    stop=chrono::steady_clock::now();
 
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Removal of "<<noItems<<" items from policy_none cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    cout<<"Removal of "<<trace.size()<<" "<<traceName<<" requests from "<<name<<" took "<<chrono::duration_cast<chrono::milliseconds>(stop-start).count()<<" milliseconds"<<endl;
 }
 
-BOOST_AUTO_TEST_CASE(insdelLRU) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_lru> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_lru cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
-
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.erase(indx);
-    }
+template <class Cache>
+void insdel(const char* name) {
+    insdel<Cache>(name,"zipf",zipfTrace);
+    insdel<Cache>(name,"scan",scanTrace);
+}
 
-    gettimeofday(&stop, NULL); 
+BOOST_AUTO_TEST_CASE(insdelNone) {
+    insdel<cache<unsigned int,unsigned int,policy_none> >("policy_none cache");
+}
 
-    cout<<"Remocal of "<<noItems<<" items from policy_lru cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+BOOST_AUTO_TEST_CASE(insdelLRU) {
+    insdel<cache<unsigned int,unsigned int,policy_lru> >("policy_lru cache");
 }
 
 BOOST_AUTO_TEST_CASE(insdelMRU) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_mru> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_mru cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
-
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.erase(indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Removal of "<<noItems<<" items from policy_mru cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    insdel<cache<unsigned int,unsigned int,policy_mru> >("policy_mru cache");
 }
 
 BOOST_AUTO_TEST_CASE(insdelLFU) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_lfu> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_lfu cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
-
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.erase(indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Removal of "<<noItems<<" items from policy_lfu cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    insdel<cache<unsigned int,unsigned int,policy_lfu> >("policy_lfu cache");
 }
 
 BOOST_AUTO_TEST_CASE(insdelLFUStar) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_lfustar> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_lfustar cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
-
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.erase(indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Removal of "<<noItems<<" items from policy_lfustar cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    insdel<cache<unsigned int,unsigned int,policy_lfustar> >("policy_lfustar cache");
 }
 
 BOOST_AUTO_TEST_CASE(insdelLFUAging) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_lfuaging<3600> > c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_lfuaging cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
-
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.erase(indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Removal of "<<noItems<<" items from policy_lfuaging cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    insdel<cache<unsigned int,unsigned int,policy_lfuaging<3600> > >("policy_lfuaging cache");
 }
 
 BOOST_AUTO_TEST_CASE(insdelLFUAgingStar) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_lfuagingstar<3600> > c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_lfuagingstar cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
-
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.erase(indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Removal of "<<noItems<<" items from policy_lfuagingstar cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    insdel<cache<unsigned int,unsigned int,policy_lfuagingstar<3600> > >("policy_lfuagingstar cache");
 }
 
 BOOST_AUTO_TEST_CASE(insdelAdaptive) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_adaptive> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_adaptive cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
-
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.erase(indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Removal of "<<noItems<<" items from policy_adaptive cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    insdel<cache<unsigned int,unsigned int,policy_adaptive> >("policy_adaptive cache");
 }
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -8,14 +8,13 @@
 #define BOOST_TEST_MODULE "STLCacheInsertPerformance"
 #include <boost/test/unit_test.hpp>
 
-#ifdef _WIN32
-#include "timeval.h"
-#else 
-#include <sys/time.h>
-#endif /* _WIN32 */
+#include <chrono>
 #include <iostream>
+#include <vector>
 #include <stlcache/stlcache.hpp>
 
+#include "workload.hpp"
+
 using namespace stlcache;
 using namespace std;
 
@@ -23,124 +22,95 @@ BOOST_AUTO_TEST_SUITE(STLCacheSuite)
 
 const unsigned int noItems = 65536;
 
-BOOST_AUTO_TEST_CASE(insertNone) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_none> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
+/*
+ * A skewed popularity over four times more keys, than the cache holds, and the same popularity, interrupted by scans of never repeated
+ * keys every quarter of the trace.
+ */
+const vector<unsigned int> zipfTrace=workload::trace(workload::zipf(noItems*4,0.9,42),noItems);
+const vector<unsigned int> scanTrace=workload::trace(workload::mixed(noItems*4,0.9,noItems/4,noItems/16,42),noItems);
+
+/*
+ * Inserts every request of the trace into an empty cache. The repeated keys are already there.
+ */
+template <class Cache>
+void insert(const char* name, const char* traceName, const vector<unsigned int>& trace) {
+    Cache c(noItems);
+
+    chrono::steady_clock::time_point start=chrono::steady_clock::now();
+    for(unsigned int indx = 0; indx<trace.size(); indx++) {
+        c.insert(trace[indx],indx);
     }
+    chrono::steady_clock::time_point stop=chrono::steady_clock::now();
 
-    gettimeofday(&stop, NULL); 
+    cout<<"Insertion of "<<trace.size()<<" "<<traceName<<" requests into "<<name<<" took "<<chrono::duration_cast<chrono::milliseconds>(stop-start).count()<<" milliseconds"<<endl;
+}
 
-    cout<<"Insertion of "<<noItems<<" items into policy_none cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+template <class Cache>
+void insert(const char* name) {
+    insert<Cache>(name,"zipf",zipfTrace);
+    insert<Cache>(name,"scan",scanTrace);
 }
 
-BOOST_AUTO_TEST_CASE(insertLRU) {
-    struct timeval start,stop;
+BOOST_AUTO_TEST_CASE(insertNone) {
+    insert<cache<unsigned int,unsigned int,policy_none> >("policy_none cache");
+}
 
-    gettimeofday(&start, NULL); 
+BOOST_AUTO_TEST_CASE(insertLRU) {
+    insert<cache<unsigned int,unsigned int,policy_lru> >("policy_lru cache");
+}
 
-    cache<unsigned int,unsigned int,policy_lru> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
+BOOST_AUTO_TEST_CASE(insertLRUMap) {
+    insert<cache<unsigned int,unsigned int,policy_lru,container_map> >("policy_lru cache with container_map");
+}
 
-    gettimeofday(&stop, NULL); 
+BOOST_AUTO_TEST_CASE(insertLRUFlatHashMap) {
+    insert<cache<unsigned int,unsigned int,policy_lru,container_flat_hash_map> >("policy_lru cache with container_flat_hash_map");
+}
 
-    cout<<"Insertion of "<<noItems<<" items into policy_lru cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+BOOST_AUTO_TEST_CASE(insertIndexedLRU) {
+    insert<cache<unsigned int,unsigned int,policy_indexed_lru,container_flat_hash_map> >("policy_indexed_lru cache with container_flat_hash_map");
 }
 
 BOOST_AUTO_TEST_CASE(insertMRU) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_mru> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_mru cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    insert<cache<unsigned int,unsigned int,policy_mru> >("policy_mru cache");
 }
 
 BOOST_AUTO_TEST_CASE(insertLFU) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_lfu> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_lfu cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    insert<cache<unsigned int,unsigned int,policy_lfu> >("policy_lfu cache");
 }
 
 BOOST_AUTO_TEST_CASE(insertLFUStar) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_lfustar> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_lfustar cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    insert<cache<unsigned int,unsigned int,policy_lfustar> >("policy_lfustar cache");
 }
 
 BOOST_AUTO_TEST_CASE(insertLFUAging) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_lfuaging<3600> > c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_lfuaging cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    insert<cache<unsigned int,unsigned int,policy_lfuaging<3600> > >("policy_lfuaging cache");
 }
 
 BOOST_AUTO_TEST_CASE(insertLFUAgingStar) {
-    struct timeval start,stop;
-
-    gettimeofday(&start, NULL); 
-
-    cache<unsigned int,unsigned int,policy_lfuagingstar<3600> > c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" items into policy_lfuagingstar cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    insert<cache<unsigned int,unsigned int,policy_lfuagingstar<3600> > >("policy_lfuagingstar cache");
 }
 
 BOOST_AUTO_TEST_CASE(insertAdaptive) {
-    struct timeval start,stop;
+    insert<cache<unsigned int,unsigned int,policy_adaptive> >("policy_adaptive cache");
+}
 
-    gettimeofday(&start, NULL); 
+BOOST_AUTO_TEST_CASE(insertLRUWithTTL) {
+    const vector<unsigned int>* traces[]={&zipfTrace,&scanTrace};
+    const char* names[]={"zipf","scan"};
 
-    cache<unsigned int,unsigned int,policy_adaptive> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
+    for (unsigned int t=0;t<2;t++) {
+        const vector<unsigned int>& trace=*traces[t];
+        cache<unsigned int,unsigned int,policy_lru> c(noItems);
 
-    gettimeofday(&stop, NULL); 
+        chrono::steady_clock::time_point start=chrono::steady_clock::now();
+        for(unsigned int indx = 0; indx<trace.size(); indx++) {
+            c.insert(trace[indx],indx,std::chrono::milliseconds(1+indx%30000));
+        }
+        chrono::steady_clock::time_point stop=chrono::steady_clock::now();
 
-    cout<<"Insertion of "<<noItems<<" items into policy_adaptive cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+        cout<<"Insertion of "<<trace.size()<<" "<<names[t]<<" requests with ttl into policy_lru cache took "<<chrono::duration_cast<chrono::milliseconds>(stop-start).count()<<" milliseconds"<<endl;
+    }
 }
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,136 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheIntrusive"
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(data) {
+    intrusive_cache<int,string,policy_lru> c(10);
+
+    BOOST_CHECK(c.empty());
+    BOOST_CHECK(c.insert(1,string("test"))); //Insert returns true for new entries
+    BOOST_CHECK(!c.insert(1,string("newtest"))); //Insert returns false for existing entries and doesn't updates them
+    BOOST_CHECK(c.size()==1);
+
+    BOOST_CHECK(c.check(1));
+    BOOST_CHECK(!c.check(2));
+    BOOST_CHECK(!c.fetch(1).compare("test"));
+    BOOST_REQUIRE_THROW(c.fetch(2),exception_invalid_key);
+    BOOST_CHECK(c.try_get(2)==nullptr);
+    BOOST_CHECK(c.peek(2)==nullptr);
+    BOOST_REQUIRE(c.try_get(1)!=nullptr);
+    BOOST_CHECK(!c.peek(1)->compare("test"));
+
+    BOOST_CHECK(c.erase(1)==1);
+    BOOST_CHECK(c.erase(1)==0);
+    BOOST_CHECK(c.empty());
+
+    c.insert(1,"data1");
+    c.insert(2,"data2");
+    c.clear();
+    BOOST_CHECK(c.empty());
+    BOOST_REQUIRE_THROW(c.fetch(1),exception_invalid_key);
+}
+
+BOOST_AUTO_TEST_CASE(emplace) {
+    intrusive_cache<int,string,policy_lru> c(2);
+
+    BOOST_CHECK(c.try_emplace(1,"data1"));
+    BOOST_CHECK(!c.try_emplace(1,"newdata1"));
+    BOOST_CHECK(c.fetch(1)=="data1");
+    BOOST_CHECK(!c.insert_or_assign(1,string("newdata1")));
+    BOOST_CHECK(c.fetch(1)=="newdata1");
+    BOOST_CHECK(c.insert_or_assign(2,string("data2")));
+    c.touch(1);
+    BOOST_CHECK(c.try_emplace(3,5,'x'));
+    BOOST_CHECK(c.fetch(3)=="xxxxx");
+    BOOST_CHECK(c.peek(2)==nullptr);
+    BOOST_CHECK(c.size()==2);
+}
+
+BOOST_AUTO_TEST_CASE(lru) {
+    intrusive_cache<int,string,policy_lru> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+
+    c1.touch(1);
+
+    c1.insert(4,"data4");
+
+    BOOST_CHECK(c1.size()==3);
+    BOOST_REQUIRE_THROW(c1.fetch(2),exception_invalid_key); //Must be removed by LRU policy (cause 1 is touched)
+    BOOST_REQUIRE_NO_THROW(c1.fetch(1));
+}
+
+BOOST_AUTO_TEST_CASE(mru) {
+    intrusive_cache<int,string,policy_mru,container_map> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+
+    c1.touch(1);
+
+    c1.insert(4,"data4");
+
+    BOOST_REQUIRE_THROW(c1.fetch(1),exception_invalid_key); //Must be removed by MRU policy (cause 1 is touched last)
+}
+
+BOOST_AUTO_TEST_CASE(lfu) {
+    intrusive_cache<int,string,policy_lfu> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+
+    c1.touch(1);
+    c1.touch(1);
+    c1.touch(2);
+    c1.touch(3);
+    c1.touch(3);
+
+    c1.insert(4,"data4");
+    BOOST_REQUIRE_THROW(c1.fetch(2),exception_invalid_key); //Must be removed by LFU policy (cause 2 have the smallest refcount)
+
+    c1.insert(5,"data5");
+    BOOST_REQUIRE_THROW(c1.fetch(4),exception_invalid_key); //New entry have refcount 1
+}
+
+BOOST_AUTO_TEST_CASE(swapAndMove) {
+    intrusive_cache<int,string,policy_lru> c1(2);
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+
+    intrusive_cache<int,string,policy_lru> c2(5);
+    c2.insert(3,"data3");
+
+    c1.swap(c2);
+    BOOST_CHECK(c1.max_size()==5);
+    BOOST_CHECK(c2.max_size()==2);
+    BOOST_CHECK(!c1.fetch(3).compare("data3"));
+
+    c2.touch(1);
+    c2.insert(4,"data4");
+    BOOST_REQUIRE_THROW(c2.fetch(2),exception_invalid_key);
+
+    intrusive_cache<int,string,policy_lru> c3(std::move(c2));
+    BOOST_CHECK(c2.empty());
+    BOOST_CHECK(c3.size()==2);
+    c3.insert(5,"data5");
+    BOOST_REQUIRE_THROW(c3.fetch(1),exception_invalid_key);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
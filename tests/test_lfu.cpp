@@ -8,6 +8,7 @@
 #define BOOST_TEST_MODULE "STLCachePolicyLFU"
 #include <boost/test/unit_test.hpp>
 
+#include <map>
 #include <stlcache/stlcache.hpp>
 
 using namespace stlcache;
@@ -41,4 +42,86 @@ BOOST_AUTO_TEST_CASE(touch) {
     BOOST_REQUIRE_THROW(c1.fetch(3),exception_invalid_key); //Must be removed by LFU policy (cause 1&2 are touched)
 }
 
+BOOST_AUTO_TEST_CASE(fetch) {
+    cache<int,string,policy_lfu> c1(2);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+
+    c1.touch(2);
+    c1.touch(2);
+    c1.fetch(1); //Fetch touches the entry exactly once, so refcount for key 1 is 2 and for key 2 is 3
+
+    c1.insert(3,"data3");
+
+    BOOST_REQUIRE_THROW(c1.fetch(1),exception_invalid_key);
+    BOOST_REQUIRE_NO_THROW(c1.fetch(2));
+}
+
+BOOST_AUTO_TEST_CASE(copy) {
+    cache<int,string,policy_lfu> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(1);
+
+    cache<int,string,policy_lfu> c2(c1); //Copy tracks the same counts, but independently
+    c1.erase(2);
+    c1.clear();
+
+    c2.touch(2);
+    c2.insert(4,"data4");
+    BOOST_REQUIRE_THROW(c2.fetch(3),exception_invalid_key);
+    c2.insert(5,"data5");
+    BOOST_REQUIRE_THROW(c2.fetch(4),exception_invalid_key);
+    BOOST_CHECK(c2.check(1) && c2.check(2));
+}
+
+BOOST_AUTO_TEST_CASE(model) {
+    //Victim is the key with the smallest count, that got this count first
+    policy_lfu::bind<int> p(0);
+    map<int,pair<unsigned int,unsigned int> > model;
+    unsigned int stamp=0;
+
+    unsigned int seed=42;
+    bool ok=true;
+    for (unsigned int indx=0;indx<50000;indx++) {
+        seed=seed*1103515245+12345;
+        int k=static_cast<int>((seed>>16)%200);
+        switch ((seed>>8)%4) {
+        case 0:
+            if (!model.count(k)) {
+                p.insert(k);
+                model[k]=make_pair(1u,stamp++);
+            }
+            break;
+        case 1:
+            p.remove(k);
+            model.erase(k);
+            break;
+        default:
+            p.touch(k);
+            if (model.count(k)) {
+                model[k]=make_pair(model[k].first+1,stamp++);
+            }
+            break;
+        }
+
+        _victim<int> v=p.victim();
+        if (model.empty()) {
+            ok=ok && !v;
+            continue;
+        }
+        map<int,pair<unsigned int,unsigned int> >::const_iterator best=model.begin();
+        for (map<int,pair<unsigned int,unsigned int> >::const_iterator it=model.begin();it!=model.end();++it) {
+            if (it->second<best->second) {
+                best=it;
+            }
+        }
+        ok=ok && v && *v==best->first;
+    }
+    BOOST_CHECK(ok);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
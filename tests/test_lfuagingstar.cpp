@@ -116,4 +116,28 @@ BOOST_AUTO_TEST_CASE(expirefail) {
     BOOST_REQUIRE_NO_THROW(c1.insert(4,"data4"));
     BOOST_REQUIRE_THROW(c1.fetch(3),exception_invalid_key); //Must be removed by LFU policy (cause every item have been expired again and refcount for key 3 is 1)
 }
+
+BOOST_AUTO_TEST_CASE(expireManyStale) {
+    cache<int,int,policy_lfuagingstar<1> > c1(20);
+
+    for (int k=0;k<20;k++) {
+        c1.insert(k,k);
+    }
+    for (int k=0;k<16;k++) {
+        c1.touch(k); //For keys 0-15 refcount is 3 now
+        c1.touch(k);
+    }
+    for (int k=16;k<20;k++) {
+        c1.touch(k); //For keys 16-19 refcount is 2 now
+    }
+
+    WAIT_A_SECOND;
+
+    BOOST_REQUIRE_NO_THROW(c1.insert(20,20)); //Only keys 16-19 drop to the refcount 1, though they are behind the aging batch
+    BOOST_REQUIRE_THROW(c1.fetch(16),exception_invalid_key);
+    for (int k=0;k<16;k++) {
+        BOOST_CHECK(c1.check(k));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,124 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCachePolicyLIRS"
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+#include "copy_and_swap.hpp"
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(checkVictim) {
+    cache<int,string,policy_lirs> c1(3); //Two LIR entries and one HIR
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.insert(4,"data4"); //Key3 is the only HIR entry, it becomes non-resident
+
+    BOOST_REQUIRE_THROW(c1.fetch(3),exception_invalid_key);
+
+    c1.insert(3,"data3"); //Key4 is expired and key3 comes back as LIR, replacing key1
+    BOOST_CHECK(c1.count(4)==0);
+    BOOST_CHECK(c1.count(1)==1 && c1.count(2)==1 && c1.count(3)==1);
+
+    c1.insert(5,"data5"); //Key1 is HIR now
+    BOOST_CHECK(c1.count(1)==0);
+    BOOST_CHECK(c1.count(2)==1 && c1.count(3)==1);
+}
+
+BOOST_AUTO_TEST_CASE(hirPromotion) {
+    cache<int,string,policy_lirs,container_map> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(3); //Reused before the least recent LIR entry, key3 becomes LIR and key1 becomes HIR
+
+    c1.insert(4,"data4");
+    BOOST_CHECK(c1.count(1)==0);
+    BOOST_CHECK(c1.count(2)==1 && c1.count(3)==1 && c1.count(4)==1);
+}
+
+BOOST_AUTO_TEST_CASE(loop) {
+    cache<int,int,policy_lirs> c1(100);
+    cache<int,int,policy_lru> c2(100);
+
+    int hits1=0;
+    int hits2=0;
+    for (int round=0;round<20;round++) {
+        for (int k=0;k<125;k++) { //A bit more, than the cache holds
+            if (c1.check(k)) {
+                hits1++;
+            } else {
+                c1.insert(k,k);
+            }
+            if (c2.check(k)) {
+                hits2++;
+            } else {
+                c2.insert(k,k);
+            }
+        }
+    }
+    BOOST_CHECK(hits2==0);
+    BOOST_CHECK(hits1>19*90);
+}
+
+BOOST_AUTO_TEST_CASE(eraseAndChurn) {
+    cache<int,int,policy_lirs> c1(100);
+
+    unsigned int seed=42;
+    for (int indx=0;indx<50000;indx++) {
+        seed=seed*1103515245+12345;
+        int k=(seed>>16)%(indx%5000<2500 ? 150 : 1000);
+        if (k%11==0) {
+            c1.erase(k);
+        } else if (!c1.check(k)) {
+            c1.insert(k,k);
+        }
+    }
+    BOOST_CHECK(c1.size()<=100);
+    for (int k=2000;k<2200;k++) {
+        c1.insert(k,k);
+    }
+    BOOST_CHECK(c1.size()==100);
+    BOOST_CHECK(c1.count(2199)==1);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    checkCopyAndSwap<policy_lirs>();
+}
+
+BOOST_AUTO_TEST_CASE(copyStatus) {
+    cache<int,string,policy_lirs> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.insert(4,"data4"); //Key3 is non-resident, key4 is the resident HIR entry
+
+    cache<int,string,policy_lirs> c2(c1);
+    cache<int,string,policy_lirs> c3(3);
+    c3=c1;
+
+    cache<int,string,policy_lirs>* copies[]={&c2,&c3,&c1};
+    for (int indx=0;indx<3;indx++) {
+        cache<int,string,policy_lirs>& c=*copies[indx];
+        c.insert(3,"data3"); //The ghost is recognized, key3 comes back as LIR, key4 is expired
+        BOOST_CHECK(c.count(4)==0);
+        c.insert(5,"data5"); //Key1 was demoted to HIR
+        BOOST_CHECK(c.count(1)==0);
+        BOOST_CHECK(c.count(2)==1 && c.count(3)==1 && c.count(5)==1);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,107 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheLoader"
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(readThrough) {
+    cache<int,string,policy_lru> c1(2);
+    int loads=0;
+    auto loader=[&loads](const int& k) {
+        loads++;
+        return to_string(k);
+    };
+
+    BOOST_CHECK(c1.get_or_load(1,loader)=="1");
+    BOOST_CHECK(c1.get_or_load(1,loader)=="1");
+    BOOST_CHECK(loads==1);
+    BOOST_CHECK(c1.count(1)==1);
+
+    c1.get_or_load(2,loader);
+    c1.get_or_load(3,loader); //Expires 1 as usual
+    BOOST_CHECK(c1.count(1)==0);
+    BOOST_CHECK(loads==3);
+}
+
+BOOST_AUTO_TEST_CASE(loaderFailure) {
+    cache<int,string,policy_lru> c1(2);
+
+    BOOST_REQUIRE_THROW(c1.get_or_load(1,[](const int&) -> string { throw runtime_error("backend is down"); }),runtime_error);
+    BOOST_CHECK(c1.empty());
+    BOOST_CHECK(c1.get_or_load(1,[](const int&) { return string("data1"); })=="data1");
+}
+
+BOOST_AUTO_TEST_CASE(singleFlight) {
+    concurrent_cache<int,string,policy_lru> c1(100,4);
+    atomic<int> loads(0);
+    atomic<int> errors(0);
+
+    vector<thread> workers;
+    for (int t=0;t<16;t++) {
+        workers.push_back(thread([&]() {
+            string value=c1.get_or_load(1,[&loads](const int&) {
+                loads++;
+                this_thread::sleep_for(chrono::milliseconds(200));
+                return string("data1");
+            });
+            if (value!="data1") {
+                errors++;
+            }
+        }));
+    }
+    for (size_t indx=0;indx<workers.size();indx++) {
+        workers[indx].join();
+    }
+
+    BOOST_CHECK(loads==1);
+    BOOST_CHECK(errors==0);
+    string value;
+    BOOST_CHECK(c1.try_get(1,value) && value=="data1");
+}
+
+BOOST_AUTO_TEST_CASE(singleFlightFailure) {
+    concurrent_cache<int,string,policy_lru> c1(100,4);
+    atomic<int> loads(0);
+    atomic<int> failures(0);
+
+    vector<thread> workers;
+    for (int t=0;t<8;t++) {
+        workers.push_back(thread([&]() {
+            try {
+                c1.get_or_load(1,[&loads](const int&) -> string {
+                    loads++;
+                    this_thread::sleep_for(chrono::milliseconds(200));
+                    throw runtime_error("backend is down");
+                });
+            } catch (const runtime_error&) {
+                failures++;
+            }
+        }));
+    }
+    for (size_t indx=0;indx<workers.size();indx++) {
+        workers[indx].join();
+    }
+
+    BOOST_CHECK(loads==1);
+    BOOST_CHECK(failures==8); //Every waiter gets the exception
+    BOOST_CHECK(c1.count(1)==0);
+    BOOST_CHECK(c1.get_or_load(1,[](const int&) { return string("data1"); })=="data1"); //Failed load is not remembered
+}
+
+BOOST_AUTO_TEST_SUITE_END()
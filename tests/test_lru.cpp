@@ -8,11 +8,33 @@
 #define BOOST_TEST_MODULE "STLCachePolicyLRU"
 #include <boost/test/unit_test.hpp>
 
+#include <cstdlib>
+#include <new>
 #include <stlcache/stlcache.hpp>
 
 using namespace stlcache;
 using namespace std;
 
+/*
+ * Counts the heap allocations of the whole test.
+ */
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* block=malloc(size ? size : 1);
+    if (!block) {
+        throw bad_alloc();
+    }
+    return block;
+}
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
 BOOST_AUTO_TEST_SUITE(STLCacheSuite)
 
 BOOST_AUTO_TEST_CASE(firstInserted) {
@@ -40,4 +62,119 @@ BOOST_AUTO_TEST_CASE(touch) {
     BOOST_REQUIRE_THROW(c1.fetch(2),exception_invalid_key); //Must be removed by LRU policy (cause 1 is touched)
 }
 
+BOOST_AUTO_TEST_CASE(duplicate) {
+    cache<int,string,policy_lru> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    BOOST_CHECK(!c1.insert(1,"data1")); //Duplicate insert must not be tracked by the policy
+
+    for (int indx=4;indx<10;indx++) {
+        c1.insert(indx,"data");
+        BOOST_CHECK(c1.size()==3);
+    }
+    BOOST_CHECK(c1.count(7)==1 && c1.count(8)==1 && c1.count(9)==1);
+}
+
+BOOST_AUTO_TEST_CASE(swap) {
+    cache<int,string,policy_lru> c1(3);
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+
+    cache<int,string,policy_lru> c2(2);
+    c2.insert(4,"data4");
+    c2.insert(5,"data5");
+
+    c1.swap(c2); //Policy state is swapped together with the storage
+
+    c1.touch(4);
+    c1.insert(6,"data6");
+    BOOST_REQUIRE_THROW(c1.fetch(5),exception_invalid_key);
+
+    c2.insert(7,"data7");
+    BOOST_REQUIRE_THROW(c2.fetch(1),exception_invalid_key);
+    BOOST_CHECK(c2.size()==3);
+}
+
+BOOST_AUTO_TEST_CASE(clearAndCopy) {
+    cache<int,string,policy_lru> c1(3);
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.clear();
+    c1.insert(2,"data2"); //Must be tracked again after the clear
+    c1.insert(3,"data3");
+    c1.insert(4,"data4");
+
+    cache<int,string,policy_lru> c2(c1); //Copy tracks the same keys, but independently
+    c1.insert(5,"data5");
+    BOOST_REQUIRE_THROW(c1.fetch(2),exception_invalid_key);
+    c2.touch(2);
+    c2.insert(5,"data5");
+    BOOST_REQUIRE_THROW(c2.fetch(3),exception_invalid_key);
+    BOOST_CHECK(c2.check(2) && c2.check(4));
+}
+
+BOOST_AUTO_TEST_CASE(indexed) {
+    cache<int,string,policy_indexed_lru> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(1);
+    c1.insert(4,"data4");
+    BOOST_REQUIRE_THROW(c1.fetch(2),exception_invalid_key); //Must be removed by LRU policy (cause 1 is touched)
+
+    cache<int,string,policy_indexed_lru> c2(c1);
+    cache<int,string,policy_indexed_lru> c3(3);
+    c3.swap(c1);
+    c2.insert(5,"data5");
+    c3.insert(5,"data5");
+    BOOST_REQUIRE_THROW(c2.fetch(3),exception_invalid_key);
+    BOOST_REQUIRE_THROW(c3.fetch(3),exception_invalid_key);
+    BOOST_CHECK(c1.empty());
+}
+
+BOOST_AUTO_TEST_CASE(indexedMatchesList) {
+    cache<unsigned int,unsigned int,policy_lru> c1(100);
+    cache<unsigned int,unsigned int,policy_indexed_lru> c2(100);
+
+    unsigned int seed=42;
+    bool same=true;
+    for (unsigned int indx=0;indx<20000;indx++) {
+        seed=seed*1103515245+12345;
+        unsigned int k=(seed>>16)%300;
+        if (k%7==0) {
+            c1.erase(k);
+            c2.erase(k);
+        } else if (!c1.check(k)) {
+            c1.insert(k,indx);
+            same=same && !c2.check(k);
+            c2.insert(k,indx);
+        } else {
+            same=same && c2.check(k);
+        }
+    }
+    BOOST_CHECK(same);
+    BOOST_CHECK(c1.size()==c2.size());
+}
+
+BOOST_AUTO_TEST_CASE(indexedWithoutAllocations) {
+    cache<unsigned int,unsigned int,policy_indexed_lru,container_flat_hash_map> c1(1000);
+    for (unsigned int indx=0;indx<1000;indx++) {
+        c1.insert(indx,indx);
+    }
+
+    //Full cache under churn: the storage and the policy reuse their arrays and drop the tombstones in place
+    size_t before=allocations;
+    for (unsigned int indx=1000;indx<500000;indx++) {
+        c1.insert(indx,indx);
+        c1.touch(indx-indx%500);
+    }
+    BOOST_CHECK_EQUAL(allocations,before);
+    BOOST_CHECK(c1.size()==1000);
+    BOOST_CHECK(c1.check(499999));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
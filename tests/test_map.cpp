@@ -53,7 +53,8 @@ BOOST_AUTO_TEST_CASE(data) {
     BOOST_CHECK(!c.fetch(1).compare("test"));
     BOOST_REQUIRE_THROW(c.fetch(2),std::exception);
 
-    c.erase(1);
+    BOOST_CHECK(c.erase(1)==1);
+    BOOST_CHECK(c.erase(1)==0); //Erasing missing entry doesn't changes the size
     BOOST_CHECK(c.empty());
     BOOST_CHECK(c.size()==0);
     BOOST_CHECK(!c.check(1));
@@ -76,6 +77,69 @@ BOOST_AUTO_TEST_CASE(data) {
     BOOST_REQUIRE_THROW(c.fetch(2),exception_invalid_key);
 }
 
+BOOST_AUTO_TEST_CASE(lookup) {
+    cache<int,string,policy_lru> c(3);
+
+    c.insert(1,"data1");
+    c.insert(2,"data2");
+    c.insert(3,"data3");
+
+    BOOST_CHECK(c.try_get(4)==nullptr);
+    BOOST_CHECK(c.peek(4)==nullptr);
+
+    BOOST_REQUIRE(c.peek(1)!=nullptr);
+    BOOST_CHECK(!c.peek(1)->compare("data1"));
+
+    c.insert(4,"data4"); //peek doesn't touch, so key 1 is still the LRU entry
+    BOOST_CHECK(c.peek(1)==nullptr);
+
+    BOOST_REQUIRE(c.try_get(2)!=nullptr);
+    BOOST_CHECK(!c.try_get(2)->compare("data2"));
+
+    c.insert(5,"data5"); //try_get touches, so key 3 is the LRU entry now
+    BOOST_CHECK(c.peek(3)==nullptr);
+    BOOST_CHECK(c.peek(2)!=nullptr);
+}
+
+struct counted {
+    static int copies;
+    string value;
+
+    counted(const string& v) : value(v) { }
+    counted(const counted& x) : value(x.value) { copies++; }
+    counted(counted&& x) : value(std::move(x.value)) { }
+    counted& operator=(const counted& x) { value=x.value; copies++; return *this; }
+    counted& operator=(counted&& x) { value=std::move(x.value); return *this; }
+};
+int counted::copies=0;
+
+BOOST_AUTO_TEST_CASE(emplace) {
+    cache<int,counted,policy_lru> c(2);
+    counted::copies=0;
+
+    BOOST_CHECK(c.insert(1,counted("data1")));
+    BOOST_CHECK(c.emplace(2,string("data2")));
+    BOOST_CHECK(!c.emplace(2,string("newdata2"))); //Existing entries are not updated
+    BOOST_CHECK(c.fetch(2).value=="data2");
+
+    counted d3("data3");
+    BOOST_CHECK(c.try_emplace(3,std::move(d3)));
+    BOOST_CHECK(c.size()==2);
+    BOOST_CHECK(c.peek(1)==nullptr); //Key 1 is expired by the LRU policy
+
+    counted d2("newdata2");
+    BOOST_CHECK(!c.try_emplace(2,std::move(d2)));
+    BOOST_CHECK(d2.value=="newdata2"); //Arguments are not consumed for existing keys
+
+    BOOST_CHECK(!c.insert_or_assign(2,std::move(d2))); //Update touches entry 2
+    BOOST_CHECK(c.fetch(2).value=="newdata2");
+    BOOST_CHECK(c.insert_or_assign(4,counted("data4")));
+    BOOST_CHECK(c.peek(3)==nullptr);
+    BOOST_CHECK(c.size()==2);
+
+    BOOST_CHECK(counted::copies==0);
+}
+
 BOOST_AUTO_TEST_CASE(copy) {
     cache<int,string,policy_none> c1(10);
 
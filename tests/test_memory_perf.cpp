@@ -0,0 +1,110 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheMemory"
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+/*
+ * Every allocation is prefixed with it's size, so the live heap size could be tracked.
+ */
+static size_t liveBytes = 0;
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    void* block=malloc(size+alignof(max_align_t));
+    if (!block) {
+        throw bad_alloc();
+    }
+    *static_cast<size_t*>(block)=size;
+    liveBytes+=size;
+    allocations++;
+    return static_cast<char*>(block)+alignof(max_align_t);
+}
+void operator delete(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+    void* block=static_cast<char*>(ptr)-alignof(max_align_t);
+    liveBytes-=*static_cast<size_t*>(block);
+    free(block);
+}
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+const unsigned int noItems = 100000;
+
+/*
+ * Heap used by the policy alone and by the whole cache, when both are filled up.
+ */
+template <class Policy>
+void measure(const char* name) {
+    size_t before=liveBytes;
+    {
+        typename Policy::template bind<unsigned int> policy(noItems);
+        for (unsigned int indx=0;indx<noItems;indx++) {
+            policy.insert(indx);
+        }
+        size_t policyBytes=liveBytes-before;
+
+        size_t empty=liveBytes;
+        cache<unsigned int,unsigned int,Policy> c(noItems);
+        for (unsigned int indx=0;indx<noItems;indx++) {
+            c.insert(indx,indx);
+        }
+        size_t cacheBytes=liveBytes-empty;
+
+        cout<<setw(24)<<name<<": policy "<<fixed<<setprecision(1)<<double(policyBytes)/noItems<<" bytes/entry, cache "<<double(cacheBytes)/noItems<<" bytes/entry"<<endl;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(memory) {
+    measure<policy_lru>("policy_lru");
+    measure<policy_indexed_lru>("policy_indexed_lru");
+    measure<policy_lfu>("policy_lfu");
+    measure<policy_sampled_lru<> >("policy_sampled_lru<5>");
+    measure<policy_sampled_lfu<> >("policy_sampled_lfu<5>");
+}
+
+/*
+ * Calls to the operator new, made by a cache, that is full and keeps replacing it's entries.
+ */
+template <class Policy, class Allocator>
+void churn(const char* name) {
+    cache<unsigned int,unsigned int,Policy,container_unordered_map,weigher_unit,Allocator> c(noItems);
+    for (unsigned int indx=0;indx<noItems;indx++) {
+        c.insert(indx,indx);
+    }
+    size_t before=allocations;
+    for (unsigned int indx=noItems;indx<noItems*2;indx++) {
+        c.insert(indx,indx);
+    }
+    cout<<setw(24)<<name<<": "<<fixed<<setprecision(2)<<double(allocations-before)/noItems<<" allocations/insert at capacity"<<endl;
+}
+
+BOOST_AUTO_TEST_CASE(allocation) {
+    churn<policy_lru,allocator_std>("lru, allocator_std");
+    churn<policy_lru,allocator_pool>("lru, allocator_pool");
+    churn<policy_lfu,allocator_std>("lfu, allocator_std");
+    churn<policy_lfu,allocator_pool>("lfu, allocator_pool");
+    churn<policy_adaptive,allocator_std>("adaptive, allocator_std");
+    churn<policy_adaptive,allocator_pool>("adaptive, allocator_pool");
+}
+
+BOOST_AUTO_TEST_SUITE_END();
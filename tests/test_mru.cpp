@@ -40,4 +40,17 @@ BOOST_AUTO_TEST_CASE(touch) {
     BOOST_REQUIRE_THROW(c1.fetch(1),exception_invalid_key); //Must be removed by MRU policy (cause 1 is touched)
 }
 
+BOOST_AUTO_TEST_CASE(indexed) {
+    cache<int,string,policy_indexed_mru> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(1);
+    c1.insert(4,"data4");
+
+    BOOST_REQUIRE_THROW(c1.fetch(1),exception_invalid_key); //Must be removed by MRU policy (cause 1 is touched)
+    BOOST_CHECK(c1.check(2) && c1.check(3) && c1.check(4));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,105 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCachePolicyS3FIFO"
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+#include "copy_and_swap.hpp"
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(checkVictim) {
+    cache<int,string,policy_s3fifo,container_map> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(2);
+
+    c1.insert(4,"data4"); //Key1 wasn't used in the small queue
+
+    BOOST_CHECK(c1.size()==3);
+    BOOST_REQUIRE_THROW(c1.fetch(1),exception_invalid_key);
+    BOOST_CHECK(c1.count(2)==1);
+}
+
+BOOST_AUTO_TEST_CASE(scanResistance) {
+    cache<int,int,policy_s3fifo,container_unordered_map> c1(10);
+
+    for (int k=0;k<5;k++) {
+        c1.insert(k,k);
+        c1.touch(k);
+        c1.touch(k);
+    }
+    for (int k=100;k<200;k++) { //One-hit wonders never leave the small queue
+        c1.insert(k,k);
+    }
+    for (int k=0;k<5;k++) {
+        BOOST_CHECK(c1.count(k)==1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ghostHit) {
+    cache<int,int,policy_s3fifo> c1(10);
+
+    for (int k=0;k<5;k++) {
+        c1.insert(k,k);
+        c1.touch(k);
+    }
+    for (int k=100;k<200;k++) {
+        c1.insert(k,k);
+    }
+    c1.insert(190,190); //Remembered by the ghost queue, goes to the main one
+    c1.insert(100,100); //Forgotten long ago, goes to the small one
+
+    for (int k=200;k<300;k++) {
+        c1.insert(k,k);
+    }
+    BOOST_CHECK(c1.count(190)==1);
+    BOOST_CHECK(c1.count(100)==0);
+    BOOST_CHECK(c1.size()==10);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    checkCopyAndSwap<policy_s3fifo>();
+}
+
+BOOST_AUTO_TEST_CASE(copyGhosts) {
+    cache<int,int,policy_s3fifo> c1(10);
+
+    for (int k=0;k<5;k++) {
+        c1.insert(k,k);
+        c1.touch(k);
+    }
+    for (int k=100;k<200;k++) {
+        c1.insert(k,k);
+    }
+
+    cache<int,int,policy_s3fifo> c2(c1);
+    c2.insert(190,190); //The copy remembers the ghost, key190 goes to the main queue
+    for (int k=200;k<300;k++) {
+        c2.insert(k,k);
+    }
+    BOOST_CHECK(c2.count(190)==1);
+    for (int k=0;k<5;k++) { //The usage counters are copied as well
+        BOOST_CHECK(c2.count(k)==1);
+    }
+
+    c1.insert(191,191); //The ghost queue of the original is untouched
+    for (int k=200;k<300;k++) {
+        c1.insert(k,k);
+    }
+    BOOST_CHECK(c1.count(191)==1);
+    BOOST_CHECK(c1.count(190)==0);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
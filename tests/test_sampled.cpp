@@ -0,0 +1,133 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCachePolicySampled"
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+#include "copy_and_swap.hpp"
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(checkVictimLRU) {
+    cache<int,string,policy_sampled_lru<64> > c1(3); //Samples cover the whole cache
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(1);
+
+    c1.insert(4,"data4");
+    BOOST_REQUIRE_THROW(c1.fetch(2),exception_invalid_key);
+    c1.insert(5,"data5");
+    BOOST_CHECK(c1.count(3)==0);
+    BOOST_CHECK(c1.count(1)==1 && c1.count(4)==1 && c1.count(5)==1);
+}
+
+BOOST_AUTO_TEST_CASE(checkVictimLFU) {
+    cache<int,string,policy_sampled_lfu<64> > c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    for (int indx=0;indx<50;indx++) {
+        c1.touch(1);
+        c1.touch(3);
+    }
+
+    c1.insert(4,"data4");
+    BOOST_REQUIRE_THROW(c1.fetch(2),exception_invalid_key);
+    c1.insert(5,"data5"); //Key4 is used less, than key1 and key3
+    BOOST_CHECK(c1.count(4)==0);
+    BOOST_CHECK(c1.count(1)==1 && c1.count(3)==1);
+}
+
+BOOST_AUTO_TEST_CASE(approximation) {
+    cache<int,int,policy_sampled_lru<> > c1(100);
+    cache<int,int,policy_lru> c2(100);
+
+    int hits1=0;
+    int hits2=0;
+    unsigned int seed=42;
+    for (int indx=0;indx<100000;indx++) {
+        seed=seed*1103515245+12345;
+        int k=(seed>>16)%1000;
+        k=k*k/5000; //Skewed to the smaller keys
+        if (c1.check(k)) {
+            hits1++;
+        } else {
+            c1.insert(k,k);
+        }
+        if (c2.check(k)) {
+            hits2++;
+        } else {
+            c2.insert(k,k);
+        }
+    }
+    BOOST_CHECK(hits2>0);
+    BOOST_CHECK(hits1>hits2*9/10);
+}
+
+BOOST_AUTO_TEST_CASE(eraseAndChurn) {
+    cache<int,int,policy_sampled_lfu<> > c1(100);
+
+    unsigned int seed=42;
+    for (int indx=0;indx<50000;indx++) {
+        seed=seed*1103515245+12345;
+        int k=(seed>>16)%(indx%5000<2500 ? 150 : 1000);
+        if (k%11==0) {
+            c1.erase(k);
+        } else if (!c1.check(k)) {
+            c1.insert(k,k);
+        }
+    }
+    BOOST_CHECK(c1.size()<=100);
+    for (int k=2000;k<2200;k++) {
+        c1.insert(k,k);
+    }
+    BOOST_CHECK(c1.size()==100);
+    BOOST_CHECK(c1.count(2199)==1);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    checkCopyAndSwap<policy_sampled_lru<> >();
+    checkCopyAndSwap<policy_sampled_lfu<> >();
+}
+
+BOOST_AUTO_TEST_CASE(copyPool) {
+    cache<int,int,policy_sampled_lru<2> > c1(20);
+    cache<int,int,policy_sampled_lru<2> > c4(20); //Gets the same history, as c1
+
+    for (int k=0;k<100;k++) { //Fills the candidate pool
+        c1.insert(k,k);
+        c4.insert(k,k);
+        c1.touch(k-k%7);
+        c4.touch(k-k%7);
+    }
+
+    cache<int,int,policy_sampled_lru<2> > c2(c1);
+    cache<int,int,policy_sampled_lru<2> > c3(20);
+    c3=c1;
+
+    //The pool, the access clock and the random state are copied, so the copies expire the same entries, as a cache with the same history
+    bool same=true;
+    for (int k=100;k<300;k++) {
+        c2.insert(k,k);
+        c3.insert(k,k);
+        c4.insert(k,k);
+        for (int key=k-20;key<=k;key++) {
+            same=same && c2.count(key)==c4.count(key) && c3.count(key)==c4.count(key);
+        }
+    }
+    BOOST_CHECK(same);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,90 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCachePolicySieve"
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(checkVictim) {
+    cache<int,string,policy_sieve,container_map> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(1);
+
+    c1.insert(4,"data4"); //The hand unmarks key1 and stops at key2
+    c1.insert(5,"data5"); //The hand stays in place and key1 isn't passed again
+
+    BOOST_CHECK(c1.size()==3);
+    BOOST_CHECK(c1.count(1)==1);
+    BOOST_CHECK(c1.count(2)==0 && c1.count(3)==0);
+}
+
+BOOST_AUTO_TEST_CASE(wrapAround) {
+    cache<int,string,policy_sieve,container_unordered_map> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(1);
+    c1.touch(2);
+    c1.touch(3);
+
+    c1.insert(4,"data4"); //Everything is visited, so the hand wraps around to the oldest entry
+
+    BOOST_REQUIRE_THROW(c1.fetch(1),exception_invalid_key);
+    BOOST_CHECK(c1.count(2)==1 && c1.count(3)==1 && c1.count(4)==1);
+}
+
+BOOST_AUTO_TEST_CASE(eraseAtHand) {
+    cache<int,int,policy_sieve> c1(100);
+
+    unsigned int seed=42;
+    for (int indx=0;indx<20000;indx++) {
+        seed=seed*1103515245+12345;
+        int k=(seed>>16)%300;
+        if (k%5==0) {
+            c1.erase(k);
+        } else if (!c1.check(k)) {
+            c1.insert(k,k);
+        }
+    }
+    BOOST_CHECK(c1.size()<=100);
+    for (int k=1000;k<1200;k++) {
+        c1.insert(k,k);
+    }
+    BOOST_CHECK(c1.size()==100);
+    BOOST_CHECK(c1.count(1199)==1);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    cache<int,string,policy_sieve> c1(3);
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.touch(1);
+    c1.insert(4,"data4");
+
+    cache<int,string,policy_sieve> c2(c1);
+    cache<int,string,policy_sieve> c3(3);
+    c3.swap(c1);
+    BOOST_CHECK(c1.empty());
+
+    c2.insert(5,"data5");
+    c3.insert(5,"data5");
+    BOOST_CHECK(c2.count(3)==0 && c3.count(3)==0);
+    BOOST_CHECK(c2.count(1)==1 && c3.count(1)==1);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,110 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCachePolicySLRU"
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+#include "copy_and_swap.hpp"
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(checkVictim) {
+    cache<int,string,policy_slru<50> > c1(4); //Two entries on probation and two protected
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.insert(4,"data4");
+    c1.touch(1);
+    c1.touch(2);
+    c1.touch(3); //Key1 doesn't fit into the protected segment and goes back to probation
+
+    c1.insert(5,"data5");
+    BOOST_REQUIRE_THROW(c1.fetch(4),exception_invalid_key);
+    c1.insert(6,"data6");
+    BOOST_CHECK(c1.count(1)==0);
+    BOOST_CHECK(c1.count(2)==1 && c1.count(3)==1);
+}
+
+BOOST_AUTO_TEST_CASE(scanResistance) {
+    cache<int,int,policy_slru<> > c1(100);
+
+    for (int k=0;k<80;k++) {
+        c1.insert(k,k);
+        c1.touch(k);
+    }
+    for (int k=1000;k<2000;k++) {
+        c1.insert(k,k);
+    }
+
+    bool kept=true;
+    for (int k=0;k<80;k++) {
+        kept=kept && c1.count(k)==1;
+    }
+    BOOST_CHECK(kept);
+    BOOST_CHECK(c1.count(1999)==1);
+}
+
+BOOST_AUTO_TEST_CASE(eraseAndChurn) {
+    cache<int,int,policy_slru<> > c1(100);
+
+    unsigned int seed=42;
+    for (int indx=0;indx<50000;indx++) {
+        seed=seed*1103515245+12345;
+        int k=(seed>>16)%(indx%5000<2500 ? 150 : 1000);
+        if (k%11==0) {
+            c1.erase(k);
+        } else if (!c1.check(k)) {
+            c1.insert(k,k);
+        }
+    }
+    BOOST_CHECK(c1.size()<=100);
+    for (int k=2000;k<2200;k++) {
+        c1.insert(k,k);
+    }
+    BOOST_CHECK(c1.size()==100);
+    BOOST_CHECK(c1.count(2199)==1);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    checkCopyAndSwap<policy_slru<> >();
+}
+
+BOOST_AUTO_TEST_CASE(copyProtected) {
+    cache<int,string,policy_slru<50> > c1(4);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.insert(4,"data4");
+    c1.touch(1);
+    c1.touch(2); //Key1 and key2 are protected
+
+    cache<int,string,policy_slru<50> > c2(c1);
+    cache<int,string,policy_slru<50> > c3(4);
+    c3=c1;
+    for (int k=10;k<30;k++) { //The scan only passes through the probation segment
+        c2.insert(k,"data");
+        c3.insert(k,"data");
+    }
+    BOOST_CHECK(c2.count(1)==1 && c2.count(2)==1 && c2.count(29)==1);
+    BOOST_CHECK(c3.count(1)==1 && c3.count(2)==1 && c3.count(29)==1);
+
+    c2.touch(29); //Key29 is promoted and key1 goes back to probation in the copy only
+    c2.insert(30,"data");
+    c2.insert(31,"data");
+    BOOST_CHECK(c2.count(1)==0 && c2.count(2)==1 && c2.count(29)==1);
+    c1.insert(30,"data");
+    BOOST_CHECK(c1.count(1)==1 && c1.count(2)==1);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,186 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheStats"
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+using counted_cache = cache<int,string,policy_lru,container_unordered_map,weigher_unit,allocator_std,stats_counters> ;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(disabled) {
+    cache<int,string,policy_lru> c1(2);
+    c1.insert(1,"data1");
+    BOOST_CHECK(c1.try_get(1)!=nullptr);
+    BOOST_CHECK(c1.try_get(2)==nullptr);
+
+    cache_stats s=c1.stats();
+    BOOST_CHECK_EQUAL(s.hits,0);
+    BOOST_CHECK_EQUAL(s.misses,0);
+    BOOST_CHECK_EQUAL(s.inserts,0);
+
+    BOOST_CHECK(sizeof(_ttl_stats<stats_none>)==sizeof(std::chrono::milliseconds)); //The empty model takes no space in the cache
+}
+
+BOOST_AUTO_TEST_CASE(lookups) {
+    counted_cache c1(10);
+    c1.insert(1,"data1");
+    c1.insert(1,"data1"); //Existing key is not an insert
+    c1.insert(2,"data2");
+
+    BOOST_CHECK(c1.try_get(1)!=nullptr);
+    BOOST_CHECK(c1.try_get(3)==nullptr);
+    BOOST_CHECK(c1.check(2));
+    BOOST_CHECK(!c1.check(4));
+    BOOST_CHECK(c1.fetch(2)=="data2");
+    BOOST_REQUIRE_THROW(c1.fetch(5),exception_invalid_key);
+    BOOST_CHECK(c1.peek(1)!=nullptr); //Not counted
+    BOOST_CHECK(c1.count(3)==0);
+
+    cache_stats s=c1.stats();
+    BOOST_CHECK_EQUAL(s.hits,3);
+    BOOST_CHECK_EQUAL(s.misses,3);
+    BOOST_CHECK_EQUAL(s.inserts,2);
+    BOOST_CHECK_CLOSE(s.hit_ratio(),0.5,0.001);
+
+    c1.reset_stats();
+    BOOST_CHECK_EQUAL(c1.stats().hits,0);
+    BOOST_CHECK_EQUAL(c1.stats().inserts,0);
+}
+
+BOOST_AUTO_TEST_CASE(evictions) {
+    counted_cache c1(2);
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.insert(4,"data4");
+    BOOST_CHECK(c1.insert_or_assign(4,"data44")==false);
+    c1.erase(4);
+    c1.erase(5); //Nothing is removed
+
+    cache_stats s=c1.stats();
+    BOOST_CHECK_EQUAL(s.inserts,4);
+    BOOST_CHECK_EQUAL(s.updates,1);
+    BOOST_CHECK_EQUAL(s.evictions[eviction_size],2);
+    BOOST_CHECK_EQUAL(s.evictions[eviction_explicit],1);
+    BOOST_CHECK_EQUAL(s.evictions_total(),3);
+
+    c1.insert(5,"data5",chrono::milliseconds(20));
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    BOOST_CHECK(c1.try_get(5)==nullptr);
+    BOOST_CHECK_EQUAL(c1.stats().evictions[eviction_expired],1);
+}
+
+BOOST_AUTO_TEST_CASE(weight) {
+    cache<int,string,policy_lru,container_unordered_map,weigher_bytes,allocator_std,stats_counters> c1(10,100);
+    c1.insert(1,"12345");
+    c1.insert(2,"12345");
+    c1.insert(3,"12345"); //Entry count is fine, the weight is not
+
+    BOOST_CHECK_EQUAL(c1.stats().evictions[eviction_weight],1);
+    BOOST_CHECK_EQUAL(c1.stats().evictions[eviction_size],0);
+}
+
+BOOST_AUTO_TEST_CASE(loads) {
+    counted_cache c1(10);
+    BOOST_CHECK(c1.get_or_load(1,[](int) { return string("data1"); })=="data1");
+    BOOST_CHECK(c1.get_or_load(1,[](int) { return string("other"); })=="data1");
+    BOOST_REQUIRE_THROW(c1.get_or_load(2,[](int) -> string { throw runtime_error("no data"); }),runtime_error);
+
+    cache_stats s=c1.stats();
+    BOOST_CHECK_EQUAL(s.hits,1);
+    BOOST_CHECK_EQUAL(s.misses,2);
+    BOOST_CHECK_EQUAL(s.loads,1);
+    BOOST_CHECK_EQUAL(s.load_failures,1);
+    BOOST_CHECK_EQUAL(s.inserts,1);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    counted_cache c1(10);
+    c1.insert(1,"data1");
+    c1.try_get(1);
+
+    counted_cache c2(c1);
+    BOOST_CHECK_EQUAL(c2.stats().hits,1);
+    c2.try_get(1);
+    BOOST_CHECK_EQUAL(c1.stats().hits,1);
+
+    counted_cache c3(10);
+    c3.swap(c2);
+    BOOST_CHECK_EQUAL(c3.stats().hits,2);
+    BOOST_CHECK_EQUAL(c2.stats().hits,0);
+}
+
+BOOST_AUTO_TEST_CASE(prometheus) {
+    counted_cache c1(1);
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.try_get(2);
+
+    string text;
+    c1.stats().prometheus([&text](const string& _t) { text+=_t; },"test_cache","instance=\"a\"");
+    BOOST_CHECK(text.find("# TYPE test_cache_hits_total counter\n")!=string::npos);
+    BOOST_CHECK(text.find("test_cache_hits_total{instance=\"a\"} 1\n")!=string::npos);
+    BOOST_CHECK(text.find("test_cache_inserts_total{instance=\"a\"} 2\n")!=string::npos);
+    BOOST_CHECK(text.find("test_cache_evictions_total{instance=\"a\",reason=\"size\"} 1\n")!=string::npos);
+    BOOST_CHECK(text.find("test_cache_load_seconds_total{instance=\"a\"} 0.000000000\n")!=string::npos);
+
+    text.clear();
+    c1.stats().prometheus([&text](const string& _t) { text+=_t; });
+    BOOST_CHECK(text.find("stlcache_misses_total 0\n")!=string::npos);
+    BOOST_CHECK(text.find("stlcache_evictions_total{reason=\"explicit\"} 0\n")!=string::npos);
+}
+
+template <class Concurrency>
+void concurrent() {
+    concurrent_cache<int,int,policy_lru,container_unordered_map,weigher_unit,std::hash<int>,Concurrency,allocator_std,stats_counters> c1(4000,4);
+    vector<thread> threads;
+    for (int t=0;t<4;t++) {
+        threads.push_back(thread([&c1]() {
+            for (int indx=0;indx<1000;indx++) {
+                int value;
+                if (!c1.try_get(indx,value)) {
+                    c1.insert(indx,indx);
+                }
+            }
+        }));
+    }
+    for (size_t indx=0;indx<threads.size();indx++) {
+        threads[indx].join();
+    }
+
+    cache_stats s=c1.stats();
+    BOOST_CHECK_EQUAL(s.hits+s.misses,4000);
+    BOOST_CHECK_EQUAL(s.inserts,1000);
+
+    c1.get_or_load(5000,[](int k) { return k; });
+    BOOST_CHECK_EQUAL(c1.stats().loads,1);
+    BOOST_CHECK_EQUAL(c1.stats().misses,s.misses+1); //The leader checks the cache again, without counting it
+
+    c1.reset_stats();
+    BOOST_CHECK_EQUAL(c1.stats().hits+c1.stats().misses+c1.stats().loads,0);
+}
+
+BOOST_AUTO_TEST_CASE(concurrentLocked) {
+    concurrent<concurrency_locked>();
+}
+
+BOOST_AUTO_TEST_CASE(concurrentBuffered) {
+    concurrent<concurrency_buffered>();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,182 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheTTL"
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <thread>
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+#define WAIT_FOR_EXPIRATION std::this_thread::sleep_for(std::chrono::milliseconds(120));
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(perEntry) {
+    cache<int,string,policy_lru> c1(10);
+
+    c1.insert(1,"data1",chrono::milliseconds(50));
+    c1.insert(2,"data2");
+    BOOST_CHECK(c1.peek(1)!=nullptr);
+
+    WAIT_FOR_EXPIRATION
+
+    BOOST_CHECK(c1.peek(1)==nullptr); //Expired, but not reclaimed yet
+    BOOST_CHECK(c1.count(1)==0);
+    BOOST_CHECK(c1.size()==2);
+
+    BOOST_CHECK(c1.try_get(1)==nullptr);
+    BOOST_CHECK(c1.size()==1);
+    BOOST_CHECK(c1.fetch(2)=="data2");
+    BOOST_REQUIRE_THROW(c1.fetch(1),exception_invalid_key);
+
+    BOOST_CHECK(c1.insert(1,"data3")); //Reinserted without ttl
+    WAIT_FOR_EXPIRATION
+    BOOST_CHECK(c1.check(1));
+}
+
+BOOST_AUTO_TEST_CASE(defaultTtl) {
+    cache<int,string,policy_lru> c1(10);
+
+    c1.set_default_ttl(chrono::milliseconds(50));
+    BOOST_CHECK(c1.default_ttl()==chrono::milliseconds(50));
+
+    c1.insert(1,"data1");
+    c1.try_emplace(2,"data2");
+    c1.insert(3,"data3",chrono::seconds(3600));
+
+    WAIT_FOR_EXPIRATION
+
+    BOOST_CHECK(!c1.check(1));
+    BOOST_CHECK(!c1.check(2));
+    BOOST_CHECK(c1.check(3));
+    BOOST_CHECK(c1.size()==1);
+}
+
+BOOST_AUTO_TEST_CASE(expiredBeforeVictim) {
+    cache<int,string,policy_lru> c1(3);
+
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.insert(1,"data1",chrono::milliseconds(50));
+    c1.touch(1);
+
+    WAIT_FOR_EXPIRATION
+
+    c1.insert(4,"data4"); //Expired entry is reclaimed, so LRU doesn't need a victim
+    BOOST_CHECK(c1.size()==3);
+    BOOST_CHECK(c1.count(2)==1 && c1.count(3)==1 && c1.count(4)==1);
+}
+
+BOOST_AUTO_TEST_CASE(expireAfter) {
+    cache<int,string,policy_lru> c1(10);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2",chrono::milliseconds(50));
+    BOOST_CHECK(c1.expire_after(1,chrono::milliseconds(50)));
+    BOOST_CHECK(c1.expire_after(2,chrono::milliseconds::zero())); //Never expires now
+    BOOST_CHECK(!c1.expire_after(3,chrono::milliseconds(50)));
+
+    WAIT_FOR_EXPIRATION
+
+    BOOST_CHECK(c1.count(1)==0);
+    BOOST_CHECK(c1.count(2)==1);
+}
+
+BOOST_AUTO_TEST_CASE(assign) {
+    cache<int,string,policy_lru> c1(10);
+
+    c1.insert(1,"data1",chrono::milliseconds(50));
+    BOOST_CHECK(!c1.insert_or_assign(1,string("data2"))); //No default ttl, so it never expires now
+    c1.insert_or_assign(2,string("data2"),chrono::milliseconds(50));
+
+    WAIT_FOR_EXPIRATION
+
+    BOOST_CHECK(c1.count(1)==1);
+    BOOST_CHECK(c1.count(2)==0);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    cache<int,string,policy_lru> c1(10);
+    c1.insert(1,"data1",chrono::milliseconds(50));
+    c1.insert(2,"data2");
+
+    cache<int,string,policy_lru> c2(c1);
+    cache<int,string,policy_lru> c3(10);
+    c3.swap(c1);
+
+    WAIT_FOR_EXPIRATION
+
+    BOOST_CHECK(c2.count(1)==0 && c2.count(2)==1);
+    BOOST_CHECK(c3.count(1)==0 && c3.count(2)==1);
+    BOOST_CHECK(c1.empty());
+    c2.erase(1);
+    c2.clear();
+    BOOST_CHECK(c2.empty());
+}
+
+BOOST_AUTO_TEST_CASE(concurrent) {
+    concurrent_cache<int,string,policy_lru> c1(100,4);
+
+    c1.insert(1,"data1",chrono::milliseconds(50));
+    c1.insert(2,"data2");
+
+    WAIT_FOR_EXPIRATION
+
+    string value;
+    BOOST_CHECK(!c1.try_get(1,value));
+    BOOST_CHECK(c1.try_get(2,value));
+}
+
+BOOST_AUTO_TEST_CASE(wheel) {
+    typedef _timing_wheel<int,container_unordered_map> wheel_type;
+    wheel_type w;
+    map<int,wheel_type::tick_type> deadlines;
+
+    mt19937 rng(42);
+    uniform_int_distribution<unsigned long> deadline(1,1ul<<26);
+    for (int indx=0;indx<20000;indx++) {
+        wheel_type::tick_type d=deadline(rng)>>(rng()%24);
+        if (d==0) {
+            d=1;
+        }
+        w.schedule(indx,d);
+        deadlines[indx]=d;
+    }
+    for (int indx=0;indx<1000;indx++) {
+        w.remove(indx);
+        deadlines.erase(indx);
+    }
+
+    wheel_type::tick_type now=0;
+    bool ok=true;
+    while (!w.empty()) {
+        now+=rng()%(1u<<(rng()%24))+1;
+        w.advance(now,[&](const int& k) {
+            map<int,wheel_type::tick_type>::iterator it=deadlines.find(k);
+            if (it==deadlines.end() || it->second>now) {
+                ok=false; //Expired too early or twice
+            } else {
+                deadlines.erase(it);
+            }
+        });
+        for (map<int,wheel_type::tick_type>::iterator it=deadlines.begin();it!=deadlines.end();++it) {
+            if (it->second<=now) {
+                ok=false; //Missed
+            }
+        }
+    }
+    BOOST_CHECK(ok);
+    BOOST_CHECK(deadlines.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
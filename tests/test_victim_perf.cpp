@@ -8,14 +8,14 @@
 #define BOOST_TEST_MODULE "STLCacheVictimPerformance"
 #include <boost/test/unit_test.hpp>
 
-#ifdef _WIN32
-#include "timeval.h"
-#else 
-#include <sys/time.h>
-#endif /* _WIN32 */
+#include <chrono>
 #include <iostream>
+#include <thread>
+#include <vector>
 #include <stlcache/stlcache.hpp>
 
+#include "workload.hpp"
+
 using namespace stlcache;
 using namespace std ;
 
@@ -23,175 +23,159 @@ BOOST_AUTO_TEST_SUITE(STLCacheSuite)
 
 const unsigned long noItems = 65536;
 
-BOOST_AUTO_TEST_CASE(victimNone) {
-    struct timeval start,stop;
-
-    cache<unsigned int,unsigned int,policy_none> c(noItems);
+/*
+ * A skewed popularity over four times more keys, than the cache holds, and the same popularity, interrupted by scans of never repeated
+ * keys every quarter of the trace.
+ */
+const vector<unsigned int> zipfTrace=workload::trace(workload::zipf(noItems*4,0.9,42),noItems);
+const vector<unsigned int> scanTrace=workload::trace(workload::mixed(noItems*4,0.9,noItems/4,noItems/16,42),noItems);
+
+/*
+ * Fills the cache with the keys, that the traces never request, so the first request of every key expires an entry.
+ */
+template <class Cache>
+void victim(const char* name, const char* traceName, const vector<unsigned int>& trace) {
+    Cache c(noItems);
     for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
+        c.insert(noItems*8+indx,indx);
     }
 
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = noItems; indx<noItems*2; indx++) {
-        c.insert(indx,indx);
+    chrono::steady_clock::time_point start=chrono::steady_clock::now();
+    for(unsigned int indx = 0; indx<trace.size(); indx++) {
+        c.insert(trace[indx],indx);
     }
+    chrono::steady_clock::time_point stop=chrono::steady_clock::now();
 
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" excessive items into policy_none cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    cout<<"Insertion of "<<trace.size()<<" "<<traceName<<" requests into full "<<name<<" took "<<chrono::duration_cast<chrono::milliseconds>(stop-start).count()<<" milliseconds"<<endl;
 }
 
-BOOST_AUTO_TEST_CASE(victimLRU) {
-    struct timeval start,stop;
+template <class Cache>
+void victim(const char* name) {
+    victim<Cache>(name,"zipf",zipfTrace);
+    victim<Cache>(name,"scan",scanTrace);
+}
 
-    cache<unsigned int,unsigned int,policy_lru> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
+BOOST_AUTO_TEST_CASE(victimNone) {
+    victim<cache<unsigned int,unsigned int,policy_none> >("policy_none cache");
+}
 
-    gettimeofday(&start, NULL); 
+BOOST_AUTO_TEST_CASE(victimLRU) {
+    victim<cache<unsigned int,unsigned int,policy_lru> >("policy_lru cache");
+}
 
-    for(unsigned int indx = noItems; indx<noItems*2; indx++) {
-        c.insert(indx,indx);
-    }
+BOOST_AUTO_TEST_CASE(victimLRUMap) {
+    victim<cache<unsigned int,unsigned int,policy_lru,container_map> >("policy_lru cache with container_map");
+}
 
-    gettimeofday(&stop, NULL); 
+BOOST_AUTO_TEST_CASE(victimLRUFlatHashMap) {
+    victim<cache<unsigned int,unsigned int,policy_lru,container_flat_hash_map> >("policy_lru cache with container_flat_hash_map");
+}
 
-    cout<<"Insertion of "<<noItems<<" excessive items into policy_lru cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+BOOST_AUTO_TEST_CASE(victimIndexedLRU) {
+    victim<cache<unsigned int,unsigned int,policy_indexed_lru,container_flat_hash_map> >("policy_indexed_lru cache with container_flat_hash_map");
 }
 
 BOOST_AUTO_TEST_CASE(victimUnorderedLRU) {
-    struct timeval start,stop;
-
-    cache<unsigned int,unsigned int,policy_unordered_lru> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&start, NULL);
-
-    for(unsigned int indx = noItems; indx<noItems*2; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL);
+    victim<cache<unsigned int,unsigned int,policy_unordered_lru> >("policy_unordered_lru cache");
+}
 
-    cout<<"Insertion of "<<noItems<<" excessive items into policy_unordered_lru cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+BOOST_AUTO_TEST_CASE(victimIntrusiveLRU) {
+    victim<intrusive_cache<unsigned int,unsigned int,policy_lru> >("intrusive policy_lru cache");
 }
 
 BOOST_AUTO_TEST_CASE(victimMRU) {
-    struct timeval start,stop;
-
-    cache<unsigned int,unsigned int,policy_mru> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = noItems; indx<noItems*2; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" excessive items into policy_mru cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    victim<cache<unsigned int,unsigned int,policy_mru> >("policy_mru cache");
 }
 
 BOOST_AUTO_TEST_CASE(victimLFU) {
-    struct timeval start,stop;
-
-    cache<unsigned int,unsigned int,policy_lfu> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = noItems; indx<noItems*2; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" excessive items into policy_lfu cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    victim<cache<unsigned int,unsigned int,policy_lfu> >("policy_lfu cache");
 }
 
 BOOST_AUTO_TEST_CASE(victimLFUStar) {
-    struct timeval start,stop;
-
-    cache<unsigned int,unsigned int,policy_lfustar> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = noItems; indx<noItems*2; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" excessive items into policy_lfustar cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    victim<cache<unsigned int,unsigned int,policy_lfustar> >("policy_lfustar cache");
 }
 
 BOOST_AUTO_TEST_CASE(victimLFUAging) {
-    struct timeval start,stop;
-
-    cache<unsigned int,unsigned int,policy_lfuaging<3600> > c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&start, NULL); 
-
-    for(unsigned int indx = noItems; indx<noItems*2; indx++) {
-        c.insert(indx,indx);
-    }
-
-    gettimeofday(&stop, NULL); 
-
-    cout<<"Insertion of "<<noItems<<" excessive items into policy_lfuaging cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    victim<cache<unsigned int,unsigned int,policy_lfuaging<3600> > >("policy_lfuaging cache");
 }
 
 BOOST_AUTO_TEST_CASE(victimLFUAgingStar) {
-    struct timeval start,stop;
-
-    cache<unsigned int,unsigned int,policy_lfuagingstar<3600> > c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
-    }
+    victim<cache<unsigned int,unsigned int,policy_lfuagingstar<3600> > >("policy_lfuagingstar cache");
+}
 
-    gettimeofday(&start, NULL); 
+BOOST_AUTO_TEST_CASE(victimSIEVE) {
+    victim<cache<unsigned int,unsigned int,policy_sieve> >("policy_sieve cache");
+}
 
-    for(unsigned int indx = noItems; indx<noItems*2; indx++) {
-        c.insert(indx,indx);
-    }
+BOOST_AUTO_TEST_CASE(victimSIEVEMap) {
+    victim<cache<unsigned int,unsigned int,policy_sieve,container_map> >("policy_sieve cache with container_map");
+}
 
-    gettimeofday(&stop, NULL); 
+BOOST_AUTO_TEST_CASE(victimS3FIFO) {
+    victim<cache<unsigned int,unsigned int,policy_s3fifo> >("policy_s3fifo cache");
+}
 
-    cout<<"Insertion of "<<noItems<<" excessive items into policy_lfuagingstar cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+BOOST_AUTO_TEST_CASE(victimS3FIFOMap) {
+    victim<cache<unsigned int,unsigned int,policy_s3fifo,container_map> >("policy_s3fifo cache with container_map");
 }
 
 BOOST_AUTO_TEST_CASE(insertAdaptive) {
-    struct timeval start,stop;
+    victim<cache<unsigned int,unsigned int,policy_adaptive> >("policy_adaptive cache");
+}
 
-    cache<unsigned int,unsigned int,policy_adaptive> c(noItems);
-    for(unsigned int indx = 0; indx<noItems; indx++) {
-        c.insert(indx,indx);
+/*
+ * Touches the LFU policies of the growing size directly, so the cache storage lookup isn't timed. The same number of hot keys is spread
+ * over the whole policy, so the touched entries fit the processor caches and the TLB at any size, and the touch cost must not grow
+ * with the size.
+ */
+BOOST_AUTO_TEST_CASE(touchLFUScaling) {
+    const unsigned long noTouches = noItems*16;
+    const unsigned int noHot = 256;
+
+    for (unsigned int bits = 12; bits<=20; bits+=4) {
+        unsigned long size = 1UL<<bits;
+        policy_lfu::bind<unsigned int> c(size);
+        for(unsigned int indx = 0; indx<size; indx++) {
+            c.insert(indx);
+        }
+        vector<unsigned int> touchTrace=workload::trace(workload::uniform(noHot,42),noTouches);
+        for(unsigned int indx = 0; indx<touchTrace.size(); indx++) {
+            touchTrace[indx]*=size/noHot;
+        }
+
+        chrono::steady_clock::time_point start=chrono::steady_clock::now();
+        for(unsigned int indx = 0; indx<touchTrace.size(); indx++) {
+            c.touch(touchTrace[indx]);
+        }
+        chrono::steady_clock::time_point stop=chrono::steady_clock::now();
+
+        cout<<"Touching "<<noHot<<" hot entries "<<noTouches<<" times in policy_lfu of "<<size<<" items took "<<chrono::duration_cast<chrono::nanoseconds>(stop-start).count()/noTouches<<" nanoseconds per touch"<<endl;
     }
+}
 
-    gettimeofday(&start, NULL); 
+BOOST_AUTO_TEST_CASE(victimLFUAgingLatency) {
+    long worst=0;
 
-    for(unsigned int indx = noItems; indx<noItems*2; indx++) {
-        c.insert(indx,indx);
+    cache<unsigned int,unsigned int,policy_lfuaging<1> > c(noItems*4);
+    for(unsigned int indx = 0; indx<noItems*4; indx++) {
+        c.insert(noItems*8+indx,indx);
+        c.touch(noItems*8+indx);
     }
 
-    gettimeofday(&stop, NULL); 
+    std::this_thread::sleep_for(std::chrono::seconds(2)); //Every entry is stale now
+
+    for(unsigned int indx = 0; indx<zipfTrace.size(); indx++) {
+        chrono::steady_clock::time_point start=chrono::steady_clock::now();
+        c.insert(zipfTrace[indx],indx);
+        chrono::steady_clock::time_point stop=chrono::steady_clock::now();
+
+        long took=static_cast<long>(chrono::duration_cast<chrono::microseconds>(stop-start).count());
+        if (took>worst) {
+            worst=took;
+        }
+    }
 
-    cout<<"Insertion of "<<noItems<<" excessive items into policy_adaptive cache took "<<((stop.tv_sec-start.tv_sec)*1000)+((stop.tv_usec-start.tv_usec)/1000)<<" milliseconds"<<endl;
+    cout<<"Worst insertion latency of the zipf requests into stale policy_lfuaging cache of "<<noItems*4<<" items is "<<worst<<" microseconds"<<endl;
 }
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,122 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheWeight"
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+struct weigher_length {
+    size_t operator()(const int&, const string& _d) const {
+        return _d.size();
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(unit) {
+    cache<int,string,policy_lru> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    BOOST_CHECK(c1.weight()==2);
+    c1.erase(1);
+    BOOST_CHECK(c1.weight()==1);
+    c1.clear();
+    BOOST_CHECK(c1.weight()==0);
+}
+
+BOOST_AUTO_TEST_CASE(evictByWeight) {
+    cache<int,string,policy_lru,container_unordered_map,weigher_length> c1(100,10);
+
+    c1.insert(1,"aaaa");
+    c1.insert(2,"bbbb");
+    BOOST_CHECK(c1.weight()==8);
+
+    c1.insert(3,"ccccccc"); //Needs 7, so both 1 and 2 must be expired
+    BOOST_CHECK(c1.size()==1);
+    BOOST_CHECK(c1.weight()==7);
+    BOOST_CHECK(c1.count(3)==1);
+
+    c1.insert(4,"dd");
+    c1.touch(3);
+    c1.insert(5,"ee"); //LRU entry 4 is expired
+    BOOST_CHECK(c1.count(4)==0);
+    BOOST_CHECK(c1.count(3)==1 && c1.count(5)==1);
+    BOOST_CHECK(c1.weight()==9);
+}
+
+BOOST_AUTO_TEST_CASE(tooHeavy) {
+    cache<int,string,policy_lru,container_unordered_map,weigher_length> c1(100,10);
+
+    c1.insert(1,"aaaa");
+    BOOST_REQUIRE_THROW(c1.insert(2,"bbbbbbbbbbbb"),exception_cache_full);
+    BOOST_CHECK(c1.size()==1);
+    BOOST_CHECK(c1.weight()==4);
+    BOOST_CHECK(c1.count(1)==1);
+}
+
+BOOST_AUTO_TEST_CASE(countLimit) {
+    cache<int,string,policy_lru,container_unordered_map,weigher_length> c1(2,100);
+
+    c1.insert(1,"a");
+    c1.insert(2,"b");
+    c1.insert(3,"c");
+    BOOST_CHECK(c1.size()==2);
+    BOOST_CHECK(c1.weight()==2);
+    BOOST_CHECK(c1.count(1)==0);
+}
+
+BOOST_AUTO_TEST_CASE(assign) {
+    cache<int,string,policy_lru,container_unordered_map,weigher_length> c1(100,10);
+
+    c1.insert(1,"aaaa");
+    c1.insert(2,"bbbb");
+    BOOST_CHECK(!c1.insert_or_assign(2,string("bb")));
+    BOOST_CHECK(c1.weight()==6);
+
+    BOOST_CHECK(!c1.insert_or_assign(2,string("bbbbbbbb"))); //Grows over the limit, so 1 is expired
+    BOOST_CHECK(c1.weight()==8);
+    BOOST_CHECK(c1.count(1)==0);
+    BOOST_CHECK(c1.fetch(2)=="bbbbbbbb");
+}
+
+BOOST_AUTO_TEST_CASE(swapAndCopy) {
+    cache<int,string,policy_lru,container_unordered_map,weigher_length> c1(100,10);
+    cache<int,string,policy_lru,container_unordered_map,weigher_length> c2(100,20);
+
+    c1.insert(1,"aaaa");
+    c1.swap(c2);
+    BOOST_CHECK(c1.weight()==0 && c1.max_weight()==20);
+    BOOST_CHECK(c2.weight()==4 && c2.max_weight()==10);
+
+    cache<int,string,policy_lru,container_unordered_map,weigher_length> c3(c2);
+    BOOST_CHECK(c3.weight()==4 && c3.max_weight()==10);
+}
+
+BOOST_AUTO_TEST_CASE(bytes) {
+    weigher_bytes w;
+
+    BOOST_CHECK(w(1,2.0)==sizeof(int)+sizeof(double));
+    BOOST_CHECK(w(1,string("abc"))==sizeof(int)+sizeof(string)+3);
+    BOOST_CHECK(w(1,vector<int>(5))==sizeof(int)+sizeof(vector<int>)+5*sizeof(int));
+
+    vector<string> v(2,string("ab"));
+    BOOST_CHECK(w(1,v)==sizeof(int)+sizeof(vector<string>)+2*(sizeof(string)+2));
+
+    cache<int,vector<char>,policy_lru,container_unordered_map,weigher_bytes> c1(100,3*(sizeof(int)+sizeof(vector<char>)+100));
+    for (int indx=0;indx<10;indx++) {
+        c1.insert(indx,vector<char>(100));
+        BOOST_CHECK(c1.weight()<=c1.max_weight());
+    }
+    BOOST_CHECK(c1.size()==3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCacheWorkload"
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "workload.hpp"
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(deterministic) {
+    BOOST_CHECK(workload::trace(workload::zipf(1000,0.9,42),1000)==workload::trace(workload::zipf(1000,0.9,42),1000));
+    BOOST_CHECK(workload::trace(workload::zipf(1000,0.9,42),1000)!=workload::trace(workload::zipf(1000,0.9,43),1000));
+    BOOST_CHECK(workload::trace(workload::uniform(1000,42),1000)==workload::trace(workload::uniform(1000,42),1000));
+
+    workload::random r(1);
+    BOOST_CHECK_EQUAL(r.next(),UINT64_C(0x910A2DEC89025CC1)); //SplitMix64 reference value
+}
+
+BOOST_AUTO_TEST_CASE(zipfDistribution) {
+    const unsigned int keys=1000;
+    const unsigned int requests=1000000;
+    const double skews[]={0.5,0.9,1.0,1.2};
+    for (unsigned int s=0;s<sizeof(skews)/sizeof(skews[0]);s++) {
+        double norm=0;
+        for (unsigned int indx=1;indx<=keys;indx++) {
+            norm+=pow(indx,-skews[s]);
+        }
+        vector<unsigned int> hits(keys);
+        workload::zipf z(keys,skews[s],7);
+        for (unsigned int indx=0;indx<requests;indx++) {
+            unsigned int k=z.next();
+            BOOST_REQUIRE(k<keys);
+            hits[k]++;
+        }
+        for (unsigned int rank=0;rank<10;rank++) {
+            double expected=requests*pow(rank+1,-skews[s])/norm;
+            BOOST_CHECK_SMALL(hits[rank]-expected,5*sqrt(expected));
+        }
+    }
+
+    BOOST_CHECK_EQUAL(workload::zipf(1,0.9,1).next(),0);
+    BOOST_REQUIRE_THROW(workload::zipf(0,0.9,1),invalid_argument);
+    BOOST_REQUIRE_THROW(workload::zipf(10,0,1),invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(uniformDistribution) {
+    vector<unsigned int> hits(10);
+    workload::uniform u(10,3);
+    for (unsigned int indx=0;indx<100000;indx++) {
+        unsigned int k=u.next();
+        BOOST_REQUIRE(k<10);
+        hits[k]++;
+    }
+    for (unsigned int k=0;k<10;k++) {
+        BOOST_CHECK(hits[k]>9500 && hits[k]<10500);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(scanAndLoop) {
+    vector<unsigned int> scan=workload::trace(workload::scan(100),3);
+    BOOST_CHECK(scan[0]==100 && scan[1]==101 && scan[2]==102);
+
+    vector<unsigned int> loop=workload::trace(workload::loop(3),7);
+    unsigned int expected[]={0,1,2,0,1,2,0};
+    BOOST_CHECK_EQUAL_COLLECTIONS(loop.begin(),loop.end(),expected,expected+7);
+}
+
+BOOST_AUTO_TEST_CASE(mixed) {
+    vector<unsigned int> trace=workload::trace(workload::mixed(1000,0.9,100,20,5),300);
+    unsigned int scanKey=1000;
+    for (unsigned int indx=0;indx<trace.size();indx++) {
+        if (indx%100<20) {
+            BOOST_CHECK_EQUAL(trace[indx],scanKey++);
+        } else {
+            BOOST_CHECK(trace[indx]<1000);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(shifting) {
+    const unsigned int period=100000;
+    vector<unsigned int> trace=workload::trace(workload::shifting(1000,1.2,period,500,9),period*2);
+    unsigned int first[2]={0,0};
+    for (unsigned int indx=0;indx<trace.size();indx++) {
+        BOOST_REQUIRE(trace[indx]<1000);
+        if (trace[indx]==0) {
+            first[indx/period]++;
+        }
+    }
+    BOOST_CHECK(first[0]>period/5); //Key 0 is the hottest in the first period
+    BOOST_CHECK(first[1]<period/100); //And cold after the shift
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE "STLCachePolicyWTinyLFU"
+#include <boost/test/unit_test.hpp>
+
+#include <stlcache/stlcache.hpp>
+
+using namespace stlcache;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(STLCacheSuite)
+
+BOOST_AUTO_TEST_CASE(sketch) {
+    _frequency_sketch<int> s(100);
+
+    BOOST_CHECK(s.estimate(1)==0);
+    s.increment(1); //First sighting only goes to the doorkeeper
+    BOOST_CHECK(s.estimate(1)==1);
+    s.increment(1);
+    BOOST_CHECK(s.estimate(1)==2);
+    for (int indx=0;indx<100;indx++) {
+        s.increment(2);
+    }
+    BOOST_CHECK(s.estimate(2)==16); //Counters saturate at 15
+
+    for (int indx=0;indx<1000;indx++) { //Enough additions to halve everything
+        s.increment(indx+1000);
+        s.increment(indx+1000);
+    }
+    BOOST_CHECK(s.estimate(2)<=8);
+
+    s.clear();
+    BOOST_CHECK(s.estimate(2)==0);
+}
+
+BOOST_AUTO_TEST_CASE(capacity) {
+    cache<int,string,policy_wtinylfu> c1(3);
+
+    c1.insert(1,"data1");
+    c1.insert(2,"data2");
+    c1.insert(3,"data3");
+    c1.insert(4,"data4");
+    c1.insert(5,"data5");
+
+    BOOST_CHECK(c1.size()==3);
+    BOOST_CHECK(c1.check(5)); //The newest entry is always admitted into the window
+}
+
+BOOST_AUTO_TEST_CASE(scanResistance) {
+    cache<int,int,policy_wtinylfu> c1(100);
+    cache<int,int,policy_lru> c2(100);
+
+    for (int round=0;round<10;round++) {
+        for (int k=0;k<50;k++) {
+            if (!c1.try_get(k)) {
+                c1.insert(k,k);
+            }
+            if (!c2.try_get(k)) {
+                c2.insert(k,k);
+            }
+        }
+    }
+    for (int k=1000;k<3000;k++) { //One-hit wonders, twenty times the cache size
+        c1.insert(k,k);
+        c2.insert(k,k);
+    }
+
+    int hot1=0;
+    int hot2=0;
+    for (int k=0;k<50;k++) {
+        hot1+=c1.peek(k) ? 1 : 0;
+        hot2+=c2.peek(k) ? 1 : 0;
+    }
+    BOOST_CHECK(hot1>=45); //The sketch ages, so a hot entry still on probation may lose eventually
+    BOOST_CHECK(hot2==0);
+}
+
+BOOST_AUTO_TEST_CASE(copyAndSwap) {
+    cache<int,string,policy_wtinylfu> c1(10);
+    for (int k=0;k<10;k++) {
+        c1.insert(k,"data");
+        c1.touch(k);
+    }
+
+    cache<int,string,policy_wtinylfu> c2(c1);
+    cache<int,string,policy_wtinylfu> c3(10);
+    c3.swap(c1);
+    BOOST_CHECK(c1.empty());
+
+    for (int k=10;k<30;k++) {
+        c2.insert(k,"data");
+        c3.insert(k,"data");
+    }
+    BOOST_CHECK(c2.size()==10 && c3.size()==10);
+    BOOST_CHECK(c2.check(5) && c3.check(5));
+
+    c2.erase(5);
+    c2.clear();
+    BOOST_CHECK(c2.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END();
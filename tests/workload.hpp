@@ -0,0 +1,214 @@
+//
+// Copyright (C) 2011 Denis V Chapligin
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef STLCACHE_TESTS_WORKLOAD_HPP_INCLUDED
+#define STLCACHE_TESTS_WORKLOAD_HPP_INCLUDED
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Synthetic key streams for the benchmarks. Every generator is seeded and uses it's own random numbers instead of the std
+ * distributions, which differ between the standard libraries, so the same seed gives the same stream everywhere. Generators
+ * return dense unsigned integer keys from next().
+ */
+namespace workload {
+    /*
+     * SplitMix64, fast and good enough for the key streams.
+     */
+    class random {
+        std::uint64_t _state;
+    public:
+        explicit random(std::uint64_t _seed) : _state(_seed) { }
+
+        std::uint64_t next() {
+            std::uint64_t z=(_state+=UINT64_C(0x9E3779B97F4A7C15));
+            z=(z^(z>>30))*UINT64_C(0xBF58476D1CE4E5B9);
+            z=(z^(z>>27))*UINT64_C(0x94D049BB133111EB);
+            return z^(z>>31);
+        }
+        /*
+         * Uniform in [0,1).
+         */
+        double uniform() {
+            return static_cast<double>(next()>>11)*(1.0/9007199254740992.0);
+        }
+        /*
+         * Uniform in [0,_n), with a negligible bias for the _n much smaller than 2^64.
+         */
+        std::uint64_t below(std::uint64_t _n) {
+            return next()%_n;
+        }
+    };
+
+    /*
+     * Every key is equally likely.
+     */
+    class uniform {
+        random _random;
+        unsigned int _keys;
+    public:
+        uniform(unsigned int _k, std::uint64_t _seed) : _random(_seed), _keys(_k) { }
+
+        unsigned int next() {
+            return static_cast<unsigned int>(_random.below(_keys));
+        }
+    };
+
+    /*
+     * Key i is requested with the probability proportional to 1/(i+1)^skew. Sampled with the rejection-inversion method of
+     * Hormann and Derflinger, so every sample takes a constant expected time, without any per-key tables, for any key count
+     * and any positive skew.
+     */
+    class zipf {
+        random _random;
+        unsigned int _keys;
+        double _skew;
+        double _hIntegralX1;
+        double _hIntegralKeys;
+        double _s;
+
+        static double helper1(double _x) {
+            return std::fabs(_x)>1e-8 ? std::log1p(_x)/_x : 1.0-_x*(0.5-_x*(1.0/3.0-0.25*_x));
+        }
+        static double helper2(double _x) {
+            return std::fabs(_x)>1e-8 ? std::expm1(_x)/_x : 1.0+_x*0.5*(1.0+_x*(1.0/3.0)*(1.0+0.25*_x));
+        }
+        double h(double _x) const {
+            return std::exp(-_skew*std::log(_x));
+        }
+        double hIntegral(double _x) const {
+            double logX=std::log(_x);
+            return helper2((1.0-_skew)*logX)*logX;
+        }
+        double hIntegralInverse(double _x) const {
+            double t=_x*(1.0-_skew);
+            if (t<-1.0) {
+                t=-1.0;
+            }
+            return std::exp(helper1(t)*_x);
+        }
+    public:
+        zipf(unsigned int _k, double _sk, std::uint64_t _seed) : _random(_seed), _keys(_k), _skew(_sk), _hIntegralX1(0), _hIntegralKeys(0), _s(0) {
+            if (_k==0 || !(_sk>0)) {
+                throw std::invalid_argument("Zipf needs at least one key and a positive skew");
+            }
+            _hIntegralX1=hIntegral(1.5)-1.0;
+            _hIntegralKeys=hIntegral(_keys+0.5);
+            _s=2.0-hIntegralInverse(hIntegral(2.5)-h(2.0));
+        }
+
+        /*
+         * Rank of the sampled key, the most popular key is 0.
+         */
+        unsigned int next() {
+            for (;;) {
+                double u=_hIntegralKeys+_random.uniform()*(_hIntegralX1-_hIntegralKeys);
+                double x=hIntegralInverse(u);
+                double k=std::floor(x+0.5);
+                if (k<1.0) {
+                    k=1.0;
+                } else if (k>_keys) {
+                    k=_keys;
+                }
+                if (k-x<=_s || u>=hIntegral(k+0.5)-h(k)) {
+                    return static_cast<unsigned int>(k)-1;
+                }
+            }
+        }
+    };
+
+    /*
+     * Sequential keys, that never repeat, starting from _first.
+     */
+    class scan {
+        unsigned int _next;
+    public:
+        explicit scan(unsigned int _first) : _next(_first) { }
+
+        unsigned int next() {
+            return _next++;
+        }
+    };
+
+    /*
+     * Cycles over the same _length keys, the worst case for LRU, when the loop is slightly larger than the cache.
+     */
+    class loop {
+        unsigned int _length;
+        unsigned int _position;
+    public:
+        explicit loop(unsigned int _l) : _length(_l ? _l : 1), _position(0) { }
+
+        unsigned int next() {
+            unsigned int result=_position;
+            _position=_position+1==_length ? 0 : _position+1;
+            return result;
+        }
+    };
+
+    /*
+     * A Zipf hot set, interrupted by scans of never repeated keys: every _period requests start with _scanLength scan keys, that
+     * are numbered after the hot keys.
+     */
+    class mixed {
+        zipf _hot;
+        scan _scan;
+        unsigned int _period;
+        unsigned int _scanLength;
+        unsigned int _position;
+    public:
+        mixed(unsigned int _k, double _skew, unsigned int _p, unsigned int _length, std::uint64_t _seed) : _hot(_k,_skew,_seed), _scan(_k), _period(_p ? _p : 1), _scanLength(_length), _position(0) { }
+
+        unsigned int next() {
+            unsigned int position=_position;
+            _position=_position+1==_period ? 0 : _position+1;
+            return position<_scanLength ? _scan.next() : _hot.next();
+        }
+    };
+
+    /*
+     * Zipf popularity, that moves over time: every _period requests the ranks are mapped to the keys _shift positions further,
+     * so the hot keys of the previous period become cold at once.
+     */
+    class shifting {
+        zipf _ranks;
+        unsigned int _keys;
+        unsigned int _period;
+        unsigned int _shift;
+        unsigned int _position;
+        unsigned int _offset;
+    public:
+        shifting(unsigned int _k, double _skew, unsigned int _p, unsigned int _s, std::uint64_t _seed) : _ranks(_k,_skew,_seed), _keys(_k), _period(_p ? _p : 1), _shift(_s), _position(0), _offset(0) { }
+
+        unsigned int next() {
+            unsigned int result=static_cast<unsigned int>((static_cast<std::uint64_t>(_ranks.next())+_offset)%_keys);
+            if (++_position==_period) {
+                _position=0;
+                _offset=static_cast<unsigned int>((static_cast<std::uint64_t>(_offset)+_shift)%_keys);
+            }
+            return result;
+        }
+    };
+
+    /*
+     * Materializes _requests keys of the generator, so the benchmarks don't time the generation.
+     */
+    template <class Generator>
+    std::vector<unsigned int> trace(Generator _generator, std::size_t _requests) {
+        std::vector<unsigned int> result(_requests);
+        for (std::size_t indx=0;indx<_requests;indx++) {
+            result[indx]=_generator.next();
+        }
+        return result;
+    }
+}
+
+#endif /* STLCACHE_TESTS_WORKLOAD_HPP_INCLUDED */